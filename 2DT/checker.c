@@ -9,6 +9,9 @@
 #include "dynarray.h"
 #include "checker.h"
 
+/* The current checking mode, CHECKER_FULL or CHECKER_INCREMENTAL. */
+static int checkerMode = CHECKER_FULL;
+
 
 /* see checker.h for specification */
 boolean Checker_Node_isValid(Node n) {
@@ -105,11 +108,13 @@ static boolean Checker_treeCheck(Node n, size_t* cnt) {
    return TRUE;
 }
 
-/* see checker.h for specification */
-boolean Checker_DT_isValid(boolean isInit, Node root, size_t count) {
-   size_t cnt = 0;
-   boolean traversalResult;
-
+/*
+   Checks the invariants of the hierarchy as a whole that cost O(1):
+   an uninitialized hierarchy has count 0, and the root has no parent.
+   Returns FALSE if one is broken and TRUE otherwise.
+*/
+static boolean Checker_topLevelCheck(boolean isInit, Node root,
+                                     size_t count) {
    /* Sample check on a top-level data structure invariant:
       if the DT is not initialized, its count should be 0. */
    if(!isInit){
@@ -123,6 +128,16 @@ boolean Checker_DT_isValid(boolean isInit, Node root, size_t count) {
       fprintf(stderr, "Roots parent node is not NULL\n");
       return FALSE;
    }
+   return TRUE;
+}
+
+/* see checker.h for specification */
+boolean Checker_DT_fullSweep(boolean isInit, Node root, size_t count) {
+   size_t cnt = 0;
+   boolean traversalResult;
+
+   if(!Checker_topLevelCheck(isInit, root, count))
+      return FALSE;
 
    /* Now checks invariants recursively at each Node from the root. */
    traversalResult = Checker_treeCheck(root, &cnt);
@@ -135,3 +150,60 @@ boolean Checker_DT_isValid(boolean isInit, Node root, size_t count) {
    }
    return TRUE;
 }
+
+/* see checker.h for specification */
+boolean Checker_DT_isValid(boolean isInit, Node root, size_t count) {
+   if(checkerMode == CHECKER_INCREMENTAL)
+      return Checker_topLevelCheck(isInit, root, count);
+
+   return Checker_DT_fullSweep(isInit, root, count);
+}
+
+/* see checker.h for specification */
+void Checker_setMode(int mode) {
+   assert(mode == CHECKER_FULL || mode == CHECKER_INCREMENTAL);
+
+   checkerMode = mode;
+}
+
+/* see checker.h for specification */
+boolean Checker_DT_isValidAfter(boolean isInit, Node root, size_t count,
+                                Node parent, Node inserted,
+                                size_t oldCount, size_t removed) {
+   size_t cnt = 0;
+
+   if(checkerMode == CHECKER_FULL)
+      return Checker_DT_fullSweep(isInit, root, count);
+
+   if(!Checker_topLevelCheck(isInit, root, count))
+      return FALSE;
+
+   /* The parent's path and its children's order are all that a
+      link or unlink can disturb above the inserted subtree. */
+   if(parent != NULL && !Checker_Node_isValid(parent))
+      return FALSE;
+
+   if(inserted == NULL) {
+      /* A removal must shrink count by exactly the Nodes it took. */
+      if(removed > oldCount || count != oldCount - removed) {
+         fprintf(stderr, "Count does not match nodes removed\n");
+         return FALSE;
+      }
+      return TRUE;
+   }
+
+   if(Node_getParent(inserted) != parent) {
+      fprintf(stderr, "Inserted node's parent is not its parent\n");
+      return FALSE;
+   }
+
+   /* Every new Node is checked, and count must grow by exactly
+      their number. */
+   if(!Checker_treeCheck(inserted, &cnt))
+      return FALSE;
+   if(count != oldCount + cnt) {
+      fprintf(stderr, "Count does not match nodes inserted\n");
+      return FALSE;
+   }
+   return TRUE;
+}
@@ -8,6 +8,9 @@
 
 #include "node.h"
 
+/* Checking modes: re-walk the whole hierarchy on every check, or
+   check only what each mutation touched. */
+enum { CHECKER_FULL, CHECKER_INCREMENTAL };
 
 /*
    Returns TRUE if the Node parameter n represents a directory entry
@@ -24,4 +27,39 @@ boolean Checker_Node_isValid(Node n);
 */
 boolean Checker_DT_isValid(boolean isInit, Node root, size_t count);
 
+/*
+   Sets the checking mode to CHECKER_FULL (the default) or
+   CHECKER_INCREMENTAL. In incremental mode Checker_DT_isValid checks
+   only the top-level invariants, which cost O(1), and
+   Checker_DT_isValidAfter checks the Nodes a mutation touched.
+*/
+void Checker_setMode(int mode);
+
+/*
+   Returns TRUE if the hierarchy is in a valid state after a single
+   mutation, or FALSE otherwise. isInit, root, and count are as for
+   Checker_DT_isValid, and oldCount is count before the mutation.
+   parent is the Node whose children changed, or NULL if the root
+   itself changed. inserted is the top Node of a newly inserted
+   subtree, or NULL if the mutation removed a subtree, in which case
+   removed is the number of Nodes that subtree held, counted before
+   it was unlinked; removed is 0 after an insertion.
+
+   In incremental mode, checks the top-level invariants, parent's
+   path and the sorted order of its children, every Node of the
+   inserted subtree, and that count changed by exactly the number of
+   Nodes inserted or removed. In full mode, checks the whole
+   hierarchy as Checker_DT_isValid does.
+*/
+boolean Checker_DT_isValidAfter(boolean isInit, Node root, size_t count,
+                                Node parent, Node inserted,
+                                size_t oldCount, size_t removed);
+
+/*
+   Returns TRUE if the whole hierarchy is in a valid state or FALSE
+   otherwise, walking every Node whatever the checking mode. The
+   arguments are as for Checker_DT_isValid.
+*/
+boolean Checker_DT_fullSweep(boolean isInit, Node root, size_t count);
+
 #endif
@@ -106,9 +106,11 @@ static int DT_linkParentToChild(Node parent, Node child) {
    If there is an error linking any of the new nodes,
    returns PARENT_CHID_ERROR
 
-   Otherwise, returns SUCCESS
+   Otherwise, returns SUCCESS and stores the top new Node in
+   *pInserted
 */
-static int DT_insertRestOfPath(char* path, Node parent) {
+static int DT_insertRestOfPath(char* path, Node parent,
+                               Node* pInserted) {
 
    Node curr = parent;
    Node firstNew = NULL;
@@ -120,6 +122,7 @@ static int DT_insertRestOfPath(char* path, Node parent) {
    size_t newCount = 0;
 
    assert(path != NULL);
+   assert(pInserted != NULL);
 
    if(curr == NULL) {
       if(root != NULL) {
@@ -170,12 +173,15 @@ static int DT_insertRestOfPath(char* path, Node parent) {
    if(parent == NULL) {
       root = firstNew;
       count = newCount;
+      *pInserted = firstNew;
       return SUCCESS;
    }
    else {
       result = DT_linkParentToChild(parent, firstNew);
-      if(result == SUCCESS)
+      if(result == SUCCESS) {
          count += newCount;
+         *pInserted = firstNew;
+      }
       else
          (void) Node_destroy(firstNew);
 
@@ -187,6 +193,10 @@ static int DT_insertRestOfPath(char* path, Node parent) {
 int DT_insertPath(char* path) {
 
    Node curr;
+   Node inserted = NULL;
+#ifndef NDEBUG
+   size_t oldCount = count;
+#endif
    int result;
 
    assert(Checker_DT_isValid(isInitialized,root,count));
@@ -195,8 +205,12 @@ int DT_insertPath(char* path) {
    if(!isInitialized)
       return INITIALIZATION_ERROR;
    curr = DT_traversePath(path);
-   result = DT_insertRestOfPath(path, curr);
-   assert(Checker_DT_isValid(isInitialized,root,count));
+   result = DT_insertRestOfPath(path, curr, &inserted);
+   if(result == SUCCESS)
+      assert(Checker_DT_isValidAfter(isInitialized, root, count,
+                                     curr, inserted, oldCount, 0));
+   else
+      assert(Checker_DT_isValid(isInitialized,root,count));
    return result;
 }
 
@@ -225,6 +239,23 @@ boolean DT_containsPath(char* path) {
    return result;
 }
 
+#ifndef NDEBUG
+/*
+  Returns the number of Nodes in the hierarchy rooted at curr,
+  including curr itself, for the checker.
+*/
+static size_t DT_countFrom(Node curr) {
+   size_t total = 1;
+   size_t i;
+
+   assert(curr != NULL);
+
+   for(i = 0; i < Node_getNumChildren(curr); i++)
+      total += DT_countFrom(Node_getChild(curr, i));
+   return total;
+}
+#endif
+
 /*
   Removes the directory hierarchy rooted at path starting from Node
   curr. If curr is the data structure's root, root becomes NULL.
@@ -259,6 +290,11 @@ static int DT_rmPathAt(char* path, Node curr) {
 /* see bdt.h for specification */
 int DT_rmPath(char* path) {
    Node curr;
+#ifndef NDEBUG
+   Node parent = NULL;
+   size_t oldCount = count;
+   size_t removed = 0;
+#endif
    int result;
 
    assert(Checker_DT_isValid(isInitialized,root,count));
@@ -270,10 +306,20 @@ int DT_rmPath(char* path) {
    curr = DT_traversePath(path);
    if(curr == NULL)
       result =  NO_SUCH_PATH;
-   else
+   else {
+#ifndef NDEBUG
+      /* The checker needs the subtree's size before it is freed. */
+      parent = Node_getParent(curr);
+      removed = DT_countFrom(curr);
+#endif
       result = DT_rmPathAt(path, curr);
+   }
 
-   assert(Checker_DT_isValid(isInitialized,root,count));
+   if(result == SUCCESS)
+      assert(Checker_DT_isValidAfter(isInitialized, root, count,
+                                     parent, NULL, oldCount, removed));
+   else
+      assert(Checker_DT_isValid(isInitialized,root,count));
    return result;
 }
 
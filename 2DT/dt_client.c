@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "dt.h"
+#include "checker.h"
 
 /* Tests the DT implementation with an assortment of checks.
    Prints the status of the data structure along the way to stderr.
@@ -105,5 +106,28 @@ int main(void) {
   assert(DT_destroy() == INITIALIZATION_ERROR);
   assert(DT_containsPath("a") == FALSE);
 
+  /* In incremental mode the checker examines only what each insertion
+     or removal touched, and count must change by exactly the number
+     of directories inserted or removed, including when the root's
+     whole hierarchy goes. */
+  Checker_setMode(CHECKER_INCREMENTAL);
+  assert(DT_init() == SUCCESS);
+  assert(DT_insertPath("a/b/c/d") == SUCCESS);
+  assert(DT_insertPath("a/b/e") == SUCCESS);
+  assert(DT_insertPath("a/f") == SUCCESS);
+  assert(DT_rmPath("a/b/x") == NO_SUCH_PATH);
+  assert(DT_rmPath("a/b") == SUCCESS);
+  assert(DT_containsPath("a/b/c/d") == FALSE);
+  assert(DT_containsPath("a/b") == FALSE);
+  assert(DT_containsPath("a/f") == TRUE);
+  assert(DT_rmPath("a") == SUCCESS);
+  assert(DT_containsPath("a") == FALSE);
+  assert(DT_insertPath("x/y") == SUCCESS);
+  assert((temp = DT_toString()) != NULL);
+  fprintf(stderr, "%s\n", temp);
+  free(temp);
+  assert(DT_destroy() == SUCCESS);
+  Checker_setMode(CHECKER_FULL);
+
   return 0;
 }
@@ -0,0 +1,512 @@
+/*--------------------------------------------------------------------*/
+/* checker.c                                                          */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "checker.h"
+#include "dynarray.h"
+#include "threadpool.h"
+
+/* The number of Nodes checked between looks at the clock. */
+enum { CLOCK_INTERVAL = 64 };
+
+/* The number of subtrees per worker that a parallel sweep aims for. */
+enum { SUBTREES_PER_WORKER = 8 };
+
+/* The largest count for which the sampled check walks the whole
+   tree from the root rather than sampling subtrees. */
+enum { FULL_WALK_LIMIT = 1024 };
+
+/* The budget of the sampled check: subtrees and microseconds. */
+static size_t sampleLimit = 4;
+static unsigned long budgetMicroseconds = 100;
+
+/* The state of the sampled check's random number generator. */
+static unsigned long long randomState = 0x9E3779B97F4A7C15ULL;
+
+/*
+   The progress of a walk over a subtree: the number of Nodes visited,
+   the time by which it must stop (0 for none), and whether it visited
+   every Node before stopping.
+*/
+struct Walk {
+   size_t visited;
+   double deadline;
+   boolean isComplete;
+};
+
+/*
+   Returns the current time in seconds from a monotonic clock.
+*/
+static double Checker_now(void) {
+   struct timespec now;
+
+   (void)clock_gettime(CLOCK_MONOTONIC, &now);
+   return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/*
+   Returns a pseudo-random number below bound, which must not be 0.
+*/
+static size_t Checker_random(size_t bound) {
+   assert(bound > 0);
+
+   /* xorshift64: fast, and independent of the client's rand(). */
+   randomState ^= randomState << 13;
+   randomState ^= randomState >> 7;
+   randomState ^= randomState << 17;
+   return (size_t)(randomState % bound);
+}
+
+/* see checker.h for specification */
+boolean Checker_Node_isValid(Node n) {
+   Node parent;
+   Node prevNode;
+   Node currNode;
+   const char* npath;
+   const char* ppath;
+   const char* rest;
+   size_t i;
+   size_t j;
+   size_t files;
+   size_t dirs;
+   size_t bytes;
+
+   /* A NULL pointer is not a valid Node */
+   if(n == NULL) {
+      fprintf(stderr, "Node is a NULL pointer\n");
+      return FALSE;
+   }
+
+   npath = Node_getPath(n);
+   if(npath == NULL) {
+      fprintf(stderr, "Node's path is NULL\n");
+      return FALSE;
+   }
+
+   /* Files are leaves, and directories carry no contents length */
+   if(Node_getType(n) == FIL) {
+      if(Node_getNumChildren(n) != 0) {
+         fprintf(stderr, "File %s has children\n", npath);
+         return FALSE;
+      }
+   }
+   else if(Node_getType(n) == DIR) {
+      if(Node_getLength(n) != 0) {
+         fprintf(stderr, "Directory %s has a length\n", npath);
+         return FALSE;
+      }
+   }
+   else {
+      fprintf(stderr, "Node %s is neither file nor directory\n", npath);
+      return FALSE;
+   }
+
+   parent = Node_getParent(n);
+   if(parent != NULL) {
+      if(Node_getType(parent) != DIR) {
+         fprintf(stderr, "Parent of %s is a file\n", npath);
+         return FALSE;
+      }
+
+      /* Parent's path must be a prefix of n's path */
+      ppath = Node_getPath(parent);
+      i = strlen(ppath);
+      if(strncmp(npath, ppath, i) || npath[i] != '/') {
+         fprintf(stderr, "P's path is not a prefix of C's path\n");
+         return FALSE;
+      }
+
+      /* n's path after parent's path + '/' must be a single,
+         non-empty component */
+      rest = npath + i + 1;
+      if(*rest == '\0' || strchr(rest, '/') != NULL) {
+         fprintf(stderr, "C's path is not one level below P's\n");
+         return FALSE;
+      }
+
+      /* n's name must be the last component of its path */
+      if(strcmp(rest, Node_getName(n)) != 0) {
+         fprintf(stderr, "Name of %s is %s\n", npath, Node_getName(n));
+         return FALSE;
+      }
+   }
+
+   /* A copy not yet given its children keeps its source's totals */
+   if(Node_isCopying(n)) {
+      if(Node_getType(n) != DIR || Node_getNumChildren(n) != 0) {
+         fprintf(stderr, "Copy %s already has children\n", npath);
+         return FALSE;
+      }
+      return TRUE;
+   }
+
+   /* Children must link back and be sorted files-first */
+   prevNode = NULL;
+   files = 0;
+   dirs = 0;
+   bytes = 0;
+   for(j = 0; j < Node_getNumChildren(n); j++) {
+      currNode = Node_getChild(n, j);
+      if(currNode == NULL || Node_getParent(currNode) != n) {
+         fprintf(stderr, "Child of %s does not link back\n", npath);
+         return FALSE;
+      }
+      if(prevNode != NULL && Node_compare(prevNode, currNode) >= 0) {
+         fprintf(stderr, "Children of %s are not in sorted order\n",
+                 npath);
+         return FALSE;
+      }
+      prevNode = currNode;
+
+      if(Node_getType(currNode) == FIL) {
+         files++;
+         bytes += Node_getLength(currNode);
+      }
+      else {
+         files += Node_getFilesBelow(currNode);
+         dirs += Node_getDirsBelow(currNode) + 1;
+         bytes += Node_getBytesBelow(currNode);
+      }
+   }
+
+   /* The totals below n must add up over its children */
+   if(files != Node_getFilesBelow(n) || dirs != Node_getDirsBelow(n) ||
+      bytes != Node_getBytesBelow(n)) {
+      fprintf(stderr, "Totals below %s do not match its children\n",
+              npath);
+      return FALSE;
+   }
+
+   return TRUE;
+}
+
+/*
+   Performs a pre-order traversal of the tree rooted at n, checking
+   each Node and counting it in walk. Stops early, clearing
+   walk->isComplete, once walk's deadline passes.
+   Returns FALSE if a broken invariant is found and
+   returns TRUE otherwise.
+*/
+static boolean Checker_treeCheck(Node n, struct Walk* walk) {
+   size_t c;
+
+   assert(walk != NULL);
+
+   if(n == NULL)
+      return TRUE;
+
+   if(walk->deadline != 0 && walk->visited % CLOCK_INTERVAL == 0 &&
+      Checker_now() > walk->deadline)
+      walk->isComplete = FALSE;
+   if(!walk->isComplete)
+      return TRUE;
+
+   walk->visited++;
+   if(!Checker_Node_isValid(n))
+      return FALSE;
+
+   /* A copy not yet given its children stands for all it will copy */
+   if(Node_isCopying(n))
+      walk->visited += Node_getSubtreeSize(n) - 1;
+
+   for(c = 0; c < Node_getNumChildren(n); c++)
+      if(!Checker_treeCheck(Node_getChild(n, c), walk))
+         return FALSE;
+
+   return TRUE;
+}
+
+/*
+   Checks the invariants of the hierarchy as a whole that cost O(1).
+   Returns FALSE if one is broken and TRUE otherwise.
+*/
+static boolean Checker_topLevelCheck(boolean isInit, Node root,
+                                     size_t count) {
+   if(!isInit) {
+      if(count != 0) {
+         fprintf(stderr, "Not initialized, but count is not 0\n");
+         return FALSE;
+      }
+      if(root != NULL) {
+         fprintf(stderr, "Not initialized, but root is not NULL\n");
+         return FALSE;
+      }
+   }
+
+   if(root == NULL) {
+      if(count != 0) {
+         fprintf(stderr, "Empty hierarchy, but count is not 0\n");
+         return FALSE;
+      }
+      return TRUE;
+   }
+
+   if(Node_getParent(root) != NULL) {
+      fprintf(stderr, "Root's parent node is not NULL\n");
+      return FALSE;
+   }
+   if(count == 0) {
+      fprintf(stderr, "Non-empty hierarchy, but count is 0\n");
+      return FALSE;
+   }
+   return TRUE;
+}
+
+/* see checker.h for specification */
+boolean Checker_FT_isValid(boolean isInit, Node root, size_t count) {
+   struct Walk walk;
+
+   if(!Checker_topLevelCheck(isInit, root, count))
+      return FALSE;
+
+   walk.visited = 0;
+   walk.deadline = 0;
+   walk.isComplete = TRUE;
+   if(!Checker_treeCheck(root, &walk))
+      return FALSE;
+
+   if(walk.visited != count) {
+      fprintf(stderr, "Incorrect count of nodes\n");
+      return FALSE;
+   }
+   return TRUE;
+}
+
+/*
+   Returns a Node of the tree rooted at root chosen uniformly at
+   random, by descending into each child with probability in
+   proportion to the size of its subtree. A copy not yet given its
+   children stands for all of the Nodes it will copy.
+*/
+static Node Checker_randomNode(Node root) {
+   Node n = root;
+   size_t offset;
+   size_t childID;
+   size_t before;
+
+   assert(root != NULL);
+
+   offset = Checker_random(Node_getSubtreeSize(root));
+   while(offset > 0 && !Node_isCopying(n)) {
+      /* offset counts the Nodes before the chosen one in pre-order,
+         starting at n itself. */
+      offset--;
+      if(Node_findChildAt(n, offset, &childID, &before) != SUCCESS)
+         break;
+      n = Node_getChild(n, childID);
+      offset -= before;
+   }
+   return n;
+}
+
+/* see checker.h for specification */
+boolean Checker_FT_isValidSampled(boolean isInit, Node root,
+                                  size_t count) {
+   struct Walk walk;
+   Node n;
+   size_t s;
+
+   if(!Checker_topLevelCheck(isInit, root, count))
+      return FALSE;
+   if(root == NULL)
+      return TRUE;
+
+   /* Small trees are checked whole, within the whole budget, and
+      their count verified. */
+   if(count <= FULL_WALK_LIMIT) {
+      walk.visited = 0;
+      walk.deadline = Checker_now() + budgetMicroseconds / 1e6;
+      walk.isComplete = TRUE;
+      if(!Checker_treeCheck(root, &walk))
+         return FALSE;
+      if(walk.isComplete && walk.visited != count) {
+         fprintf(stderr, "Incorrect count of nodes\n");
+         return FALSE;
+      }
+      return TRUE;
+   }
+
+   /* Larger trees get random subtrees, each with its own share of
+      the budget, so that one large subtree cannot starve the rest. */
+   for(s = 0; s < sampleLimit; s++) {
+      n = Checker_randomNode(root);
+
+      walk.visited = 0;
+      walk.deadline = Checker_now() +
+         budgetMicroseconds / 1e6 / (double)sampleLimit;
+      walk.isComplete = TRUE;
+      if(!Checker_treeCheck(n, &walk))
+         return FALSE;
+
+      if(walk.visited > count ||
+         (n == root && walk.isComplete && walk.visited != count)) {
+         fprintf(stderr, "Incorrect count of nodes\n");
+         return FALSE;
+      }
+   }
+   return TRUE;
+}
+
+/*
+   The shared state of a parallel sweep: the subtrees to check, and
+   per subtree, the Nodes counted and whether it was valid.
+*/
+struct Sweep {
+   DynArray_T subtrees;
+   size_t* counts;
+   boolean* results;
+};
+
+/*
+   Checks the uSubtree'th subtree of the Sweep at pvSweep, recording
+   its count and validity. Runs as a ThreadPool task.
+*/
+static void Checker_sweepTask(size_t uSubtree, size_t uWorker,
+                              void* pvSweep) {
+   struct Sweep* sweep = pvSweep;
+   struct Walk walk;
+
+   assert(sweep != NULL);
+   (void)uWorker;
+
+   walk.visited = 0;
+   walk.deadline = 0;
+   walk.isComplete = TRUE;
+   sweep->results[uSubtree] = Checker_treeCheck(
+      DynArray_get(sweep->subtrees, uSubtree), &walk);
+   sweep->counts[uSubtree] = walk.visited;
+}
+
+/*
+   Replaces the Nodes of frontier, level by level, with their
+   children until it holds at least target Nodes or only leaves,
+   checking each Node replaced and counting it in *pCount.
+   Returns FALSE if a replaced Node is invalid or memory runs out,
+   and TRUE otherwise.
+*/
+static boolean Checker_expandFrontier(DynArray_T frontier,
+                                      size_t target, size_t* pCount) {
+   DynArray_T next;
+   Node n;
+   size_t i;
+   size_t c;
+   boolean isExpanded = TRUE;
+
+   assert(frontier != NULL);
+   assert(pCount != NULL);
+
+   while(isExpanded && DynArray_getLength(frontier) < target) {
+      next = DynArray_new(0);
+      if(next == NULL)
+         return FALSE;
+
+      isExpanded = FALSE;
+      for(i = 0; i < DynArray_getLength(frontier); i++) {
+         n = DynArray_get(frontier, i);
+         if(Node_getNumChildren(n) == 0) {
+            if(!DynArray_add(next, n)) {
+               DynArray_free(next);
+               return FALSE;
+            }
+            continue;
+         }
+
+         (*pCount)++;
+         if(!Checker_Node_isValid(n)) {
+            DynArray_free(next);
+            return FALSE;
+         }
+         for(c = 0; c < Node_getNumChildren(n); c++)
+            if(!DynArray_add(next, Node_getChild(n, c))) {
+               DynArray_free(next);
+               return FALSE;
+            }
+         isExpanded = TRUE;
+      }
+
+      /* Move next's Nodes into frontier. */
+      DynArray_removeRange(frontier, 0, DynArray_getLength(frontier),
+                           NULL);
+      for(i = 0; i < DynArray_getLength(next); i++)
+         if(!DynArray_add(frontier, DynArray_get(next, i))) {
+            DynArray_free(next);
+            return FALSE;
+         }
+      DynArray_free(next);
+   }
+   return TRUE;
+}
+
+/* see checker.h for specification */
+boolean Checker_FT_isValidParallel(boolean isInit, Node root,
+                                   size_t count) {
+   struct Sweep sweep;
+   size_t cnt = 0;
+   size_t uSubtrees;
+   size_t i;
+   boolean result = TRUE;
+
+   if(!Checker_topLevelCheck(isInit, root, count))
+      return FALSE;
+   if(root == NULL)
+      return TRUE;
+
+   sweep.subtrees = DynArray_new(0);
+   if(sweep.subtrees == NULL || !DynArray_add(sweep.subtrees, root)) {
+      fprintf(stderr, "Insufficient memory for parallel sweep\n");
+      if(sweep.subtrees != NULL)
+         DynArray_free(sweep.subtrees);
+      return FALSE;
+   }
+
+   /* Split the tree into enough disjoint subtrees to balance. */
+   if(!Checker_expandFrontier(sweep.subtrees,
+                              SUBTREES_PER_WORKER *
+                              ThreadPool_getNumWorkers(), &cnt)) {
+      DynArray_free(sweep.subtrees);
+      return FALSE;
+   }
+
+   uSubtrees = DynArray_getLength(sweep.subtrees);
+   sweep.counts = calloc(uSubtrees, sizeof(size_t));
+   sweep.results = calloc(uSubtrees, sizeof(boolean));
+   if(sweep.counts == NULL || sweep.results == NULL) {
+      fprintf(stderr, "Insufficient memory for parallel sweep\n");
+      free(sweep.counts);
+      free(sweep.results);
+      DynArray_free(sweep.subtrees);
+      return FALSE;
+   }
+
+   ThreadPool_run(uSubtrees, Checker_sweepTask, &sweep);
+
+   for(i = 0; i < uSubtrees; i++) {
+      if(!sweep.results[i])
+         result = FALSE;
+      cnt += sweep.counts[i];
+   }
+   if(result && cnt != count) {
+      fprintf(stderr, "Incorrect count of nodes\n");
+      result = FALSE;
+   }
+
+   free(sweep.counts);
+   free(sweep.results);
+   DynArray_free(sweep.subtrees);
+   return result;
+}
+
+/* see checker.h for specification */
+void Checker_setBudget(size_t uSamples, unsigned long uMicroseconds) {
+   sampleLimit = uSamples;
+   budgetMicroseconds = uMicroseconds;
+}
@@ -0,0 +1,59 @@
+/*--------------------------------------------------------------------*/
+/* checker.h                                                          */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#ifndef CHECKER_INCLUDED
+#define CHECKER_INCLUDED
+
+#include "node.h"
+
+
+/*
+   Returns TRUE if the Node parameter n represents a directory or file
+   entry in a valid state, or FALSE otherwise. Checks n's own fields,
+   its place under its parent, and the order of its children; it does
+   not descend further.
+*/
+boolean Checker_Node_isValid(Node n);
+
+/*
+   Returns TRUE if the hierarchy is in a valid state or FALSE
+   otherwise, checking every Node. The data structure's validity is
+   based on a boolean isInit indicating whether it has been
+   initialized, a Node root representing the root of the hierarchy,
+   and a size_t count representing the total number of directories
+   and files in the hierarchy.
+*/
+boolean Checker_FT_isValid(boolean isInit, Node root, size_t count);
+
+/*
+   Returns TRUE if the hierarchy passes a sampled check or FALSE
+   otherwise; the arguments are as for Checker_FT_isValid. Checks the
+   top-level invariants, then, for a small hierarchy, every Node and
+   the count, within the time budget set by Checker_setBudget. For a
+   larger one, checks the subtrees under a few Nodes chosen uniformly
+   at random, each within an equal share of the budget. The count is
+   checked against the total only if every Node happened to be
+   visited. Cheap enough to run on every operation.
+*/
+boolean Checker_FT_isValidSampled(boolean isInit, Node root,
+                                  size_t count);
+
+/*
+   Returns TRUE if the hierarchy is in a valid state or FALSE
+   otherwise, checking every Node as Checker_FT_isValid does but
+   spreading disjoint subtrees over the workers of the ThreadPool.
+   Meant for offline verification of large trees.
+*/
+boolean Checker_FT_isValidParallel(boolean isInit, Node root,
+                                   size_t count);
+
+/*
+   Sets the budget of Checker_FT_isValidSampled: at most uSamples
+   subtrees per call, and at most uMicroseconds microseconds in total.
+   The defaults are 4 subtrees and 100 microseconds.
+*/
+void Checker_setBudget(size_t uSamples, unsigned long uMicroseconds);
+
+#endif
@@ -0,0 +1,52 @@
+/*--------------------------------------------------------------------*/
+/* counters.c                                                         */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "counters.h"
+
+#ifdef FT_COUNTERS
+__thread struct Counters Counters_current;
+#endif
+
+/* Printable names of the counters. */
+static const char *counterNames[COUNTER_NUM] = {
+   "nodes", "probes", "compares", "bytes", "allocations"
+};
+
+/*--------------------------------------------------------------------*/
+void Counters_take(struct Counters *psTotals) {
+#ifdef FT_COUNTERS
+   int counter;
+
+   if (psTotals != NULL)
+      for (counter = 0; counter < COUNTER_NUM; counter++)
+         psTotals->counts[counter] += Counters_current.counts[counter];
+   memset(&Counters_current, 0, sizeof(struct Counters));
+#else
+   (void)psTotals;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+uint64_t Counters_commonPrefix(const char *pcOne, const char *pcTwo) {
+   uint64_t uLength = 0;
+
+   assert(pcOne != NULL);
+   assert(pcTwo != NULL);
+
+   while (pcOne[uLength] != '\0' && pcOne[uLength] == pcTwo[uLength])
+      uLength++;
+   return uLength;
+}
+
+/*--------------------------------------------------------------------*/
+const char *Counters_getName(int counter) {
+   assert(counter >= 0 && counter < COUNTER_NUM);
+
+   return counterNames[counter];
+}
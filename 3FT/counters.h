@@ -0,0 +1,83 @@
+/*--------------------------------------------------------------------*/
+/* counters.h                                                         */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#ifndef COUNTERS_INCLUDED
+#define COUNTERS_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+  Work counters measure what path resolution does: how many nodes it
+  descends through, how many elements binary searches probe, how many
+  strings it compares and how many bytes those comparisons read, and
+  how many blocks it allocates along the way. They are counted only
+  in builds with -DFT_COUNTERS; otherwise COUNTERS_ADD compiles to
+  nothing and every count stays 0.
+
+  Counts go to the calling thread's Counters_current, so work done by
+  ThreadPool workers is not counted.
+*/
+
+/* The kinds of work counted. */
+enum { COUNTER_NODES, COUNTER_PROBES, COUNTER_COMPARES, COUNTER_BYTES,
+       COUNTER_ALLOCATIONS, COUNTER_NUM };
+
+/* A count of each kind of work. */
+struct Counters {
+   uint64_t counts[COUNTER_NUM];
+};
+
+/* The work of one path lookup, as reported by FT_explain. */
+struct Explain {
+   /* The work counted during the lookup. */
+   struct Counters counters;
+   /* The number of path components matched, counting the root's. */
+   size_t depth;
+   /* The directory whose search for a child read the most bytes:
+      the length of the prefix of the path that names it, its number
+      of children, and the bytes read. All 0 if no directory was
+      searched or work is not counted. */
+   size_t worstLength;
+   size_t worstChildren;
+   uint64_t worstBytes;
+};
+
+#ifdef FT_COUNTERS
+/* Whether this build counts work. */
+enum { COUNTERS_ENABLED = 1 };
+
+/* The work counted by the calling thread since it was last taken. */
+extern __thread struct Counters Counters_current;
+
+#define COUNTERS_ADD(counter, n) \
+   (Counters_current.counts[counter] += (uint64_t)(n))
+#else
+enum { COUNTERS_ENABLED = 0 };
+
+#define COUNTERS_ADD(counter, n) ((void)0)
+#endif
+
+/*--------------------------------------------------------------------*/
+/*
+  Adds the calling thread's counts to *psTotals, if psTotals is not
+  NULL, and sets them to zero.
+*/
+void Counters_take(struct Counters *psTotals);
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the number of leading bytes pcOne and pcTwo share, which is
+  how many bytes a comparison of them reads before it differs.
+*/
+uint64_t Counters_commonPrefix(const char *pcOne, const char *pcTwo);
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the printable name of the kind of work counter.
+*/
+const char *Counters_getName(int counter);
+
+#endif
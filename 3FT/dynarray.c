@@ -3,9 +3,13 @@
 /* Author: Bob Dondero                                                */
 /*--------------------------------------------------------------------*/
 
+#include "counters.h"
 #include "dynarray.h"
+#include "memprof.h"
+#include "threadpool.h"
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 /*--------------------------------------------------------------------*/
 
@@ -13,6 +17,75 @@
 
 static const size_t MIN_PHYS_LENGTH = 2;
 
+/* The minimum logical length at which DynArray_bsearch switches to
+   searching the side array of keys. */
+
+static const size_t KEYED_MIN_LENGTH = 32;
+
+/* The most words of a shared prefix of key strings that the keys
+   skip, so the keys start no more than 8 times as many bytes in. */
+
+enum { KEY_PREFIX_WORDS = 8 };
+
+/* The default growth policy: double the physical length when full,
+   and shrink it to twice the logical length once no more than a
+   quarter is in use. */
+
+static const size_t DEFAULT_GROW_PERCENT = 200;
+static const size_t DEFAULT_SHRINK_PERCENT = 25;
+
+/* The fewest elements handed to one task by the parallel
+   operations; smaller arrays are processed by the caller alone. */
+
+static const size_t MIN_CHUNK_LENGTH = 4096;
+
+/* The number of chunks per worker, so that uneven chunks balance
+   out. */
+
+static const size_t CHUNKS_PER_WORKER = 4;
+
+/* The alignment of per-worker partial results, keeping each on its
+   own cache line. */
+
+static const size_t CACHE_LINE_SIZE = 64;
+
+/*--------------------------------------------------------------------*/
+
+/* The side array of keys that DynArray_bsearch keeps for a large
+   DynArray with a key function.  Elements of one sorted array often
+   share a long prefix, such as "IMG_000", so the keys are taken from
+   after the prefix shared by most of them. */
+
+struct KeyIndex
+{
+   /* The keys of the elements, parallel to the array of the DynArray
+      and of the same physical length.  Only those from uLo up to uHi
+      are searched. */
+   uint64_t *puKeys;
+
+   /* The number of leading bytes of the key strings of the elements
+      from uLo up to uHi that they all share, and those bytes, eight
+      to a word as the key function returns them.  Each key is the
+      eight bytes of its key string that follow. */
+   size_t uOffset;
+   uint64_t auPrefix[KEY_PREFIX_WORDS];
+
+   /* The elements whose key strings start with the prefix are
+      exactly those from uLo up to, but not including, uHi. */
+   size_t uLo;
+   size_t uHi;
+
+   /* The logical length of the DynArray when the keys were built.
+      They are rebuilt once it doubles or halves, so that the prefix
+      follows the elements. */
+   size_t uBuiltLength;
+
+   /* 1 (TRUE) if the keys told most of the elements from uLo up to
+      uHi apart when built, and 0 (FALSE) if a plain binary search
+      is faster. */
+   int iNarrows;
+};
+
 /*--------------------------------------------------------------------*/
 
 /* A DynArray consists of an array, along with its logical and
@@ -30,6 +103,21 @@ struct DynArray
 
    /* The array that underlies the DynArray. */
    const void **ppvArray;
+
+   /* The function that maps an element to its key, or NULL if keyed
+      search is disabled. */
+   uint64_t (*pfKey)(const void *pvElement, size_t uOffset);
+
+   /* The side array of keys, or NULL if it has not been built. */
+   struct KeyIndex *psKeys;
+
+   /* The percentage of its old physical length that the DynArray
+      grows to when full. */
+   size_t uGrowPercent;
+
+   /* The percentage of the physical length in use at or below which
+      a removal shrinks the DynArray, or 0 to never shrink. */
+   size_t uShrinkPercent;
 };
 
 /*--------------------------------------------------------------------*/
@@ -44,6 +132,14 @@ static int DynArray_isValid(DynArray_T oDynArray)
    if (oDynArray->uPhysLength < MIN_PHYS_LENGTH) return 0;
    if (oDynArray->uLength > oDynArray->uPhysLength) return 0;
    if (oDynArray->ppvArray == NULL) return 0;
+   if (oDynArray->psKeys != NULL)
+   {
+      if (oDynArray->pfKey == NULL) return 0;
+      if (oDynArray->psKeys->uLo > oDynArray->psKeys->uHi) return 0;
+      if (oDynArray->psKeys->uHi > oDynArray->uLength) return 0;
+   }
+   if (oDynArray->uGrowPercent <= 100) return 0;
+   if (oDynArray->uShrinkPercent >= 50) return 0;
    return 1;
 }
 
@@ -51,36 +147,334 @@ static int DynArray_isValid(DynArray_T oDynArray)
 
 /*--------------------------------------------------------------------*/
 
-/* Increase the physical length of oDynArray.  Return 1 (TRUE) if
-   successful and 0 (FALSE) if insufficient memory is available. */
+/* Discard the side array of keys of oDynArray.  It is rebuilt by the
+   next keyed DynArray_bsearch. */
 
-static int DynArray_grow(DynArray_T oDynArray)
+static void DynArray_dropKeys(DynArray_T oDynArray)
 {
-   const size_t GROWTH_FACTOR = 2;
+   assert(oDynArray != NULL);
 
-   size_t uNewLength;
+   if (oDynArray->psKeys == NULL)
+      return;
+   free(oDynArray->psKeys->puKeys);
+   free(oDynArray->psKeys);
+   oDynArray->psKeys = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of leading bytes, up to uLimit, that the key
+   strings of *pvElement1 and *pvElement2 share in oDynArray. */
+
+static size_t DynArray_keyBytesShared(DynArray_T oDynArray,
+                                      const void *pvElement1,
+                                      const void *pvElement2,
+                                      size_t uLimit)
+{
+   uint64_t uDiff;
+   size_t uOffset;
+
+   assert(oDynArray != NULL);
+   assert(oDynArray->pfKey != NULL);
+
+   for (uOffset = 0; uOffset < uLimit; uOffset += 8)
+   {
+      uDiff = (*oDynArray->pfKey)(pvElement1, uOffset) ^
+         (*oDynArray->pfKey)(pvElement2, uOffset);
+      if (uDiff != 0)
+      {
+         for (; (uDiff >> 56) == 0; uDiff <<= 8)
+            uOffset++;
+         break;
+      }
+   }
+   return (uOffset < uLimit) ? uOffset : uLimit;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Compare the key string of *pvElement with the prefix of the keys of
+   oDynArray.  Return 0 if it starts with the prefix, and otherwise
+   <0 or >0 as it is less or greater. */
+
+static int DynArray_comparePrefix(DynArray_T oDynArray,
+                                  const void *pvElement)
+{
+   const struct KeyIndex *psKeys;
+   uint64_t uMask;
+   uint64_t uWord;
+   uint64_t uPrefix;
+   size_t uOffset;
+
+   assert(oDynArray != NULL);
+   assert(oDynArray->psKeys != NULL);
+
+   psKeys = oDynArray->psKeys;
+   for (uOffset = 0; uOffset < psKeys->uOffset; uOffset += 8)
+   {
+      /* Only the prefix's own bytes of its last word count. */
+      uMask = UINT64_MAX;
+      if (psKeys->uOffset - uOffset < 8)
+         uMask = ~(UINT64_MAX >> (8 * (psKeys->uOffset - uOffset)));
+      uWord = (*oDynArray->pfKey)(pvElement, uOffset) & uMask;
+      uPrefix = psKeys->auPrefix[uOffset / 8] & uMask;
+      if (uWord != uPrefix)
+         return (uWord < uPrefix) ? -1 : 1;
+   }
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Build the side array of keys of oDynArray, which must be sorted and
+   not empty.  Return 1 (TRUE) if successful and 0 (FALSE) if
+   insufficient memory is available. */
+
+static int DynArray_buildKeys(DynArray_T oDynArray)
+{
+   struct KeyIndex *psKeys;
+   const void **ppvArray;
+   size_t uLength;
+   size_t uDistinct;
+   size_t u;
+
+   assert(oDynArray != NULL);
+   assert(oDynArray->pfKey != NULL);
+   assert(oDynArray->psKeys == NULL);
+   assert(oDynArray->uLength > 0);
+
+   MEMPROF_TAG(MEMPROF_ARRAY_KEYS);
+   COUNTERS_ADD(COUNTER_ALLOCATIONS, 1);
+   psKeys = (struct KeyIndex*)malloc(sizeof(struct KeyIndex));
+   if (psKeys == NULL)
+      return 0;
+   MEMPROF_TAG(MEMPROF_ARRAY_KEYS);
+   COUNTERS_ADD(COUNTER_ALLOCATIONS, 1);
+   psKeys->puKeys = (uint64_t*)
+      malloc(sizeof(uint64_t) * oDynArray->uPhysLength);
+   if (psKeys->puKeys == NULL)
+   {
+      free(psKeys);
+      return 0;
+   }
+   oDynArray->psKeys = psKeys;
+
+   /* The prefix is the one shared by the middle three quarters of the
+      elements, which the elements sharing it then extend. */
+   ppvArray = oDynArray->ppvArray;
+   uLength = oDynArray->uLength;
+   psKeys->uLo = uLength / 8;
+   psKeys->uHi = uLength - uLength / 8;
+   psKeys->uOffset = DynArray_keyBytesShared(
+      oDynArray, ppvArray[psKeys->uLo], ppvArray[psKeys->uHi - 1],
+      8 * KEY_PREFIX_WORDS);
+   for (u = 0; 8 * u < psKeys->uOffset; u++)
+      psKeys->auPrefix[u] =
+         (*oDynArray->pfKey)(ppvArray[psKeys->uLo], 8 * u);
+   while (psKeys->uLo > 0 &&
+          DynArray_comparePrefix(oDynArray,
+                                 ppvArray[psKeys->uLo - 1]) == 0)
+      psKeys->uLo--;
+   while (psKeys->uHi < uLength &&
+          DynArray_comparePrefix(oDynArray,
+                                 ppvArray[psKeys->uHi]) == 0)
+      psKeys->uHi++;
+
+   uDistinct = 0;
+   for (u = 0; u < uLength; u++)
+   {
+      psKeys->puKeys[u] =
+         (*oDynArray->pfKey)(ppvArray[u], psKeys->uOffset);
+      if (u > psKeys->uLo && u < psKeys->uHi &&
+          psKeys->puKeys[u] != psKeys->puKeys[u - 1])
+         uDistinct++;
+   }
+   psKeys->iNarrows =
+      (4 * (uDistinct + 1) >= 3 * (psKeys->uHi - psKeys->uLo));
+   psKeys->uBuiltLength = uLength;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Record in the keys of oDynArray, if it has them, that *pvElement now
+   sits at uIndex, having been inserted there if iInserted is 1
+   (TRUE) and replaced the element there if it is 0 (FALSE).  Drop the
+   keys if the elements starting with their prefix are no longer
+   together, as happens when the array is not sorted. */
+
+static void DynArray_keyAdded(DynArray_T oDynArray, size_t uIndex,
+                              const void *pvElement, int iInserted)
+{
+   struct KeyIndex *psKeys;
+   int iShares;
+
+   assert(oDynArray != NULL);
+
+   psKeys = oDynArray->psKeys;
+   if (psKeys == NULL)
+      return;
+
+   psKeys->puKeys[uIndex] =
+      (*oDynArray->pfKey)(pvElement, psKeys->uOffset);
+   iShares = (DynArray_comparePrefix(oDynArray, pvElement) == 0);
+
+   if (! iInserted)
+   {
+      if (iShares != (uIndex >= psKeys->uLo && uIndex < psKeys->uHi))
+         DynArray_dropKeys(oDynArray);
+   }
+   else if (iShares)
+   {
+      if (uIndex < psKeys->uLo || uIndex > psKeys->uHi)
+         DynArray_dropKeys(oDynArray);
+      else
+         psKeys->uHi++;
+   }
+   else if (uIndex <= psKeys->uLo)
+   {
+      psKeys->uLo++;
+      psKeys->uHi++;
+   }
+   else if (uIndex < psKeys->uHi)
+      DynArray_dropKeys(oDynArray);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Record in the keys of oDynArray, if it has them, that the uCount
+   elements from uIndex on have been removed. */
+
+static void DynArray_keysRemoved(DynArray_T oDynArray, size_t uIndex,
+                                 size_t uCount)
+{
+   struct KeyIndex *psKeys;
+
+   assert(oDynArray != NULL);
+
+   psKeys = oDynArray->psKeys;
+   if (psKeys == NULL)
+      return;
+
+   /* Each bound moves down by the removed elements below it. */
+   if (psKeys->uLo > uIndex)
+      psKeys->uLo -= (psKeys->uLo - uIndex < uCount) ?
+         psKeys->uLo - uIndex : uCount;
+   if (psKeys->uHi > uIndex)
+      psKeys->uHi -= (psKeys->uHi - uIndex < uCount) ?
+         psKeys->uHi - uIndex : uCount;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Change the physical length of oDynArray to uNewLength, which must
+   be at least its logical length.  Return 1 (TRUE) if successful and
+   0 (FALSE) if insufficient memory is available. */
+
+static int DynArray_resize(DynArray_T oDynArray, size_t uNewLength)
+{
    const void **ppvNewArray;
+   uint64_t *puNewKeys;
 
    assert(oDynArray != NULL);
+   assert(uNewLength >= oDynArray->uLength);
 
-   uNewLength = GROWTH_FACTOR * oDynArray->uPhysLength;
+   if (uNewLength < MIN_PHYS_LENGTH)
+      uNewLength = MIN_PHYS_LENGTH;
+   if (uNewLength == oDynArray->uPhysLength)
+      return 1;
 
+   COUNTERS_ADD(COUNTER_ALLOCATIONS, 1);
    ppvNewArray = (const void**)
       realloc(oDynArray->ppvArray, sizeof(void*) * uNewLength);
    if (ppvNewArray == NULL)
       return 0;
 
-   oDynArray->uPhysLength = uNewLength;
    oDynArray->ppvArray = ppvNewArray;
+
+   if (oDynArray->psKeys != NULL)
+   {
+      COUNTERS_ADD(COUNTER_ALLOCATIONS, 1);
+      puNewKeys = (uint64_t*)realloc(oDynArray->psKeys->puKeys,
+                                     sizeof(uint64_t) * uNewLength);
+      if (puNewKeys == NULL)
+         DynArray_dropKeys(oDynArray);
+      else
+         oDynArray->psKeys->puKeys = puNewKeys;
+   }
+
+   oDynArray->uPhysLength = uNewLength;
    return 1;
 }
 
 /*--------------------------------------------------------------------*/
 
+/* Increase the physical length of oDynArray, according to its growth
+   policy, until it can hold uNeeded elements.  Return 1 (TRUE) if
+   successful and 0 (FALSE) if insufficient memory is available. */
+
+static int DynArray_grow(DynArray_T oDynArray, size_t uNeeded)
+{
+   size_t uNewLength;
+   size_t uGrown;
+
+   assert(oDynArray != NULL);
+
+   if (uNeeded <= oDynArray->uPhysLength)
+      return 1;
+
+   uNewLength = oDynArray->uPhysLength;
+   while (uNewLength < uNeeded)
+   {
+      /* Split the product so that it cannot overflow early. */
+      uGrown = uNewLength / 100 * oDynArray->uGrowPercent
+         + uNewLength % 100 * oDynArray->uGrowPercent / 100;
+      if (uGrown <= uNewLength)
+         uGrown = uNewLength + 1;
+      uNewLength = uGrown;
+   }
+
+   return DynArray_resize(oDynArray, uNewLength);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Decrease the physical length of oDynArray if its shrink policy
+   calls for it after a removal.  Running out of memory while
+   shrinking is harmless, so nothing is returned. */
+
+static void DynArray_shrink(DynArray_T oDynArray)
+{
+   size_t uNewLength;
+
+   assert(oDynArray != NULL);
+
+   if (oDynArray->uShrinkPercent == 0)
+      return;
+
+   /* Shrink in one step to twice the logical length, however many
+      elements were removed, leaving slack so that alternating adds
+      and removals at the threshold do not resize every time.  The
+      shrink percentage is under 50, so this is a shrink. */
+   if (oDynArray->uLength * 100 <=
+       oDynArray->uPhysLength * oDynArray->uShrinkPercent)
+   {
+      uNewLength = 2 * oDynArray->uLength;
+      if (uNewLength < MIN_PHYS_LENGTH)
+         uNewLength = MIN_PHYS_LENGTH;
+      if (uNewLength < oDynArray->uPhysLength)
+         (void)DynArray_resize(oDynArray, uNewLength);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
 DynArray_T DynArray_new(size_t uLength)
 {
    DynArray_T oDynArray;
 
+   MEMPROF_TAG(MEMPROF_ARRAY_HEADER);
+   COUNTERS_ADD(COUNTER_ALLOCATIONS, 1);
    oDynArray = (struct DynArray*)malloc(sizeof(struct DynArray));
    if (oDynArray == NULL)
       return NULL;
@@ -91,6 +485,13 @@ DynArray_T DynArray_new(size_t uLength)
    else
       oDynArray->uPhysLength = MIN_PHYS_LENGTH;
 
+   oDynArray->pfKey = NULL;
+   oDynArray->psKeys = NULL;
+   oDynArray->uGrowPercent = DEFAULT_GROW_PERCENT;
+   oDynArray->uShrinkPercent = DEFAULT_SHRINK_PERCENT;
+
+   MEMPROF_TAG(MEMPROF_ARRAY_BACKING);
+   COUNTERS_ADD(COUNTER_ALLOCATIONS, 1);
    oDynArray->ppvArray =
       (const void**)calloc(oDynArray->uPhysLength, sizeof(void*));
    if (oDynArray->ppvArray == NULL)
@@ -109,6 +510,7 @@ void DynArray_free(DynArray_T oDynArray)
    assert(oDynArray != NULL);
    assert(DynArray_isValid(oDynArray));
 
+   DynArray_dropKeys(oDynArray);
    free(oDynArray->ppvArray);
    free(oDynArray);
 }
@@ -147,6 +549,7 @@ void *DynArray_set(DynArray_T oDynArray, size_t uIndex,
 
    pvOldElement = oDynArray->ppvArray[uIndex];
    oDynArray->ppvArray[uIndex] = pvElement;
+   DynArray_keyAdded(oDynArray, uIndex, pvElement, 0);
 
    assert(DynArray_isValid(oDynArray));
 
@@ -160,12 +563,12 @@ int DynArray_add(DynArray_T oDynArray, const void *pvElement)
    assert(oDynArray != NULL);
    assert(DynArray_isValid(oDynArray));
 
-   if (oDynArray->uLength == oDynArray->uPhysLength)
-      if (! DynArray_grow(oDynArray))
-         return 0;
+   if (! DynArray_grow(oDynArray, oDynArray->uLength + 1))
+      return 0;
 
    oDynArray->ppvArray[oDynArray->uLength] = pvElement;
    oDynArray->uLength++;
+   DynArray_keyAdded(oDynArray, oDynArray->uLength - 1, pvElement, 1);
 
    assert(DynArray_isValid(oDynArray));
 
@@ -177,185 +580,882 @@ int DynArray_add(DynArray_T oDynArray, const void *pvElement)
 int DynArray_addAt(DynArray_T oDynArray, size_t uIndex,
                    const void *pvElement)
 {
-   size_t u;
-
    assert(oDynArray != NULL);
    assert(uIndex <= oDynArray->uLength);
    assert(DynArray_isValid(oDynArray));
 
-   if (oDynArray->uLength == oDynArray->uPhysLength)
-      if (! DynArray_grow(oDynArray))
-         return 0;
+   return DynArray_addRange(oDynArray, uIndex, &pvElement, 1);
+}
 
-   for (u = oDynArray->uLength; u > uIndex; u--)
-      oDynArray->ppvArray[u] = oDynArray->ppvArray[u-1];
+/*--------------------------------------------------------------------*/
 
-   oDynArray->ppvArray[uIndex] = pvElement;
-   oDynArray->uLength++;
+void *DynArray_removeAt(DynArray_T oDynArray, size_t uIndex)
+{
+   void *pvOldElement;
 
+   assert(oDynArray != NULL);
+   assert(uIndex < oDynArray->uLength);
    assert(DynArray_isValid(oDynArray));
 
-   return 1;
+   DynArray_removeRange(oDynArray, uIndex, 1, &pvOldElement);
+
+   return pvOldElement;
 }
 
 /*--------------------------------------------------------------------*/
 
-void *DynArray_removeAt(DynArray_T oDynArray, size_t uIndex)
+int DynArray_addRange(DynArray_T oDynArray, size_t uIndex,
+                      const void *const *ppvElements, size_t uCount)
 {
-   const void *pvOldElement;
+   size_t uTail;
    size_t u;
 
    assert(oDynArray != NULL);
-   assert(uIndex < oDynArray->uLength);
+   assert(uIndex <= oDynArray->uLength);
+   assert(ppvElements != NULL || uCount == 0);
    assert(DynArray_isValid(oDynArray));
 
-   pvOldElement = oDynArray->ppvArray[uIndex];
+   if (! DynArray_grow(oDynArray, oDynArray->uLength + uCount))
+      return 0;
+
+   uTail = oDynArray->uLength - uIndex;
+   memmove(&oDynArray->ppvArray[uIndex + uCount],
+           &oDynArray->ppvArray[uIndex], uTail * sizeof(void*));
+   if (uCount > 0)
+      memcpy(&oDynArray->ppvArray[uIndex], ppvElements,
+             uCount * sizeof(void*));
 
-   oDynArray->uLength--;
+   oDynArray->uLength += uCount;
 
-   for (u = uIndex; u < oDynArray->uLength; u++)
-      oDynArray->ppvArray[u] = oDynArray->ppvArray[u+1];
+   if (oDynArray->psKeys != NULL)
+      memmove(&oDynArray->psKeys->puKeys[uIndex + uCount],
+              &oDynArray->psKeys->puKeys[uIndex],
+              uTail * sizeof(uint64_t));
+   for (u = 0; u < uCount; u++)
+      DynArray_keyAdded(oDynArray, uIndex + u, ppvElements[u], 1);
 
    assert(DynArray_isValid(oDynArray));
 
-   return (void*)pvOldElement;
+   return 1;
 }
 
 /*--------------------------------------------------------------------*/
 
-void DynArray_toArray(DynArray_T oDynArray, void **ppvArray)
+void DynArray_removeRange(DynArray_T oDynArray, size_t uIndex,
+                          size_t uCount, void **ppvRemoved)
 {
-   size_t u;
+   size_t uTail;
 
    assert(oDynArray != NULL);
-   assert(ppvArray != NULL);
+   assert(uIndex <= oDynArray->uLength);
+   assert(uCount <= oDynArray->uLength - uIndex);
    assert(DynArray_isValid(oDynArray));
 
-   for (u = 0; u < oDynArray->uLength; u++)
-      ppvArray[u] = (void*)oDynArray->ppvArray[u];
+   if (ppvRemoved != NULL)
+      memcpy(ppvRemoved, &oDynArray->ppvArray[uIndex],
+             uCount * sizeof(void*));
+
+   uTail = oDynArray->uLength - uIndex - uCount;
+   memmove(&oDynArray->ppvArray[uIndex],
+           &oDynArray->ppvArray[uIndex + uCount],
+           uTail * sizeof(void*));
+   if (oDynArray->psKeys != NULL)
+      memmove(&oDynArray->psKeys->puKeys[uIndex],
+              &oDynArray->psKeys->puKeys[uIndex + uCount],
+              uTail * sizeof(uint64_t));
+   DynArray_keysRemoved(oDynArray, uIndex, uCount);
+
+   oDynArray->uLength -= uCount;
+   DynArray_shrink(oDynArray);
+
+   assert(DynArray_isValid(oDynArray));
 }
 
 /*--------------------------------------------------------------------*/
 
-void DynArray_map(DynArray_T oDynArray,
-                  void (*pfApply)(void *pvElement, void *pvExtra),
-                  const void *pvExtra)
+int DynArray_mergeSorted(DynArray_T oDynArray,
+                         const void *const *ppvElements, size_t uCount,
+                         int (*pfCompare)(const void *pvElement1,
+                                          const void *pvElement2))
 {
-   size_t u;
+   size_t uOld;
+   size_t uNew;
+   size_t uDest;
 
    assert(oDynArray != NULL);
-   assert(pfApply != NULL);
+   assert(ppvElements != NULL || uCount == 0);
+   assert(pfCompare != NULL);
    assert(DynArray_isValid(oDynArray));
 
-   for (u = 0; u < oDynArray->uLength; u++)
-      (*pfApply)((void*)oDynArray->ppvArray[u], (void*)pvExtra);
+   if (! DynArray_grow(oDynArray, oDynArray->uLength + uCount))
+      return 0;
+
+   /* Merge from the back, so every element moves exactly once and
+      none is overwritten before it has moved.  On ties the existing
+      element stays first. */
+   uOld = oDynArray->uLength;
+   uNew = uCount;
+   uDest = uOld + uCount;
+   while (uNew > 0)
+   {
+      uDest--;
+      if (uOld > 0 &&
+          (*pfCompare)(oDynArray->ppvArray[uOld-1],
+                       ppvElements[uNew-1]) > 0)
+         oDynArray->ppvArray[uDest] = oDynArray->ppvArray[--uOld];
+      else
+         oDynArray->ppvArray[uDest] = ppvElements[--uNew];
+   }
+
+   oDynArray->uLength += uCount;
+
+   /* The keys no longer parallel the elements. */
+   if (uCount > 0)
+      DynArray_dropKeys(oDynArray);
+
+   assert(DynArray_isValid(oDynArray));
+
+   return 1;
 }
 
 /*--------------------------------------------------------------------*/
 
-/* Sort the array of elements that resides in memory at
-   addresses ppvLo...ppvHi in ascending order, as determined
-   by *pfCompare.
-   *pfCompare must return <0, 0, or >0 depending upon whether
-   *pvElement1 is less than, equal to, or greater than *pvElement2,
-   respectively. */
-
-static void DynArray_qsort(
-   const void **ppvLo,
-   const void **ppvHi,
-   int (*pfCompare) (const void *pvElement1, const void *pvElement2))
+int DynArray_reserve(DynArray_T oDynArray, size_t uLength)
 {
-   /* This function implements a variation of the quicksort algorithm
-      shown in the book "Algorithms + Data Structures = Programs" by
-      Niklaus Wirth. */
+   assert(oDynArray != NULL);
+   assert(DynArray_isValid(oDynArray));
 
-   /* This function uses pointers instead of indices to avoid
-      complications with using unsigned integers as array indices. */
+   if (uLength <= oDynArray->uPhysLength)
+      return 1;
+   return DynArray_resize(oDynArray, uLength);
+}
 
-   const void **ppvRight;
-   const void **ppvLeft;
-   const void *pvPivot;
-   const void *pvTemp;
+/*--------------------------------------------------------------------*/
 
-   assert(ppvLo != NULL);
-   assert(ppvHi != NULL);
-   assert(pfCompare != NULL);
+int DynArray_shrinkToFit(DynArray_T oDynArray)
+{
+   int iSuccessful;
 
-   ppvRight = ppvLo;
-   ppvLeft = ppvHi;
-   pvPivot = *(ppvLo + ((ppvHi - ppvLo) / 2));
+   assert(oDynArray != NULL);
+   assert(DynArray_isValid(oDynArray));
 
-   while (ppvRight <= ppvLeft)
-   {
-      while ((*pfCompare)(*ppvRight, pvPivot) < 0)
-         ppvRight++;
-      while ((*pfCompare)(pvPivot, *ppvLeft) < 0)
-         ppvLeft--;
-      if (ppvRight <= ppvLeft)
-      {
-         /* Swap *ppvRight and *ppvLeft. */
-         pvTemp = *ppvRight;
-         *ppvRight = *ppvLeft;
-         *ppvLeft = pvTemp;
+   iSuccessful = DynArray_resize(oDynArray, oDynArray->uLength);
 
-         ppvRight++;
-         ppvLeft--;
-      }
-   }
+   assert(DynArray_isValid(oDynArray));
 
-   if (ppvLo < ppvLeft)
-      DynArray_qsort(ppvLo, ppvLeft, pfCompare);
-   if (ppvRight < ppvHi)
-      DynArray_qsort(ppvRight, ppvHi, pfCompare);
+   return iSuccessful;
 }
 
 /*--------------------------------------------------------------------*/
 
-void DynArray_sort(DynArray_T oDynArray,
-                   int (*pfCompare)(const void *pvElement1,
-                                    const void *pvElement2))
+void DynArray_setGrowthPolicy(DynArray_T oDynArray,
+                              size_t uGrowPercent,
+                              size_t uShrinkPercent)
 {
    assert(oDynArray != NULL);
-   assert(pfCompare != NULL);
+   assert(uGrowPercent > 100);
+   assert(uShrinkPercent < 50);
    assert(DynArray_isValid(oDynArray));
 
-   if (oDynArray->uLength < 2)
-      return;
-
-   DynArray_qsort(
-      &oDynArray->ppvArray[0],
-      &oDynArray->ppvArray[oDynArray->uLength-1],
-      pfCompare);
-
-   assert(DynArray_isValid(oDynArray));
+   oDynArray->uGrowPercent = uGrowPercent;
+   oDynArray->uShrinkPercent = uShrinkPercent;
 }
 
 /*--------------------------------------------------------------------*/
 
-int DynArray_search(DynArray_T oDynArray,
-                    void *pvSoughtElement,
-                    size_t *puIndex,
-                    int (*pfCompare)(const void *pvElement1,
-                                     const void *pvElement2))
+void DynArray_toArray(DynArray_T oDynArray, void **ppvArray)
 {
    size_t u;
 
    assert(oDynArray != NULL);
-   assert(puIndex != NULL);
-   assert(pfCompare != NULL);
+   assert(ppvArray != NULL);
    assert(DynArray_isValid(oDynArray));
 
    for (u = 0; u < oDynArray->uLength; u++)
-      if ((*pfCompare)(oDynArray->ppvArray[u], pvSoughtElement) == 0)
-      {
-         *puIndex = u;
-         return 1;
-      }
-   return 0;
+      ppvArray[u] = (void*)oDynArray->ppvArray[u];
 }
 
-
-
+/*--------------------------------------------------------------------*/
+
+void DynArray_map(DynArray_T oDynArray,
+                  void (*pfApply)(void *pvElement, void *pvExtra),
+                  const void *pvExtra)
+{
+   size_t u;
+
+   assert(oDynArray != NULL);
+   assert(pfApply != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   for (u = 0; u < oDynArray->uLength; u++)
+      (*pfApply)((void*)oDynArray->ppvArray[u], (void*)pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A ParallelJob describes one DynArray_parallelMap or
+   DynArray_parallelReduce call to the tasks that carry it out. */
+
+struct ParallelJob
+{
+   /* The DynArray being processed. */
+   DynArray_T oDynArray;
+
+   /* The number of elements in each chunk but the last. */
+   size_t uChunkLength;
+
+   /* The function applied to each element, and its extra argument:
+      pvExtra for a map, the worker's partial result for a reduce. */
+   void (*pfApply)(void *pvElement, void *pvExtra);
+   const void *pvExtra;
+
+   /* The partial results of the workers, uPartialStride bytes apart,
+      or NULL for a map. */
+   char *pcPartials;
+   size_t uPartialStride;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Apply the function of the ParallelJob at pvJob to each element of
+   the uChunk'th chunk, as worker uWorker. */
+
+static void DynArray_parallelTask(size_t uChunk, size_t uWorker,
+                                  void *pvJob)
+{
+   struct ParallelJob *psJob = (struct ParallelJob*)pvJob;
+   const void **ppvArray;
+   size_t uLo;
+   size_t uHi;
+   size_t u;
+   void *pvExtra;
+
+   assert(psJob != NULL);
+
+   ppvArray = psJob->oDynArray->ppvArray;
+   uLo = uChunk * psJob->uChunkLength;
+   uHi = uLo + psJob->uChunkLength;
+   if (uHi > psJob->oDynArray->uLength)
+      uHi = psJob->oDynArray->uLength;
+
+   if (psJob->pcPartials != NULL)
+      pvExtra = psJob->pcPartials + uWorker * psJob->uPartialStride;
+   else
+      pvExtra = (void*)psJob->pvExtra;
+
+   for (u = uLo; u < uHi; u++)
+      (*psJob->pfApply)((void*)ppvArray[u], pvExtra);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the number of chunks the ParallelJob at psJob divides its
+   DynArray into, and set its chunk length accordingly. */
+
+static size_t DynArray_planChunks(struct ParallelJob *psJob,
+                                  size_t uWorkers)
+{
+   size_t uLength;
+   size_t uChunks;
+
+   assert(psJob != NULL);
+
+   uLength = psJob->oDynArray->uLength;
+   uChunks = (uWorkers == 1) ? 1 : uWorkers * CHUNKS_PER_WORKER;
+   if (uChunks > uLength / MIN_CHUNK_LENGTH)
+      uChunks = uLength / MIN_CHUNK_LENGTH;
+   if (uChunks == 0)
+      uChunks = 1;
+
+   psJob->uChunkLength = (uLength + uChunks - 1) / uChunks;
+   if (psJob->uChunkLength == 0)
+      psJob->uChunkLength = 1;
+   return uChunks;
+}
+
+/*--------------------------------------------------------------------*/
+
+void DynArray_parallelMap(DynArray_T oDynArray,
+                          void (*pfApply)(void *pvElement,
+                                          void *pvExtra),
+                          const void *pvExtra)
+{
+   struct ParallelJob sJob;
+   size_t uChunks;
+
+   assert(oDynArray != NULL);
+   assert(pfApply != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   sJob.oDynArray = oDynArray;
+   sJob.pfApply = pfApply;
+   sJob.pvExtra = pvExtra;
+   sJob.pcPartials = NULL;
+   sJob.uPartialStride = 0;
+
+   /* Small arrays do not wake the pool at all. */
+   if (oDynArray->uLength < 2 * MIN_CHUNK_LENGTH)
+      uChunks = DynArray_planChunks(&sJob, 1);
+   else
+      uChunks = DynArray_planChunks(&sJob, ThreadPool_getNumWorkers());
+
+   ThreadPool_run(uChunks, DynArray_parallelTask, &sJob);
+}
+
+/*--------------------------------------------------------------------*/
+
+int DynArray_parallelReduce(DynArray_T oDynArray,
+                            void (*pfAccumulate)(void *pvElement,
+                                                 void *pvPartial),
+                            void (*pfCombine)(void *pvPartial,
+                                              void *pvResult),
+                            size_t uPartialSize,
+                            void *pvResult)
+{
+   struct ParallelJob sJob;
+   size_t uWorkers = 1;
+   size_t uChunks;
+   size_t u;
+
+   assert(oDynArray != NULL);
+   assert(pfAccumulate != NULL);
+   assert(pfCombine != NULL);
+   assert(uPartialSize > 0);
+   assert(pvResult != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   /* Small arrays do not wake the pool at all. */
+   if (oDynArray->uLength >= 2 * MIN_CHUNK_LENGTH)
+      uWorkers = ThreadPool_getNumWorkers();
+
+   sJob.oDynArray = oDynArray;
+   sJob.pfApply = pfAccumulate;
+   sJob.pvExtra = NULL;
+   sJob.uPartialStride = (uPartialSize + CACHE_LINE_SIZE - 1)
+      / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+   sJob.pcPartials = (char*)calloc(uWorkers, sJob.uPartialStride);
+   if (sJob.pcPartials == NULL)
+      return 0;
+
+   uChunks = DynArray_planChunks(&sJob, uWorkers);
+   ThreadPool_run(uChunks, DynArray_parallelTask, &sJob);
+
+   for (u = 0; u < uWorkers; u++)
+      (*pfCombine)(sJob.pcPartials + u * sJob.uPartialStride, pvResult);
+
+   free(sJob.pcPartials);
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Arrays of at most this many elements are sorted by insertion sort
+   rather than partitioned further. */
+
+static const size_t INSERTION_SORT_LENGTH = 16;
+
+/*--------------------------------------------------------------------*/
+
+/* Sort the array of elements that resides in memory at
+   addresses ppvLo...ppvHi in ascending order by insertion sort, as
+   determined by *pfCompare. */
+
+static void DynArray_insertionSort(
+   const void **ppvLo,
+   const void **ppvHi,
+   int (*pfCompare) (const void *pvElement1, const void *pvElement2))
+{
+   const void **ppvCurr;
+   const void **ppvHole;
+   const void *pvElement;
+
+   assert(ppvLo != NULL);
+   assert(ppvHi != NULL);
+   assert(pfCompare != NULL);
+
+   for (ppvCurr = ppvLo + 1; ppvCurr <= ppvHi; ppvCurr++)
+   {
+      pvElement = *ppvCurr;
+      for (ppvHole = ppvCurr;
+           ppvHole > ppvLo && (*pfCompare)(pvElement, *(ppvHole-1)) < 0;
+           ppvHole--)
+         *ppvHole = *(ppvHole-1);
+      *ppvHole = pvElement;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Restore the max-heap order of the uLength elements at ppvBase by
+   sifting the uRoot'th element down, as determined by *pfCompare. */
+
+static void DynArray_siftDown(
+   const void **ppvBase,
+   size_t uRoot,
+   size_t uLength,
+   int (*pfCompare) (const void *pvElement1, const void *pvElement2))
+{
+   const void *pvElement;
+   size_t uChild;
+
+   assert(ppvBase != NULL);
+   assert(pfCompare != NULL);
+
+   pvElement = ppvBase[uRoot];
+   while ((uChild = 2 * uRoot + 1) < uLength)
+   {
+      if (uChild + 1 < uLength &&
+          (*pfCompare)(ppvBase[uChild], ppvBase[uChild+1]) < 0)
+         uChild++;
+      if ((*pfCompare)(pvElement, ppvBase[uChild]) >= 0)
+         break;
+      ppvBase[uRoot] = ppvBase[uChild];
+      uRoot = uChild;
+   }
+   ppvBase[uRoot] = pvElement;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Sort the array of elements that resides in memory at
+   addresses ppvLo...ppvHi in ascending order by heapsort, as
+   determined by *pfCompare. */
+
+static void DynArray_heapSort(
+   const void **ppvLo,
+   const void **ppvHi,
+   int (*pfCompare) (const void *pvElement1, const void *pvElement2))
+{
+   size_t uLength;
+   size_t u;
+   const void *pvTemp;
+
+   assert(ppvLo != NULL);
+   assert(ppvHi != NULL);
+   assert(pfCompare != NULL);
+
+   uLength = (size_t)(ppvHi - ppvLo) + 1;
+
+   for (u = uLength / 2; u > 0; u--)
+      DynArray_siftDown(ppvLo, u - 1, uLength, pfCompare);
+
+   for (u = uLength - 1; u > 0; u--)
+   {
+      pvTemp = ppvLo[0];
+      ppvLo[0] = ppvLo[u];
+      ppvLo[u] = pvTemp;
+      DynArray_siftDown(ppvLo, 0, u, pfCompare);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Return the median of *pvElement1, *pvElement2, and *pvElement3, as
+   determined by *pfCompare. */
+
+static const void *DynArray_median(
+   const void *pvElement1,
+   const void *pvElement2,
+   const void *pvElement3,
+   int (*pfCompare) (const void *pvElement1, const void *pvElement2))
+{
+   assert(pfCompare != NULL);
+
+   if ((*pfCompare)(pvElement1, pvElement2) < 0)
+   {
+      if ((*pfCompare)(pvElement2, pvElement3) < 0)
+         return pvElement2;
+      if ((*pfCompare)(pvElement1, pvElement3) < 0)
+         return pvElement3;
+      return pvElement1;
+   }
+   if ((*pfCompare)(pvElement1, pvElement3) < 0)
+      return pvElement1;
+   if ((*pfCompare)(pvElement2, pvElement3) < 0)
+      return pvElement3;
+   return pvElement2;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Sort the array of elements that resides in memory at
+   addresses ppvLo...ppvHi in ascending order, as determined
+   by *pfCompare.  Fall back to heapsort once uDepth levels of
+   partitioning have been spent.
+   *pfCompare must return <0, 0, or >0 depending upon whether
+   *pvElement1 is less than, equal to, or greater than *pvElement2,
+   respectively. */
+
+static void DynArray_introsort(
+   const void **ppvLo,
+   const void **ppvHi,
+   int (*pfCompare) (const void *pvElement1, const void *pvElement2),
+   size_t uDepth)
+{
+   /* This function implements introsort: the partitioning scheme of
+      Wirth's quicksort with a median-of-three pivot, insertion sort
+      for short ranges, and heapsort once the recursion grows too
+      deep, which bounds the worst case at O(n log n). */
+
+   /* This function uses pointers instead of indices to avoid
+      complications with using unsigned integers as array indices. */
+
+   const void **ppvRight;
+   const void **ppvLeft;
+   const void *pvPivot;
+   const void *pvTemp;
+
+   assert(ppvLo != NULL);
+   assert(ppvHi != NULL);
+   assert(pfCompare != NULL);
+
+   while ((size_t)(ppvHi - ppvLo) >= INSERTION_SORT_LENGTH)
+   {
+      if (uDepth == 0)
+      {
+         DynArray_heapSort(ppvLo, ppvHi, pfCompare);
+         return;
+      }
+      uDepth--;
+
+      ppvRight = ppvLo;
+      ppvLeft = ppvHi;
+      pvPivot = DynArray_median(*ppvLo,
+                                *(ppvLo + ((ppvHi - ppvLo) / 2)),
+                                *ppvHi, pfCompare);
+
+      while (ppvRight <= ppvLeft)
+      {
+         while ((*pfCompare)(*ppvRight, pvPivot) < 0)
+            ppvRight++;
+         while ((*pfCompare)(pvPivot, *ppvLeft) < 0)
+            ppvLeft--;
+         if (ppvRight <= ppvLeft)
+         {
+            /* Swap *ppvRight and *ppvLeft. */
+            pvTemp = *ppvRight;
+            *ppvRight = *ppvLeft;
+            *ppvLeft = pvTemp;
+
+            ppvRight++;
+            ppvLeft--;
+         }
+      }
+
+      /* Recurse into the smaller side and loop on the larger, so the
+         stack never holds more than log n frames. */
+      if (ppvLeft - ppvLo < ppvHi - ppvRight)
+      {
+         if (ppvLo < ppvLeft)
+            DynArray_introsort(ppvLo, ppvLeft, pfCompare, uDepth);
+         ppvLo = ppvRight;
+      }
+      else
+      {
+         if (ppvRight < ppvHi)
+            DynArray_introsort(ppvRight, ppvHi, pfCompare, uDepth);
+         ppvHi = ppvLeft;
+      }
+      if (ppvLo >= ppvHi)
+         return;
+   }
+
+   DynArray_insertionSort(ppvLo, ppvHi, pfCompare);
+}
+
+/*--------------------------------------------------------------------*/
+
+void DynArray_sort(DynArray_T oDynArray,
+                   int (*pfCompare)(const void *pvElement1,
+                                    const void *pvElement2))
+{
+   size_t uDepth = 0;
+   size_t u;
+
+   assert(oDynArray != NULL);
+   assert(pfCompare != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   if (oDynArray->uLength < 2)
+      return;
+
+   /* Allow 2 * floor(log2(n)) levels of partitioning. */
+   for (u = oDynArray->uLength; u > 1; u /= 2)
+      uDepth += 2;
+
+   DynArray_introsort(
+      &oDynArray->ppvArray[0],
+      &oDynArray->ppvArray[oDynArray->uLength-1],
+      pfCompare,
+      uDepth);
+
+   /* The keys no longer parallel the elements. */
+   DynArray_dropKeys(oDynArray);
+
+   assert(DynArray_isValid(oDynArray));
+}
+
+/*--------------------------------------------------------------------*/
+
+/* A StringElement pairs an element of a DynArray being sorted by
+   DynArray_sortStrings with the string that it sorts by. */
+
+struct StringElement
+{
+   /* The 8 characters of the string from the depth at which it is
+      being sorted on, the first in the most significant byte, with
+      zero bytes past its end. */
+   uint64_t uWord;
+
+   /* The string of the element. */
+   const unsigned char *pucString;
+
+   /* The element itself. */
+   const void *pvElement;
+};
+
+/*--------------------------------------------------------------------*/
+
+/* Return the 8 characters of pucString from index uDepth on, packed
+   as in a StringElement.  pucString must be at least uDepth
+   characters long. */
+
+static uint64_t DynArray_stringWord(const unsigned char *pucString,
+                                    size_t uDepth)
+{
+   uint64_t uWord = 0;
+   size_t u;
+
+   assert(pucString != NULL);
+
+   pucString += uDepth;
+   for (u = 0; u < sizeof(uWord); u++)
+   {
+      uWord <<= 8;
+      if (*pucString != '\0')
+         uWord |= *pucString++;
+   }
+   return uWord;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Swap the StringElements *psElement1 and *psElement2. */
+
+static void DynArray_swapStrings(struct StringElement *psElement1,
+                                 struct StringElement *psElement2)
+{
+   struct StringElement sTemp;
+
+   assert(psElement1 != NULL);
+   assert(psElement2 != NULL);
+
+   sTemp = *psElement1;
+   *psElement1 = *psElement2;
+   *psElement2 = sTemp;
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Compare the strings of *psElement1 and *psElement2, which agree on
+   their first uDepth characters and whose words hold the next 8, as
+   strcmp does. */
+
+static int DynArray_compareStrings(
+   const struct StringElement *psElement1,
+   const struct StringElement *psElement2,
+   size_t uDepth)
+{
+   assert(psElement1 != NULL);
+   assert(psElement2 != NULL);
+
+   if (psElement1->uWord != psElement2->uWord)
+      return (psElement1->uWord < psElement2->uWord) ? -1 : 1;
+
+   /* Equal words that end within them are equal strings. */
+   if ((psElement1->uWord & 0xff) == 0)
+      return 0;
+   return strcmp((const char*)psElement1->pucString + uDepth + 8,
+                 (const char*)psElement2->pucString + uDepth + 8);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Sort the uLength StringElements at psElements, whose strings are
+   known to agree on their first uDepth characters and whose words
+   hold the next 8, in ascending strcmp order of their strings. */
+
+static void DynArray_multikeyQsort(struct StringElement *psElements,
+                                   size_t uLength, size_t uDepth)
+{
+   /* This function implements the multikey quicksort of Bentley and
+      Sedgewick, on 8 characters at a time: partition three ways on
+      the cached words, then sort the equal part on the next word.
+      Partitioning reads only the StringElements, so each string is
+      read once per level of the recursion that reaches it. */
+
+   struct StringElement sElement;
+   uint64_t uPivot;
+   uint64_t uFirst;
+   uint64_t uMiddle;
+   uint64_t uLast;
+   size_t uLt;
+   size_t uGt;
+   size_t u;
+   size_t v;
+
+   assert(psElements != NULL);
+
+   while (uLength > 1)
+   {
+      /* Short runs: insertion sort, comparing the cached words
+         first. */
+      if (uLength <= INSERTION_SORT_LENGTH)
+      {
+         for (u = 1; u < uLength; u++)
+         {
+            sElement = psElements[u];
+            for (v = u; v > 0 &&
+                    DynArray_compareStrings(&sElement,
+                                            &psElements[v-1],
+                                            uDepth) < 0;
+                 v--)
+               psElements[v] = psElements[v-1];
+            psElements[v] = sElement;
+         }
+         return;
+      }
+
+      /* The pivot is the median of the first, middle, and last
+         words, so that sorted and reversed runs split evenly. */
+      uFirst = psElements[0].uWord;
+      uMiddle = psElements[uLength / 2].uWord;
+      uLast = psElements[uLength - 1].uWord;
+      if ((uFirst < uMiddle) == (uMiddle < uLast))
+         uPivot = uMiddle;
+      else if ((uMiddle < uFirst) == (uFirst < uLast))
+         uPivot = uFirst;
+      else
+         uPivot = uLast;
+
+      /* Invariant: [0, uLt) < pivot, [uLt, u) == pivot,
+         (uGt, uLength) > pivot.  Some word equals the pivot, so uGt
+         never passes below it. */
+      uLt = 0;
+      u = 0;
+      uGt = uLength - 1;
+      while (u <= uGt)
+      {
+         if (psElements[u].uWord < uPivot)
+            DynArray_swapStrings(&psElements[uLt++], &psElements[u++]);
+         else if (psElements[u].uWord > uPivot)
+         {
+            /* Leave greater elements already on the right in place,
+               so that sorted runs stay sorted. */
+            while (psElements[uGt].uWord > uPivot)
+               uGt--;
+            if (u < uGt)
+               DynArray_swapStrings(&psElements[u], &psElements[uGt--]);
+         }
+         else
+            u++;
+      }
+
+      DynArray_multikeyQsort(psElements, uLt, uDepth);
+      DynArray_multikeyQsort(psElements + uGt + 1,
+                             uLength - uGt - 1, uDepth);
+
+      /* Strings that ended within the pivot are all equal. */
+      if ((uPivot & 0xff) == 0)
+         return;
+
+      psElements += uLt;
+      uLength = uGt + 1 - uLt;
+      uDepth += 8;
+      for (u = 0; u < uLength; u++)
+         psElements[u].uWord =
+            DynArray_stringWord(psElements[u].pucString, uDepth);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+
+int DynArray_sortStrings(
+   DynArray_T oDynArray,
+   const char *(*pfGetString)(const void *pvElement))
+{
+   enum { LOCAL_LENGTH = 64 };
+   struct StringElement asLocal[LOCAL_LENGTH];
+   struct StringElement *psElements = asLocal;
+   size_t u;
+
+   assert(oDynArray != NULL);
+   assert(pfGetString != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   if (oDynArray->uLength < 2)
+      return 1;
+
+   /* Fetch each string once rather than on every comparison, on
+      the stack if the array is short. */
+   if (oDynArray->uLength > LOCAL_LENGTH)
+   {
+      psElements = (struct StringElement*)
+         malloc(sizeof(struct StringElement) * oDynArray->uLength);
+      if (psElements == NULL)
+         return 0;
+   }
+
+   for (u = 0; u < oDynArray->uLength; u++)
+   {
+      psElements[u].pucString = (const unsigned char*)
+         (*pfGetString)(oDynArray->ppvArray[u]);
+      assert(psElements[u].pucString != NULL);
+      psElements[u].uWord =
+         DynArray_stringWord(psElements[u].pucString, 0);
+      psElements[u].pvElement = oDynArray->ppvArray[u];
+   }
+
+   DynArray_multikeyQsort(psElements, oDynArray->uLength, 0);
+
+   for (u = 0; u < oDynArray->uLength; u++)
+      oDynArray->ppvArray[u] = psElements[u].pvElement;
+   if (psElements != asLocal)
+      free(psElements);
+
+   /* The keys no longer parallel the elements. */
+   DynArray_dropKeys(oDynArray);
+
+   assert(DynArray_isValid(oDynArray));
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+
+int DynArray_search(DynArray_T oDynArray,
+                    void *pvSoughtElement,
+                    size_t *puIndex,
+                    int (*pfCompare)(const void *pvElement1,
+                                     const void *pvElement2))
+{
+   size_t u;
+
+   assert(oDynArray != NULL);
+   assert(puIndex != NULL);
+   assert(pfCompare != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   for (u = 0; u < oDynArray->uLength; u++)
+      if ((*pfCompare)(oDynArray->ppvArray[u], pvSoughtElement) == 0)
+      {
+         *puIndex = u;
+         return 1;
+      }
+   return 0;
+}
+
+
+
 /*--------------------------------------------------------------------*/
 
 /* Binary search the array of elements that resides in memory at
@@ -384,6 +1484,7 @@ static const void **DynArray_bsearchHelp(
    while (ppvLo <= ppvHi)
    {
       ppvMid = ppvLo + ((ppvHi - ppvLo) / 2);
+      COUNTERS_ADD(COUNTER_PROBES, 1);
       iCompare = (*pfCompare)(pvSoughtElement, *ppvMid);
       if (iCompare < 0)
          ppvHi = ppvMid - 1;
@@ -398,29 +1499,68 @@ static const void **DynArray_bsearchHelp(
 
 /*--------------------------------------------------------------------*/
 
-int DynArray_bsearch(DynArray_T oDynArray,
-                     void *pvSoughtElement,
-                     size_t *puIndex,
-                     int (*pfCompare)(const void *pvElement1,
-                                      const void *pvElement2))
+/* Return the index of the first of the uLength keys in puKeys that is
+   not less than uKey, or uLength if there is none.  puKeys must be in
+   ascending order. */
+
+static size_t DynArray_lowerBound(const uint64_t *puKeys,
+                                  size_t uLength, uint64_t uKey)
+{
+   /* The loop body has no data-dependent branch: each step halves
+      the candidate range with a conditional move, so the probe
+      sequence never stalls on a mispredicted comparison. */
+
+   const uint64_t *puBase = puKeys;
+   size_t uHalf;
+
+   assert(puKeys != NULL);
+
+   if (uLength == 0)
+      return 0;
+
+   while (uLength > 1)
+   {
+      uHalf = uLength / 2;
+      COUNTERS_ADD(COUNTER_PROBES, 1);
+      puBase = (puBase[uHalf] < uKey) ? puBase + uHalf : puBase;
+      uLength -= uHalf;
+   }
+   return (size_t)(puBase - puKeys) + (*puBase < uKey);
+}
+
+/*--------------------------------------------------------------------*/
+
+/* Binary search the elements of oDynArray from uLo up to, but not
+   including, uHi for *pvSoughtElement.  Behaves as DynArray_bsearch
+   given that, if found, it is among them, and that otherwise it
+   belongs among or right after them. */
+
+static int DynArray_searchRange(
+   DynArray_T oDynArray,
+   void *pvSoughtElement,
+   size_t uLo,
+   size_t uHi,
+   size_t *puIndex,
+   int (*pfCompare)(const void *pvElement1, const void *pvElement2))
 {
    const void **ppvElement;
    const void **ppvInsert;
 
    assert(oDynArray != NULL);
+   assert(uLo <= uHi);
+   assert(uHi <= oDynArray->uLength);
    assert(puIndex != NULL);
    assert(pfCompare != NULL);
-   assert(DynArray_isValid(oDynArray));
 
-   if (oDynArray->uLength == 0) {
-      *puIndex = 0;
+   if (uLo == uHi) {
+      *puIndex = uLo;
       return 0;
    }
 
    ppvElement = DynArray_bsearchHelp(
       pvSoughtElement,
-      &oDynArray->ppvArray[0],
-      &oDynArray->ppvArray[oDynArray->uLength-1],
+      &oDynArray->ppvArray[uLo],
+      &oDynArray->ppvArray[uHi-1],
       pfCompare,
       &ppvInsert);
 
@@ -432,3 +1572,119 @@ int DynArray_bsearch(DynArray_T oDynArray,
    *puIndex = (size_t)(ppvElement - &oDynArray->ppvArray[0]);
    return 1;
 }
+
+/*--------------------------------------------------------------------*/
+
+/* Binary search oDynArray for *pvSoughtElement by way of its side
+   array of keys, calling *pfCompare only on elements whose key equals
+   that of *pvSoughtElement, or on elements outside the prefix of the
+   keys if *pvSoughtElement does not start with it.  Behaves as
+   DynArray_bsearch. */
+
+static int DynArray_keyedSearch(
+   DynArray_T oDynArray,
+   void *pvSoughtElement,
+   size_t *puIndex,
+   int (*pfCompare)(const void *pvElement1, const void *pvElement2))
+{
+   const struct KeyIndex *psKeys;
+   uint64_t uKey;
+   size_t uFirst;
+   size_t uLast;
+   int iPrefix;
+
+   assert(oDynArray != NULL);
+   assert(oDynArray->psKeys != NULL);
+   assert(puIndex != NULL);
+   assert(pfCompare != NULL);
+
+   /* An element without the prefix lies before or after those with
+      it, and is searched for among the rest as usual. */
+   psKeys = oDynArray->psKeys;
+   iPrefix = DynArray_comparePrefix(oDynArray, pvSoughtElement);
+   if (iPrefix < 0)
+      return DynArray_searchRange(oDynArray, pvSoughtElement, 0,
+                                  psKeys->uLo, puIndex, pfCompare);
+   if (iPrefix > 0)
+      return DynArray_searchRange(oDynArray, pvSoughtElement,
+                                  psKeys->uHi, oDynArray->uLength,
+                                  puIndex, pfCompare);
+
+   uKey = (*oDynArray->pfKey)(pvSoughtElement, psKeys->uOffset);
+   uFirst = psKeys->uLo +
+      DynArray_lowerBound(psKeys->puKeys + psKeys->uLo,
+                          psKeys->uHi - psKeys->uLo, uKey);
+
+   /* No element shares the key, so none can be equal. */
+   if (uFirst == psKeys->uHi || psKeys->puKeys[uFirst] != uKey) {
+      *puIndex = uFirst;
+      return 0;
+   }
+
+   /* Most keys are unique, so one comparison usually settles it;
+      otherwise break the tie among the elements that share the
+      key. */
+   if (uFirst + 1 == psKeys->uHi || psKeys->puKeys[uFirst+1] != uKey)
+      uLast = uFirst + 1;
+   else if (uKey == UINT64_MAX)
+      uLast = psKeys->uHi;
+   else
+      uLast = uFirst + DynArray_lowerBound(psKeys->puKeys + uFirst,
+                                           psKeys->uHi - uFirst,
+                                           uKey + 1);
+   return DynArray_searchRange(oDynArray, pvSoughtElement, uFirst,
+                               uLast, puIndex, pfCompare);
+}
+
+/*--------------------------------------------------------------------*/
+
+int DynArray_bsearch(DynArray_T oDynArray,
+                     void *pvSoughtElement,
+                     size_t *puIndex,
+                     int (*pfCompare)(const void *pvElement1,
+                                      const void *pvElement2))
+{
+   struct KeyIndex *psKeys;
+
+   assert(oDynArray != NULL);
+   assert(puIndex != NULL);
+   assert(pfCompare != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   /* Large arrays with a key function search their keys first,
+      unless the keys do not tell the elements apart. */
+   if (oDynArray->pfKey != NULL &&
+       oDynArray->uLength >= KEYED_MIN_LENGTH)
+   {
+      psKeys = oDynArray->psKeys;
+      if (psKeys != NULL &&
+          (oDynArray->uLength / 2 > psKeys->uBuiltLength ||
+           oDynArray->uLength < psKeys->uBuiltLength / 2))
+         DynArray_dropKeys(oDynArray);
+      if (oDynArray->psKeys != NULL || DynArray_buildKeys(oDynArray))
+      {
+         if (oDynArray->psKeys->iNarrows)
+            return DynArray_keyedSearch(oDynArray, pvSoughtElement,
+                                        puIndex, pfCompare);
+      }
+   }
+
+   return DynArray_searchRange(oDynArray, pvSoughtElement, 0,
+                               oDynArray->uLength, puIndex,
+                               pfCompare);
+}
+
+/*--------------------------------------------------------------------*/
+
+void DynArray_setKeyFunction(DynArray_T oDynArray,
+                             uint64_t (*pfKey)(const void *pvElement,
+                                               size_t uOffset))
+{
+   assert(oDynArray != NULL);
+   assert(DynArray_isValid(oDynArray));
+
+   DynArray_dropKeys(oDynArray);
+   oDynArray->pfKey = pfKey;
+
+   assert(DynArray_isValid(oDynArray));
+}
@@ -7,6 +7,7 @@
 #define DYNARRAY_INCLUDED
 
 #include <stddef.h>
+#include <stdint.h>
 
 /* A DynArray_T object is an array whose length can expand
    dynamically. */
@@ -71,6 +72,67 @@ void *DynArray_removeAt(DynArray_T oDynArray, size_t uIndex);
 
 /*--------------------------------------------------------------------*/
 
+/* Insert the uCount elements of ppvElements into oDynArray such that
+   the first becomes its uIndex'th element, moving later elements with
+   a single memmove.  Return 1 (TRUE) if successful, or 0 (FALSE) if
+   insufficient memory is available. */
+
+int DynArray_addRange(DynArray_T oDynArray, size_t uIndex,
+                      const void *const *ppvElements, size_t uCount);
+
+/*--------------------------------------------------------------------*/
+
+/* Remove the uCount elements of oDynArray starting at the uIndex'th.
+   If ppvRemoved is not NULL, store them there; it must then be large
+   enough to hold uCount elements. */
+
+void DynArray_removeRange(DynArray_T oDynArray, size_t uIndex,
+                          size_t uCount, void **ppvRemoved);
+
+/*--------------------------------------------------------------------*/
+
+/* Merge the uCount elements of ppvElements, which must be sorted as
+   determined by *pfCompare, into oDynArray, which must be sorted the
+   same way, in O(n + uCount) time.  Elements equal to existing ones
+   are placed after them.  Return 1 (TRUE) if successful, or 0 (FALSE)
+   if insufficient memory is available. */
+
+int DynArray_mergeSorted(DynArray_T oDynArray,
+                         const void *const *ppvElements, size_t uCount,
+                         int (*pfCompare)(const void *pvElement1,
+                                          const void *pvElement2));
+
+/*--------------------------------------------------------------------*/
+
+/* Make room in oDynArray for at least uLength elements without
+   further allocation.  Return 1 (TRUE) if successful, or 0 (FALSE) if
+   insufficient memory is available. */
+
+int DynArray_reserve(DynArray_T oDynArray, size_t uLength);
+
+/*--------------------------------------------------------------------*/
+
+/* Release the memory oDynArray holds beyond what its elements need.
+   Return 1 (TRUE) if successful, or 0 (FALSE) if insufficient memory
+   is available, in which case oDynArray is unchanged. */
+
+int DynArray_shrinkToFit(DynArray_T oDynArray);
+
+/*--------------------------------------------------------------------*/
+
+/* Set the growth policy of oDynArray: when full, it grows to
+   uGrowPercent percent of its physical length, which must be over
+   100; after a removal leaves no more than uShrinkPercent percent of
+   it in use, it shrinks to twice the logical length, however many
+   elements were removed.  uShrinkPercent must be under 50, and 0
+   disables shrinking.  New DynArrays use 200 and 25. */
+
+void DynArray_setGrowthPolicy(DynArray_T oDynArray,
+                              size_t uGrowPercent,
+                              size_t uShrinkPercent);
+
+/*--------------------------------------------------------------------*/
+
 /* Fill ppvArray with the elements of oDynArray.  ppvArray must point
    to an area of memory that is large enough to hold all elements of
    oDynArray. */
@@ -89,6 +151,40 @@ void DynArray_map(DynArray_T oDynArray,
 
 /*--------------------------------------------------------------------*/
 
+/* Apply function *pfApply to each element of oDynArray, passing
+   pvExtra as an extra argument, as DynArray_map does, but spreading
+   the calls over the workers of the ThreadPool in contiguous chunks.
+   Calls run concurrently and in no particular order, so *pfApply must
+   be safe to call at once on different elements. */
+
+void DynArray_parallelMap(DynArray_T oDynArray,
+                          void (*pfApply)(void *pvElement,
+                                          void *pvExtra),
+                          const void *pvExtra);
+
+/*--------------------------------------------------------------------*/
+
+/* Reduce oDynArray to a single result using the workers of the
+   ThreadPool.  Each worker owns a partial result of uPartialSize
+   bytes, initially all zero, and calls (*pfAccumulate)(pvElement,
+   pvPartial) for each element of the chunks it processes.  The
+   partial results are then folded into *pvResult by calling
+   (*pfCombine)(pvPartial, pvResult) for each, in worker order on the
+   calling thread, so the outcome must not depend on which elements
+   were grouped together.  Return 1 (TRUE) if successful, or 0 (FALSE)
+   if insufficient memory is available, in which case *pvResult is
+   unchanged. */
+
+int DynArray_parallelReduce(DynArray_T oDynArray,
+                            void (*pfAccumulate)(void *pvElement,
+                                                 void *pvPartial),
+                            void (*pfCombine)(void *pvPartial,
+                                              void *pvResult),
+                            size_t uPartialSize,
+                            void *pvResult);
+
+/*--------------------------------------------------------------------*/
+
 /* Sort oDynArray in the order determined by *pfCompare.
    *pfCompare must return <0, 0, or >0 depending upon whether
    *pvElement1 is less than, equal to, or greater than *pvElement2,
@@ -100,6 +196,19 @@ void DynArray_sort(DynArray_T oDynArray,
 
 /*--------------------------------------------------------------------*/
 
+/* Sort oDynArray in ascending strcmp order of the strings that
+   *pfGetString returns for its elements, fetching each string only
+   once and comparing 8 characters at a time.  *pfGetString must not
+   return NULL.  Return 1 (TRUE) if successful, or 0 (FALSE) if
+   insufficient memory is available, in which case oDynArray is
+   unchanged. */
+
+int DynArray_sortStrings(
+   DynArray_T oDynArray,
+   const char *(*pfGetString)(const void *pvElement));
+
+/*--------------------------------------------------------------------*/
+
 /* Linear search oDynArray for *pvSoughtElement using *pfCompare to
    determine equality.  If the element is found, then assign its
    index to *puIndex and return 1.  If the element is not found, then
@@ -129,4 +238,27 @@ int DynArray_bsearch(DynArray_T oDynArray,
                      int (*pfCompare)(const void *pvElement1,
                                       const void *pvElement2));
 
+/*--------------------------------------------------------------------*/
+
+/* Install *pfKey as the key function of oDynArray, or remove it if
+   pfKey is NULL.  Each element must have a key string of bytes such
+   that *pvElement1 is less than *pvElement2, as determined by the
+   pfCompare passed to DynArray_bsearch, whenever its key string is
+   less, byte by byte as unsigned chars, where the shorter of two
+   strings is padded with zero bytes.  Equal key strings imply
+   nothing.  (*pfKey)(pvElement, uOffset) must return the 8 bytes of
+   the key string of *pvElement from byte uOffset on, the first in
+   the most significant byte, with zero bytes past its end.
+   Once oDynArray is large, DynArray_bsearch keeps the keys in a side
+   array and runs a branchless search over them, calling *pfCompare
+   only to break ties between equal keys.  The keys start after the
+   prefix that most elements share, so that elements such as
+   "IMG_00001234.jpg" and "IMG_00001235.jpg" get different keys; if
+   the keys still do not tell most elements apart, DynArray_bsearch
+   searches as if there were no key function. */
+
+void DynArray_setKeyFunction(DynArray_T oDynArray,
+                             uint64_t (*pfKey)(const void *pvElement,
+                                               size_t uOffset));
+
 #endif
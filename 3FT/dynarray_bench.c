@@ -0,0 +1,818 @@
+/*--------------------------------------------------------------------*/
+/* dynarray_bench.c                                                   */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "dynarray.h"
+
+/*--------------------------------------------------------------------*/
+/* The orders in which benchmark input is generated. */
+enum { RANDOM, SORTED, REVERSED, NUM_ORDERS };
+
+/* Printable names of the input orders. */
+static const char *orderNames[NUM_ORDERS] = {
+   "random", "sorted", "reverse"
+};
+
+/* The kinds of elements searched: size_t values, names sharing a
+   long prefix, and random names. */
+enum { VALUES, PREFIXED, RANDOM_NAMES, NUM_KINDS };
+
+/* Printable names of the kinds of elements searched. */
+static const char *kindNames[NUM_KINDS] = {
+   "values", "prefixed", "random"
+};
+
+/* The positions at which elements are added and removed. */
+enum { FRONT, MIDDLE, END, NUM_POSITIONS };
+
+/* The benchmark suites, each printing one table. */
+enum { SUITE_ADD, SUITE_SHIFT, SUITE_SEARCH, SUITE_SORT, SUITE_MAP,
+       NUM_SUITES };
+
+/* The names by which suites are chosen on the command line. */
+static const char *suiteNames[NUM_SUITES] = {
+   "add", "shift", "bsearch", "sort", "map"
+};
+
+/* The largest input length benchmarked unless given on the command
+   line. */
+static const size_t DEFAULT_MAX_LENGTH = 10000000;
+
+/* Each measurement is repeated until about this many elements have
+   been handled, so that short arrays are timed over many runs. */
+static const size_t ELEMENTS_PER_ROW = 1 << 20;
+
+/* The number of element moves allowed to each row of addAt and
+   removeAt timings, and the bounds on the calls per position. */
+static const size_t MOVES_PER_ROW = 1 << 24;
+static const size_t MIN_SHIFTS = 16;
+static const size_t MAX_SHIFTS = 1 << 16;
+
+/* The number of searches timed in each row of bsearch timings. */
+static const size_t SEARCHES_PER_ROW = 1 << 20;
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the current time in seconds from a monotonic clock.
+*/
+static double Bench_seconds(void) {
+   struct timespec now;
+
+   (void)clock_gettime(CLOCK_MONOTONIC, &now);
+   return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Compares the strings pvString1 and pvString2 as strcmp does.
+*/
+static int Bench_compareStrings(const void *pvString1,
+                                const void *pvString2) {
+   return strcmp((const char *)pvString1, (const char *)pvString2);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the string pvString itself, for DynArray_sortStrings.
+*/
+static const char *Bench_getString(const void *pvString) {
+   return (const char *)pvString;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  The quicksort that DynArray_sort used before introsort, kept as the
+  baseline: Wirth's partitioning with the middle element as pivot,
+  recursing into both sides and calling *pfCompare through a pointer.
+*/
+static void Bench_wirthQsort(
+   const void **ppvLo,
+   const void **ppvHi,
+   int (*pfCompare)(const void *pvElement1, const void *pvElement2)) {
+   const void **ppvRight = ppvLo;
+   const void **ppvLeft = ppvHi;
+   const void *pvPivot = *(ppvLo + ((ppvHi - ppvLo) / 2));
+   const void *pvTemp;
+
+   while (ppvRight <= ppvLeft) {
+      while ((*pfCompare)(*ppvRight, pvPivot) < 0)
+         ppvRight++;
+      while ((*pfCompare)(pvPivot, *ppvLeft) < 0)
+         ppvLeft--;
+      if (ppvRight <= ppvLeft) {
+         pvTemp = *ppvRight;
+         *ppvRight = *ppvLeft;
+         *ppvLeft = pvTemp;
+         ppvRight++;
+         ppvLeft--;
+      }
+   }
+
+   if (ppvLo < ppvLeft)
+      Bench_wirthQsort(ppvLo, ppvLeft, pfCompare);
+   if (ppvRight < ppvHi)
+      Bench_wirthQsort(ppvRight, ppvHi, pfCompare);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Fills strings with length distinct path-like names in the given
+  order. Names share a long common prefix, as siblings' paths do.
+  Returns the block holding the characters, owned by the caller, or
+  NULL if there is an allocation error.
+*/
+static char *Bench_makeStrings(const char **strings, size_t length,
+                               int order) {
+   enum { NAME_SIZE = 32 };
+   char *block;
+   const char *tmp;
+   size_t i;
+   size_t j;
+
+   assert(strings != NULL);
+
+   block = malloc(length * NAME_SIZE);
+   if (block == NULL)
+      return NULL;
+
+   for (i = 0; i < length; i++) {
+      sprintf(block + i * NAME_SIZE, "usr/share/doc/pkg%010lu",
+              (unsigned long)i);
+      strings[i] = block + i * NAME_SIZE;
+   }
+
+   if (order == REVERSED)
+      for (i = 0; i < length / 2; i++) {
+         tmp = strings[i];
+         strings[i] = strings[length - 1 - i];
+         strings[length - 1 - i] = tmp;
+      }
+   else if (order == RANDOM)
+      for (i = length - 1; i > 0; i--) {
+         j = (size_t)rand() % (i + 1);
+         tmp = strings[i];
+         strings[i] = strings[j];
+         strings[j] = tmp;
+      }
+
+   return block;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Sets the first length elements of array to those of strings.
+*/
+static void Bench_fillArray(DynArray_T array, const char **strings,
+                            size_t length) {
+   size_t i;
+
+   assert(array != NULL);
+   assert(strings != NULL);
+
+   for (i = 0; i < length; i++)
+      (void)DynArray_set(array, i, strings[i]);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns 1 (TRUE) if the length strings of sorted are in strictly
+  ascending order and array holds them in the same order, and 0
+  (FALSE) otherwise. Pass NULL as array to check only sorted.
+*/
+static int Bench_isSorted(DynArray_T array, const void **sorted,
+                          size_t length) {
+   size_t i;
+
+   assert(sorted != NULL);
+
+   for (i = 1; i < length; i++)
+      if (Bench_compareStrings(sorted[i - 1], sorted[i]) >= 0)
+         return 0;
+   if (array == NULL)
+      return 1;
+   if (DynArray_getLength(array) != length)
+      return 0;
+   for (i = 0; i < length; i++)
+      if (DynArray_get(array, i) != sorted[i])
+         return 0;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the number of times a measurement over length elements is
+  repeated.
+*/
+static size_t Bench_repeats(size_t length) {
+   if (length >= ELEMENTS_PER_ROW)
+      return 1;
+   return ELEMENTS_PER_ROW / length;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the nanoseconds per operation of seconds spent on
+  uOperations operations.
+*/
+static double Bench_perOp(double seconds, size_t uOperations) {
+   return seconds * 1e9 / (double)uOperations;
+}
+
+/*--------------------------------------------------------------------*/
+/* The element added by the add and shift timings. */
+static size_t dummyElement;
+
+/* The seconds taken by a pair of calls of Bench_seconds, which is
+   taken off each batch timed by the shift benchmark. */
+static double clockCost;
+
+/*--------------------------------------------------------------------*/
+/*
+  Sets clockCost to the least time measured between two consecutive
+  calls of Bench_seconds.
+*/
+static void Bench_measureClock(void) {
+   enum { TRIALS = 1000 };
+   double start;
+   double elapsed;
+   int i;
+
+   clockCost = 1.0;
+   for (i = 0; i < TRIALS; i++) {
+      start = Bench_seconds();
+      elapsed = Bench_seconds() - start;
+      if (elapsed < clockCost)
+         clockCost = elapsed;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Times DynArray_add appending length elements to an empty DynArray,
+  with the default growth policy and with the length reserved
+  beforehand, printing one row in nanoseconds per call.
+  Returns 0 if successful, 1 if there is an allocation error.
+*/
+static int Bench_addRow(size_t length) {
+   DynArray_T array;
+   size_t uRepeats = Bench_repeats(length);
+   size_t r;
+   size_t i;
+   double start;
+   double grown = 0.0;
+   double reserved = 0.0;
+   int isReserved;
+
+   for (r = 0; r < uRepeats; r++)
+      for (isReserved = 0; isReserved <= 1; isReserved++) {
+         array = DynArray_new(0);
+         if (array == NULL)
+            return 1;
+         if (isReserved && !DynArray_reserve(array, length)) {
+            DynArray_free(array);
+            return 1;
+         }
+
+         start = Bench_seconds();
+         for (i = 0; i < length; i++)
+            if (!DynArray_add(array, &dummyElement)) {
+               DynArray_free(array);
+               return 1;
+            }
+         if (isReserved)
+            reserved += Bench_seconds() - start;
+         else
+            grown += Bench_seconds() - start;
+
+         DynArray_free(array);
+      }
+
+   printf("%-10lu %12.2f %12.2f\n", (unsigned long)length,
+          Bench_perOp(grown, uRepeats * length),
+          Bench_perOp(reserved, uRepeats * length));
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the index at the given position of a DynArray of length
+  uLength, for DynArray_addAt if isAdding and DynArray_removeAt
+  otherwise.
+*/
+static size_t Bench_positionIndex(int position, size_t uLength,
+                                  int isAdding) {
+   if (position == FRONT)
+      return 0;
+   if (position == MIDDLE)
+      return uLength / 2;
+   return isAdding ? uLength : uLength - 1;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Times DynArray_addAt and DynArray_removeAt at the front, middle and
+  end of a DynArray of length elements, printing one row in
+  nanoseconds per call. Calls alternate in batches of at most an
+  eighth of length adds and then as many removes, so the length stays
+  close to length. Each call at the front or middle moves up to length
+  elements, so fewer calls are timed on longer arrays.
+  Returns 0 if successful, 1 if there is an allocation error.
+*/
+static int Bench_shiftRow(size_t length) {
+   DynArray_T array;
+   size_t uShifts;
+   size_t uBatch;
+   size_t uDone;
+   size_t i;
+   double start;
+   double added[NUM_POSITIONS];
+   double removed[NUM_POSITIONS];
+   int position;
+
+   uShifts = MOVES_PER_ROW / length;
+   if (uShifts < MIN_SHIFTS)
+      uShifts = MIN_SHIFTS;
+   if (uShifts > MAX_SHIFTS)
+      uShifts = MAX_SHIFTS;
+   uBatch = (length < 8) ? 1 : length / 8;
+   if (uBatch > uShifts)
+      uBatch = uShifts;
+
+   array = DynArray_new(length);
+   if (array == NULL)
+      return 1;
+
+   for (position = FRONT; position < NUM_POSITIONS; position++) {
+      added[position] = 0.0;
+      removed[position] = 0.0;
+      for (uDone = 0; uDone < uShifts; uDone += uBatch) {
+         start = Bench_seconds();
+         for (i = 0; i < uBatch; i++)
+            if (!DynArray_addAt(array,
+                   Bench_positionIndex(position,
+                                       DynArray_getLength(array), 1),
+                   &dummyElement)) {
+               DynArray_free(array);
+               return 1;
+            }
+         added[position] += Bench_seconds() - start - clockCost;
+
+         start = Bench_seconds();
+         for (i = 0; i < uBatch; i++)
+            (void)DynArray_removeAt(array,
+               Bench_positionIndex(position,
+                                   DynArray_getLength(array), 0));
+         removed[position] += Bench_seconds() - start - clockCost;
+      }
+   }
+   DynArray_free(array);
+
+   /* uDone is the number of calls made at each position. */
+   printf("%-10lu", (unsigned long)length);
+   for (position = FRONT; position < NUM_POSITIONS; position++)
+      printf(" %12.2f", Bench_perOp(added[position], uDone));
+   for (position = FRONT; position < NUM_POSITIONS; position++)
+      printf(" %12.2f", Bench_perOp(removed[position], uDone));
+   printf("\n");
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Compares the size_t values that pvValue1 and pvValue2 point to.
+*/
+static int Bench_compareValues(const void *pvValue1,
+                               const void *pvValue2) {
+   size_t uValue1 = *(const size_t *)pvValue1;
+   size_t uValue2 = *(const size_t *)pvValue2;
+
+   if (uValue1 < uValue2)
+      return -1;
+   return uValue1 > uValue2;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the 8 bytes from byte uOffset on of the key string of the
+  size_t value that pvValue points to: its bytes, most significant
+  first.
+*/
+static uint64_t Bench_valueKey(const void *pvValue, size_t uOffset) {
+   if (uOffset >= sizeof(uint64_t))
+      return 0;
+   return (uint64_t)*(const size_t *)pvValue << (8 * uOffset);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the 8 bytes from byte uOffset on of the string pvString, its
+  own key string.
+*/
+static uint64_t Bench_stringKey(const void *pvString, size_t uOffset) {
+   const char *pcString = pvString;
+   uint64_t uKey = 0;
+   size_t i;
+
+   for (; uOffset > 0 && *pcString != '\0'; uOffset--)
+      pcString++;
+   for (i = 0; i < sizeof(uKey); i++) {
+      uKey <<= 8;
+      if (*pcString != '\0')
+         uKey |= (unsigned char)*pcString++;
+   }
+   return uKey;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Compares the strings that the elements at ppvString1 and ppvString2
+  point to, as qsort calls it.
+*/
+static int Bench_compareStringElements(const void *ppvString1,
+                                       const void *ppvString2) {
+   return strcmp(*(const char *const *)ppvString1,
+                 *(const char *const *)ppvString2);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Writes to pcName the i'th name of the given kind: for PREFIXED,
+  "IMG_%08lu.jpg" of i, so that all share a long prefix; for random
+  names, 12 letters drawn from i. Even i give the names in the array,
+  and odd i names that, almost always, are not.
+*/
+static void Bench_makeName(char *pcName, int kind, size_t i) {
+   unsigned long uState;
+   size_t c;
+
+   assert(pcName != NULL);
+
+   if (kind == PREFIXED) {
+      sprintf(pcName, "IMG_%08lu.jpg", (unsigned long)i);
+      return;
+   }
+
+   uState = (unsigned long)i * 2654435761UL + 12345;
+   for (c = 0; c < 12; c++) {
+      uState = uState * 1103515245UL + 12345;
+      pcName[c] = (char)('a' + (uState >> 16) % 26);
+   }
+   pcName[c] = '\0';
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Times DynArray_bsearch on a sorted DynArray of length elements of
+  the given kind, for hits and for misses, first as a plain binary
+  search and then with a key function installed, printing one row in
+  nanoseconds per search.
+  Returns 0 if successful, 1 if there is an allocation error.
+*/
+static int Bench_searchRow(size_t length, int kind) {
+   enum { NAME_SIZE = 24 };
+   DynArray_T array;
+   size_t *values;
+   size_t *soughtValues;
+   const char **names;
+   char *block;
+   char *soughtBlock;
+   const void **sought;
+   int (*pfCompare)(const void *pvElement1, const void *pvElement2);
+   uint64_t (*pfKey)(const void *pvElement, size_t uOffset);
+   size_t uIndex;
+   size_t i;
+   double start;
+   double times[4];
+   int isKeyed;
+   int isMiss;
+
+   values = malloc(length * sizeof(*values));
+   soughtValues = malloc(SEARCHES_PER_ROW * sizeof(*soughtValues));
+   names = malloc(length * sizeof(*names));
+   block = malloc(length * NAME_SIZE);
+   soughtBlock = malloc(SEARCHES_PER_ROW * NAME_SIZE);
+   sought = malloc(SEARCHES_PER_ROW * sizeof(*sought));
+   array = DynArray_new(length);
+   if (values == NULL || soughtValues == NULL || names == NULL ||
+       block == NULL || soughtBlock == NULL || sought == NULL ||
+       array == NULL) {
+      free(values);
+      free(soughtValues);
+      free(names);
+      free(block);
+      free(soughtBlock);
+      free(sought);
+      if (array != NULL)
+         DynArray_free(array);
+      return 1;
+   }
+
+   /* Even values or names are in the array; odd ones fall between. */
+   pfCompare = Bench_compareValues;
+   pfKey = Bench_valueKey;
+   if (kind != VALUES) {
+      pfCompare = Bench_compareStrings;
+      pfKey = Bench_stringKey;
+      for (i = 0; i < length; i++) {
+         Bench_makeName(block + i * NAME_SIZE, kind, 2 * i);
+         names[i] = block + i * NAME_SIZE;
+      }
+      qsort(names, length, sizeof(*names),
+            Bench_compareStringElements);
+   }
+   for (i = 0; i < length; i++) {
+      values[i] = 2 * i;
+      if (kind == VALUES)
+         (void)DynArray_set(array, i, &values[i]);
+      else
+         (void)DynArray_set(array, i, names[i]);
+   }
+
+   for (isKeyed = 0; isKeyed <= 1; isKeyed++) {
+      if (isKeyed) {
+         DynArray_setKeyFunction(array, pfKey);
+         /* Let the first search build the keys, untimed. */
+         (void)DynArray_bsearch(array, DynArray_get(array, 0),
+                                &uIndex, pfCompare);
+      }
+      for (isMiss = 0; isMiss <= 1; isMiss++) {
+         for (i = 0; i < SEARCHES_PER_ROW; i++) {
+            soughtValues[i] =
+               2 * ((size_t)rand() % length) + (size_t)isMiss;
+            sought[i] = &soughtValues[i];
+            if (kind != VALUES) {
+               Bench_makeName(soughtBlock + i * NAME_SIZE, kind,
+                              soughtValues[i]);
+               sought[i] = soughtBlock + i * NAME_SIZE;
+            }
+         }
+
+         start = Bench_seconds();
+         for (i = 0; i < SEARCHES_PER_ROW; i++)
+            (void)DynArray_bsearch(array, (void *)sought[i], &uIndex,
+                                   pfCompare);
+         times[2 * isKeyed + isMiss] = Bench_seconds() - start;
+      }
+   }
+
+   printf("%-10lu %-8s %10.2f %10.2f %10.2f %10.2f\n",
+          (unsigned long)length, kindNames[kind],
+          Bench_perOp(times[0], SEARCHES_PER_ROW),
+          Bench_perOp(times[1], SEARCHES_PER_ROW),
+          Bench_perOp(times[2], SEARCHES_PER_ROW),
+          Bench_perOp(times[3], SEARCHES_PER_ROW));
+
+   DynArray_free(array);
+   free(values);
+   free(soughtValues);
+   free(names);
+   free(block);
+   free(soughtBlock);
+   free(sought);
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Times the baseline quicksort, DynArray_sort, and DynArray_sortStrings
+  on the same length strings in the given order, printing one row in
+  nanoseconds per element. Each sort's output is checked, untimed.
+  Returns 0 if successful, 1 if there is an allocation error, and 2
+  if a sort leaves the strings out of order.
+*/
+static int Bench_sortRow(size_t length, int order) {
+   const char **strings;
+   const void **copy;
+   char *block;
+   DynArray_T array;
+   size_t uRepeats = Bench_repeats(length);
+   size_t r;
+   double start;
+   double wirth = 0.0;
+   double intro = 0.0;
+   double multikey = 0.0;
+   int status = 0;
+
+   strings = malloc(length * sizeof(*strings));
+   copy = malloc(length * sizeof(*copy));
+   array = DynArray_new(length);
+   block = (strings == NULL) ? NULL
+      : Bench_makeStrings(strings, length, order);
+   if (strings == NULL || copy == NULL || array == NULL ||
+       block == NULL) {
+      free(strings);
+      free(copy);
+      if (array != NULL)
+         DynArray_free(array);
+      return 1;
+   }
+
+   for (r = 0; r < uRepeats; r++) {
+      memcpy(copy, strings, length * sizeof(*copy));
+      start = Bench_seconds();
+      Bench_wirthQsort(copy, copy + length - 1, Bench_compareStrings);
+      wirth += Bench_seconds() - start;
+      if (!Bench_isSorted(NULL, copy, length)) {
+         status = 2;
+         break;
+      }
+
+      Bench_fillArray(array, strings, length);
+      start = Bench_seconds();
+      DynArray_sort(array, Bench_compareStrings);
+      intro += Bench_seconds() - start;
+      if (!Bench_isSorted(array, copy, length)) {
+         status = 2;
+         break;
+      }
+
+      Bench_fillArray(array, strings, length);
+      start = Bench_seconds();
+      if (!DynArray_sortStrings(array, Bench_getString)) {
+         status = 1;
+         break;
+      }
+      multikey += Bench_seconds() - start;
+      if (!Bench_isSorted(array, copy, length)) {
+         status = 2;
+         break;
+      }
+   }
+
+   if (status == 0)
+         printf("%-10lu %-8s %12.2f %12.2f %12.2f\n",
+             (unsigned long)length, orderNames[order],
+             Bench_perOp(wirth, uRepeats * length),
+             Bench_perOp(intro, uRepeats * length),
+             Bench_perOp(multikey, uRepeats * length));
+
+   DynArray_free(array);
+   free(block);
+   free(strings);
+   free(copy);
+   return status;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Increments the size_t value that pvValue points to. pvExtra is
+  unused.
+*/
+static void Bench_increment(void *pvValue, void *pvExtra) {
+   (void)pvExtra;
+   (*(size_t *)pvValue)++;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Times DynArray_map and DynArray_parallelMap over a DynArray of
+  length values, printing one row in nanoseconds per element.
+  Returns 0 if successful, 1 if there is an allocation error.
+*/
+static int Bench_mapRow(size_t length) {
+   DynArray_T array;
+   size_t *values;
+   size_t uRepeats = Bench_repeats(length);
+   size_t r;
+   size_t i;
+   double start;
+   double serial;
+   double parallel;
+
+   values = calloc(length, sizeof(*values));
+   array = DynArray_new(length);
+   if (values == NULL || array == NULL) {
+      free(values);
+      if (array != NULL)
+         DynArray_free(array);
+      return 1;
+   }
+   for (i = 0; i < length; i++)
+      (void)DynArray_set(array, i, &values[i]);
+
+   start = Bench_seconds();
+   for (r = 0; r < uRepeats; r++)
+      DynArray_map(array, Bench_increment, NULL);
+   serial = Bench_seconds() - start;
+
+   start = Bench_seconds();
+   for (r = 0; r < uRepeats; r++)
+      DynArray_parallelMap(array, Bench_increment, NULL);
+   parallel = Bench_seconds() - start;
+
+   printf("%-10lu %12.2f %12.2f\n", (unsigned long)length,
+          Bench_perOp(serial, uRepeats * length),
+          Bench_perOp(parallel, uRepeats * length));
+
+   DynArray_free(array);
+   free(values);
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Prints the header of the table of suite, then runs its rows for
+  lengths 2, 10, 100, ... up to maxLength.
+  Returns 0 if successful, 1 if there is an allocation error, and 2
+  if a sort leaves its output out of order.
+*/
+static int Bench_runSuite(int suite, size_t maxLength) {
+   size_t length;
+   int order;
+   int kind;
+   int status = 0;
+
+   printf("\n");
+   if (suite == SUITE_ADD)
+      printf("%-10s %12s %12s\n", "length", "add", "reserved");
+   else if (suite == SUITE_SHIFT)
+      printf("%-10s %12s %12s %12s %12s %12s %12s\n", "length",
+             "addFront", "addMiddle", "addEnd", "rmFront", "rmMiddle",
+             "rmEnd");
+   else if (suite == SUITE_SEARCH)
+      printf("%-10s %-8s %10s %10s %10s %10s\n", "length", "kind",
+             "hit", "miss", "keyHit", "keyMiss");
+   else if (suite == SUITE_SORT)
+      printf("%-10s %-8s %12s %12s %12s\n", "length", "order",
+             "wirth", "sort", "strings");
+   else
+      printf("%-10s %12s %12s\n", "length", "map", "parallel");
+
+   for (length = 2; length <= maxLength && status == 0;
+        length = (length == 2) ? 10 : length * 10) {
+      if (suite == SUITE_ADD)
+         status = Bench_addRow(length);
+      else if (suite == SUITE_SHIFT)
+         status = Bench_shiftRow(length);
+      else if (suite == SUITE_SEARCH)
+         for (kind = VALUES; kind < NUM_KINDS && status == 0; kind++)
+            status = Bench_searchRow(length, kind);
+      else if (suite == SUITE_SORT)
+         for (order = RANDOM; order < NUM_ORDERS && status == 0;
+              order++)
+            status = Bench_sortRow(length, order);
+      else
+         status = Bench_mapRow(length);
+      (void)fflush(stdout);
+   }
+   return status;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Benchmarks DynArray operations on arrays of growing length, up to
+  the length given as the optional first argument, printing a table
+  for each suite, or only for the suite named by the optional second
+  argument: add, shift (addAt and removeAt), bsearch, sort, or map.
+  Times are in nanoseconds per call or per element.
+  Returns 0 if successful, 1 otherwise.
+*/
+int main(int argc, char *argv[]) {
+   size_t maxLength = DEFAULT_MAX_LENGTH;
+   int suite;
+   int onlySuite = -1;
+   int status;
+
+   if (argc > 1)
+      maxLength = (size_t)strtod(argv[1], NULL);
+   if (argc > 2) {
+      for (onlySuite = 0; onlySuite < NUM_SUITES; onlySuite++)
+         if (strcmp(argv[2], suiteNames[onlySuite]) == 0)
+            break;
+      if (onlySuite == NUM_SUITES) {
+         fprintf(stderr, "usage: %s [maxLength [suite]]\n", argv[0]);
+         return 1;
+      }
+   }
+
+   srand(217);
+   Bench_measureClock();
+
+   printf("DynArray timings in ns per call or element, up to "
+          "length %lu\n",
+          (unsigned long)maxLength);
+   for (suite = 0; suite < NUM_SUITES; suite++) {
+      if (onlySuite >= 0 && suite != onlySuite)
+         continue;
+      status = Bench_runSuite(suite, maxLength);
+      if (status == 1) {
+         fprintf(stderr, "Insufficient memory\n");
+         return 1;
+      }
+      if (status == 2) {
+         fprintf(stderr, "Sorted output out of order\n");
+         return 1;
+      }
+   }
+
+   return 0;
+}
@@ -0,0 +1,437 @@
+/*--------------------------------------------------------------------*/
+/* dynarray_client.c                                                  */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dynarray.h"
+
+/* The number of elements in the longer arrays tested, enough that
+   the sorts recurse and do not sort on the stack. */
+enum { LONG_LENGTH = 1000 };
+
+/*--------------------------------------------------------------------*/
+/*
+  Compares the ints that pvInt1 and pvInt2 point to.
+*/
+static int Client_compareInts(const void *pvInt1, const void *pvInt2) {
+   int iInt1 = *(const int *)pvInt1;
+   int iInt2 = *(const int *)pvInt2;
+
+   if (iInt1 < iInt2)
+      return -1;
+   return iInt1 > iInt2;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the string pvString itself, for DynArray_sortStrings.
+*/
+static const char *Client_getString(const void *pvString) {
+   return (const char *)pvString;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Sets array to the uLength elements of ppvElements, replacing what it
+  held.
+*/
+static void Client_fill(DynArray_T array,
+                        const void *const *ppvElements,
+                        size_t uLength) {
+   size_t u;
+   int iSuccessful;
+
+   assert(array != NULL);
+
+   while (DynArray_getLength(array) > 0)
+      (void)DynArray_removeAt(array, DynArray_getLength(array) - 1);
+   for (u = 0; u < uLength; u++) {
+      iSuccessful = DynArray_add(array, ppvElements[u]);
+      assert(iSuccessful);
+   }
+   (void)iSuccessful;
+}
+
+#ifndef NDEBUG
+
+/*--------------------------------------------------------------------*/
+/*
+  Compares the strings pvString1 and pvString2 as strcmp does.
+*/
+static int Client_compareStrings(const void *pvString1,
+                                 const void *pvString2) {
+   return strcmp((const char *)pvString1, (const char *)pvString2);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns 1 (TRUE) if array holds exactly the uLength elements of
+  ppvElements, in order, and 0 (FALSE) otherwise.
+*/
+static int Client_holds(DynArray_T array,
+                        const void *const *ppvElements,
+                        size_t uLength) {
+   size_t u;
+
+   assert(array != NULL);
+
+   if (DynArray_getLength(array) != uLength)
+      return 0;
+   for (u = 0; u < uLength; u++)
+      if (DynArray_get(array, u) != ppvElements[u])
+         return 0;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns 1 (TRUE) if array holds the same elements as the uLength
+  elements of ppvElements, each as many times, in an order that
+  *pfCompare calls ascending, and 0 (FALSE) otherwise.
+*/
+static int Client_isSortedPermutation(
+   DynArray_T array, const void *const *ppvElements, size_t uLength,
+   int (*pfCompare)(const void *pvElement1, const void *pvElement2)) {
+   size_t u;
+   size_t v;
+   size_t uSeen;
+   size_t uWanted;
+
+   assert(array != NULL);
+   assert(pfCompare != NULL);
+
+   if (DynArray_getLength(array) != uLength)
+      return 0;
+   for (u = 1; u < uLength; u++)
+      if ((*pfCompare)(DynArray_get(array, u - 1),
+                       DynArray_get(array, u)) > 0)
+         return 0;
+   for (u = 0; u < uLength; u++) {
+      uSeen = 0;
+      uWanted = 0;
+      for (v = 0; v < uLength; v++) {
+         uSeen += DynArray_get(array, v) == ppvElements[u];
+         uWanted += ppvElements[v] == ppvElements[u];
+      }
+      if (uSeen != uWanted)
+         return 0;
+   }
+   return 1;
+}
+
+#endif
+
+/*--------------------------------------------------------------------*/
+/*
+  Tests DynArray_sort and DynArray_sortStrings on empty and
+  single-element arrays, on strings that tie or differ only past
+  their first 8 bytes, and on longer arrays in random, ascending,
+  descending and constant order, with many equal keys.
+*/
+static void Client_testSort(void) {
+   static const char *apcStrings[] = {
+      "b", "a", "", "abcdefghij", "abcdefgh", "abcdefghi",
+      "abcdefgh", "b", "abcdefgha", "abcdefg", ""
+   };
+   enum { NUM_STRINGS = sizeof(apcStrings) / sizeof(apcStrings[0]) };
+   static int aiInts[LONG_LENGTH];
+   static char acNames[LONG_LENGTH][16];
+   const void *apvElements[LONG_LENGTH];
+   DynArray_T array;
+   size_t u;
+   int iOrder;
+   int iSuccessful;
+
+   array = DynArray_new(0);
+   assert(array != NULL);
+
+   /* Empty and single-element arrays are already sorted. */
+   DynArray_sort(array, Client_compareInts);
+   assert(DynArray_getLength(array) == 0);
+   iSuccessful = DynArray_sortStrings(array, Client_getString);
+   assert(iSuccessful);
+   assert(DynArray_getLength(array) == 0);
+   apvElements[0] = apcStrings[0];
+   Client_fill(array, apvElements, 1);
+   iSuccessful = DynArray_sortStrings(array, Client_getString);
+   assert(iSuccessful);
+   assert(Client_holds(array, apvElements, 1));
+   aiInts[0] = 7;
+   apvElements[0] = &aiInts[0];
+   Client_fill(array, apvElements, 1);
+   DynArray_sort(array, Client_compareInts);
+   assert(Client_holds(array, apvElements, 1));
+
+   /* Equal strings, prefixes, and strings that differ only past the
+      8 bytes compared at once. */
+   for (u = 0; u < NUM_STRINGS; u++)
+      apvElements[u] = apcStrings[u];
+   Client_fill(array, apvElements, NUM_STRINGS);
+   iSuccessful = DynArray_sortStrings(array, Client_getString);
+   assert(iSuccessful);
+   assert(Client_isSortedPermutation(
+             array, apvElements, NUM_STRINGS,
+             Client_compareStrings));
+   assert(!strcmp(DynArray_get(array, 2), "a"));
+   assert(!strcmp(DynArray_get(array, 3), "abcdefg"));
+   assert(!strcmp(DynArray_get(array, 8), "abcdefghij"));
+
+   /* Longer arrays, drawing values and names from few enough choices
+      that most are repeated. */
+   for (iOrder = 0; iOrder < 4; iOrder++) {
+      for (u = 0; u < LONG_LENGTH; u++) {
+         if (iOrder == 0)
+            aiInts[u] = rand() % 50;
+         else if (iOrder == 1)
+            aiInts[u] = (int)u;
+         else if (iOrder == 2)
+            aiInts[u] = LONG_LENGTH - (int)u;
+         else
+            aiInts[u] = 3;
+         sprintf(acNames[u], "pkg/%08d", aiInts[u]);
+         apvElements[u] = &aiInts[u];
+      }
+      Client_fill(array, apvElements, LONG_LENGTH);
+      DynArray_sort(array, Client_compareInts);
+      assert(Client_isSortedPermutation(array, apvElements,
+                                        LONG_LENGTH,
+                                        Client_compareInts));
+
+      for (u = 0; u < LONG_LENGTH; u++)
+         apvElements[u] = acNames[u];
+      Client_fill(array, apvElements, LONG_LENGTH);
+      iSuccessful = DynArray_sortStrings(array, Client_getString);
+      assert(iSuccessful);
+      assert(Client_isSortedPermutation(
+                array, apvElements, LONG_LENGTH,
+                Client_compareStrings));
+   }
+
+   DynArray_free(array);
+   (void)iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Tests DynArray_addRange and DynArray_removeRange at the front,
+  middle and end of an array, with no elements and with all of them.
+*/
+static void Client_testRanges(void) {
+   static int aiInts[8];
+   const void *apvElements[8];
+   const void *apvExpected[8];
+   void *apvRemoved[8];
+   DynArray_T array;
+   size_t u;
+   int iSuccessful;
+
+   for (u = 0; u < 8; u++)
+      apvElements[u] = &aiInts[u];
+
+   array = DynArray_new(0);
+   assert(array != NULL);
+
+   /* Empty ranges change nothing. */
+   iSuccessful = DynArray_addRange(array, 0, NULL, 0);
+   assert(iSuccessful);
+   assert(DynArray_getLength(array) == 0);
+   DynArray_removeRange(array, 0, 0, NULL);
+   assert(DynArray_getLength(array) == 0);
+
+   /* Add 2 3, then 0 1 at the front, 6 7 at the end and 4 5 in the
+      middle. */
+   iSuccessful = DynArray_addRange(array, 0, &apvElements[2], 2);
+   assert(iSuccessful);
+   iSuccessful = DynArray_addRange(array, 0, &apvElements[0], 2);
+   assert(iSuccessful);
+   iSuccessful = DynArray_addRange(array, 4, &apvElements[6], 2);
+   assert(iSuccessful);
+   iSuccessful = DynArray_addRange(array, 4, &apvElements[4], 2);
+   assert(iSuccessful);
+   assert(Client_holds(array, apvElements, 8));
+   iSuccessful = DynArray_addRange(array, 8, apvElements, 0);
+   assert(iSuccessful);
+   DynArray_removeRange(array, 8, 0, apvRemoved);
+   assert(Client_holds(array, apvElements, 8));
+
+   /* Remove 0 1 from the front, 6 7 from the end and 3 4 from the
+      middle, keeping what was removed. */
+   DynArray_removeRange(array, 0, 2, apvRemoved);
+   assert(apvRemoved[0] == apvElements[0]);
+   assert(apvRemoved[1] == apvElements[1]);
+   DynArray_removeRange(array, 4, 2, apvRemoved);
+   assert(apvRemoved[0] == apvElements[6]);
+   assert(apvRemoved[1] == apvElements[7]);
+   DynArray_removeRange(array, 1, 2, NULL);
+   apvExpected[0] = apvElements[2];
+   apvExpected[1] = apvElements[5];
+   assert(Client_holds(array, apvExpected, 2));
+
+   /* Remove all the rest, then add all back. */
+   DynArray_removeRange(array, 0, 2, apvRemoved);
+   assert(DynArray_getLength(array) == 0);
+   assert(apvRemoved[0] == apvElements[2]);
+   assert(apvRemoved[1] == apvElements[5]);
+   iSuccessful = DynArray_addRange(array, 0, apvElements, 8);
+   assert(iSuccessful);
+   assert(Client_holds(array, apvElements, 8));
+
+   DynArray_free(array);
+   (void)apvExpected;
+   (void)iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Tests DynArray_mergeSorted into and from empty arrays, and with
+  equal elements in both, which must follow the equal ones already in
+  the array.
+*/
+static void Client_testMerge(void) {
+   /* Equal values are kept apart by their addresses. */
+   static int aiOld[4] = { 1, 3, 3, 5 };
+   static int aiNew[4] = { 0, 3, 5, 6 };
+   const void *apvOld[4];
+   const void *apvNew[4];
+   const void *apvExpected[8];
+   DynArray_T array;
+   size_t u;
+   int iSuccessful;
+
+   for (u = 0; u < 4; u++) {
+      apvOld[u] = &aiOld[u];
+      apvNew[u] = &aiNew[u];
+   }
+
+   array = DynArray_new(0);
+   assert(array != NULL);
+
+   iSuccessful = DynArray_mergeSorted(array, NULL, 0,
+                                      Client_compareInts);
+   assert(iSuccessful);
+   assert(DynArray_getLength(array) == 0);
+   iSuccessful = DynArray_mergeSorted(array, apvOld, 4,
+                                      Client_compareInts);
+   assert(iSuccessful);
+   assert(Client_holds(array, apvOld, 4));
+   iSuccessful = DynArray_mergeSorted(array, apvNew, 0,
+                                      Client_compareInts);
+   assert(iSuccessful);
+   assert(Client_holds(array, apvOld, 4));
+
+   iSuccessful = DynArray_mergeSorted(array, apvNew, 4,
+                                      Client_compareInts);
+   assert(iSuccessful);
+   apvExpected[0] = &aiNew[0];
+   apvExpected[1] = &aiOld[0];
+   apvExpected[2] = &aiOld[1];
+   apvExpected[3] = &aiOld[2];
+   apvExpected[4] = &aiNew[1];
+   apvExpected[5] = &aiOld[3];
+   apvExpected[6] = &aiNew[2];
+   apvExpected[7] = &aiNew[3];
+   assert(Client_holds(array, apvExpected, 8));
+
+   /* One element merged before, and after, all the others. */
+   Client_fill(array, &apvNew[1], 1);
+   iSuccessful = DynArray_mergeSorted(array, &apvNew[0], 1,
+                                      Client_compareInts);
+   assert(iSuccessful);
+   iSuccessful = DynArray_mergeSorted(array, &apvNew[3], 1,
+                                      Client_compareInts);
+   assert(iSuccessful);
+   apvExpected[0] = &aiNew[0];
+   apvExpected[1] = &aiNew[1];
+   apvExpected[2] = &aiNew[3];
+   assert(Client_holds(array, apvExpected, 3));
+
+   DynArray_free(array);
+   (void)apvExpected;
+   (void)iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Tests that DynArray_shrinkToFit and DynArray_setGrowthPolicy keep
+  the elements of an array, empty or not, as it grows and shrinks.
+*/
+static void Client_testCapacity(void) {
+   static int aiInts[LONG_LENGTH];
+   const void *apvElements[LONG_LENGTH];
+   DynArray_T array;
+   size_t u;
+   int iShrinkPercent;
+   int iSuccessful;
+
+   for (u = 0; u < LONG_LENGTH; u++)
+      apvElements[u] = &aiInts[u];
+
+   array = DynArray_new(0);
+   assert(array != NULL);
+
+   iSuccessful = DynArray_shrinkToFit(array);
+   assert(iSuccessful);
+   assert(DynArray_getLength(array) == 0);
+   iSuccessful = DynArray_reserve(array, LONG_LENGTH);
+   assert(iSuccessful);
+   iSuccessful = DynArray_add(array, apvElements[0]);
+   assert(iSuccessful);
+   iSuccessful = DynArray_shrinkToFit(array);
+   assert(iSuccessful);
+   assert(Client_holds(array, apvElements, 1));
+   iSuccessful = DynArray_add(array, apvElements[1]);
+   assert(iSuccessful);
+   assert(Client_holds(array, apvElements, 2));
+
+   /* Grow one element at a time, by half each time the array is
+      full, then remove one element at a time from the end, first
+      without shrinking and then shrinking as soon as possible. */
+   for (iShrinkPercent = 0; iShrinkPercent <= 49;
+        iShrinkPercent += 49) {
+      DynArray_setGrowthPolicy(array, 150, (size_t)iShrinkPercent);
+      for (u = DynArray_getLength(array); u < LONG_LENGTH; u++) {
+         iSuccessful = DynArray_add(array, apvElements[u]);
+         assert(iSuccessful);
+      }
+      assert(Client_holds(array, apvElements, LONG_LENGTH));
+      for (u = LONG_LENGTH; u > 1; u--) {
+         (void)DynArray_removeAt(array, u - 1);
+         assert(Client_holds(array, apvElements, u - 1));
+      }
+   }
+   DynArray_setGrowthPolicy(array, 200, 25);
+   iSuccessful = DynArray_addRange(array, 1, &apvElements[1],
+                                   LONG_LENGTH - 1);
+   assert(iSuccessful);
+   DynArray_removeRange(array, 1, LONG_LENGTH - 2, NULL);
+   assert(DynArray_get(array, 0) == apvElements[0]);
+   assert(DynArray_get(array, 1) == apvElements[LONG_LENGTH - 1]);
+   iSuccessful = DynArray_shrinkToFit(array);
+   assert(iSuccessful);
+   assert(DynArray_getLength(array) == 2);
+   assert(DynArray_get(array, 1) == apvElements[LONG_LENGTH - 1]);
+
+   DynArray_free(array);
+   (void)iSuccessful;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Tests the DynArray sorts, range operations and capacity management
+  with an assortment of checks. Returns 0.
+*/
+int main(void) {
+   srand(217);
+
+   Client_testSort();
+   Client_testRanges();
+   Client_testMerge();
+   Client_testCapacity();
+
+   return 0;
+}
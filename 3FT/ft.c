@@ -3,19 +3,48 @@
 /* Author: Christian Ronda & Benjamin Herber                        */
 /*--------------------------------------------------------------------*/
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <assert.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
+#include "checker.h"
+#include "counters.h"
 #include "dynarray.h"
 #include "ft.h"
+#include "grep.h"
+#include "nameindex.h"
 #include "node.h"
+#include "pathglob.h"
+#include "shape.h"
+#include "sizeindex.h"
+#include "slowlog.h"
+#include "stats.h"
+#include "trace.h"
 
 /* Equality enum to clarify if comparisons. */
 enum { EQUAL };
 
+/* The seed of the children sampled by FT_shapeStats, fixed so that
+   samples of the same tree agree. */
+enum { SHAPE_SEED = 217 };
+
+/*
+   Building with -DFT_CHECKER checks the hierarchy on entry to every
+   public function, within the budget of the sampled checker.
+*/
+#ifdef FT_CHECKER
+#define FT_CHECK() \
+   assert(Checker_FT_isValidSampled(isInitialized, root, count))
+#else
+#define FT_CHECK() ((void)0)
+#endif
+
 /*--------------------------------------------------------------------*/
 /* A Directory Tree is an Abstract Object that stores both directories
    and files with 3 state variables:
@@ -29,61 +58,310 @@ static Node root;
 /* A counter of the number of Nodes in the hierarchy */
 static size_t count;
 
+/* Calls are counted in stats.c, and recorded with 2 more state
+   variables: */
+/* The trace file being recorded to, or NULL if not recording. */
+static FILE *traceFile;
+
+/* A flag for if a write to the trace file has failed. */
+static boolean traceFailed;
+
+/* Work is counted with 2 more state variables: */
+/* The work of each FT function's calls, by FT_OP_ value. */
+static struct Counters opCounters[FT_NUM_OPS];
+
+/* The lookup being explained by FT_explain, or NULL if none. */
+static struct Explain *explaining;
+
+/* Slow calls are logged in slowlog.c with 2 more state variables: */
+/* The nanoseconds from which a call is logged, or 0 if none are. */
+static uint64_t slowThreshold;
+
+/* The nodes the current call's path lookups have descended through. */
+static uint64_t callNodes;
+
+/* Names are indexed with 1 more state variable: */
+/* The index of nodes by name, or NULL if none is kept. */
+static NameIndex_T nameIndex;
+
+/* File lengths are indexed with 1 more state variable: */
+/* The index of files by length, or NULL if none is kept. */
+static SizeIndex_T sizeIndex;
+
+/* Paths that reads build are kept in 1 more state variable: */
+/* The path FT_nth last found, which it returns. */
+static struct NodePath nthPath;
+
+/* A file found by FT_filesBySize or FT_largestFiles without the index
+   of files by length: its length and its path. */
+struct FT_SizedFile {
+   size_t length;
+   char *path;
+};
+
+/* Counts a node descended through by a path lookup. */
+#define FT_VISIT() (callNodes++, COUNTERS_ADD(COUNTER_NODES, 1))
+
+#ifdef FT_COUNTERS
+/* The bytes counted when the current search for a child began. */
+static uint64_t stepStart;
+
+/*--------------------------------------------------------------------*/
+/*
+   Notes the start of a search among the children of a directory for
+   the lookup being explained, if any.
+*/
+static void FT_explainStart(void) {
+   stepStart = Counters_current.counts[COUNTER_BYTES];
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Notes the end of a search among the children of the directory dir,
+   named by the first len bytes of the path being looked up, for the
+   lookup being explained, if any. Keeps dir as the lookup's worst
+   directory if the search read more bytes than any before it.
+*/
+static void FT_explainEnd(Node dir, size_t len) {
+   uint64_t bytes = Counters_current.counts[COUNTER_BYTES] - stepStart;
+
+   if (explaining == NULL || bytes <= explaining->worstBytes)
+      return;
+   explaining->worstBytes = bytes;
+   explaining->worstLength = len;
+   explaining->worstChildren = Node_getNumChildren(dir);
+}
+#else
+#define FT_explainStart() ((void)0)
+#define FT_explainEnd(dir, len) ((void)0)
+#endif
+
 /*--------------------------------------------------------------------*/
 /*
    Starting at the parameter curr, traverses as far down
    the hierarchy as possible while still matching the path
-   parameter.
+   parameter, one path component at a time.
 
-   Returns a pointer to the farthest matching Node down that path,
-   or NULL if there is no node in curr's hierarchy that matches
-   a prefix of the path
+   Stores in *result a pointer to the farthest matching Node down that
+   path, or NULL if there is no node in curr's hierarchy that matches
+   a prefix of the path. Returns SUCCESS, or MEMORY_ERROR if unable to
+   allocate sufficient memory, in which case *result is NULL.
 */
-static Node FT_traversePathFrom(char *path, Node curr) {
-   Node found;
-   size_t i;
+static int FT_traversePathFrom(char *path, Node curr, Node *result) {
+   const char *currPath;
+   char *prefix;
+   char *end;
+   size_t len;
+   size_t childID;
+   char saved;
+   int found;
+   int status = SUCCESS;
 
    assert(path != NULL);
+   assert(result != NULL);
 
+   *result = NULL;
    if (curr == NULL)
-      return NULL;
+      return SUCCESS;
 
-   else if (!strcmp(path, Node_getPath(curr)))
-      return curr;
+   /* curr must match a whole-component prefix of path. */
+   currPath = Node_getPath(curr);
+   if (currPath == NULL)
+      return MEMORY_ERROR;
+   len = strlen(currPath);
+   FT_VISIT();
+   COUNTERS_ADD(COUNTER_COMPARES, 1);
+   COUNTERS_ADD(COUNTER_BYTES, len);
+   if (strncmp(path, currPath, len) != EQUAL ||
+       (path[len] != '\0' && path[len] != '/'))
+      return SUCCESS;
 
-   else if (!strncmp(path, Node_getPath(curr),
-                     strlen(Node_getPath(curr)))) {
-      for (i = 0; i < Node_getNumChildren(curr); i++) {
-         found = FT_traversePathFrom(path, Node_getChild(curr, i));
-         if (found != NULL)
-            return found;
-      }
-      return curr;
+   /* Work on a copy so each prefix can be terminated in place. */
+   COUNTERS_ADD(COUNTER_ALLOCATIONS, 1);
+   prefix = malloc(strlen(path) + 1);
+   if (prefix == NULL)
+      return MEMORY_ERROR;
+   strcpy(prefix, path);
+
+   /* Descend one component at a time by binary search. */
+   while (prefix[len] == '/') {
+      end = strchr(prefix + len + 1, '/');
+      if (end == NULL)
+         end = prefix + strlen(prefix);
+
+      /* A copy's children are copied as they are reached. */
+      status = Node_expand(curr);
+      if (status != SUCCESS)
+         break;
+
+      saved = *end;
+      *end = '\0';
+      FT_explainStart();
+      found = Node_hasChild(curr, prefix, &childID);
+      FT_explainEnd(curr, len);
+      *end = saved;
+      if (found != 1)
+         break;
+
+      curr = Node_getChild(curr, childID);
+      FT_VISIT();
+      len = (size_t)(end - prefix);
    }
-   return NULL;
+
+   free(prefix);
+   if (status == SUCCESS)
+      *result = curr;
+   return status;
 }
 
 /*--------------------------------------------------------------------*/
 /*
-   Returns the farthest Node reachable from the root following a given
-   path, or NULL if there is no Node in the hierarchy that matches a
-   prefix of the path.
+   Stores in *result the farthest Node reachable from the root
+   following a given path, or NULL if there is no Node in the
+   hierarchy that matches a prefix of the path. Returns SUCCESS, or
+   MEMORY_ERROR if unable to allocate sufficient memory.
 */
-static Node FT_traversePath(char *path) {
+static int FT_traversePath(char *path, Node *result) {
    assert(path != NULL);
+   assert(result != NULL);
+
+   *result = NULL;
 
    /* Root Failure. */
    if (root == NULL)
-      return NULL;
+      return SUCCESS;
 
    /* Check if file is at root. */
    if (Node_getType(root) == FIL) {
-      if (strcmp(path, Node_getPath(root)) != EQUAL)
-         return NULL;
-      return root;
+      FT_VISIT();
+      COUNTERS_ADD(COUNTER_COMPARES, 1);
+      if (Node_hasPath(root, path))
+         *result = root;
+      return SUCCESS;
+   }
+
+   return FT_traversePathFrom(path, root, result);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Stops keeping the index of nodes by name, if one is kept.
+*/
+static void FT_dropNameIndex(void) {
+   NameIndex_free(nameIndex);
+   nameIndex = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Stops keeping the index of files by length, if one is kept.
+*/
+static void FT_dropSizeIndex(void) {
+   SizeIndex_free(sizeIndex);
+   sizeIndex = NULL;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Adds n and its ancestors below stop, a Node above n or NULL, to the
+   indexes of nodes by name and of files by length, if they are kept.
+   If an index cannot grow, stops keeping it, since it would be
+   incomplete.
+*/
+static void FT_indexNew(Node n, Node stop) {
+   for (; (nameIndex != NULL || sizeIndex != NULL) && n != stop;
+        n = Node_getParent(n)) {
+      if (nameIndex != NULL && !NameIndex_add(nameIndex, n))
+         FT_dropNameIndex();
+      if (sizeIndex != NULL && Node_getType(n) == FIL &&
+          !SizeIndex_add(sizeIndex, n))
+         FT_dropSizeIndex();
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Adds the hierarchy rooted at n to the index of nodes by name, which
+   must be kept. Returns TRUE if successful, FALSE if the index cannot
+   grow.
+*/
+static boolean FT_indexAll(Node n) {
+   size_t i;
+
+   assert(n != NULL);
+
+   if (!NameIndex_add(nameIndex, n) || Node_expand(n) != SUCCESS)
+      return FALSE;
+   for (i = 0; i < Node_getNumChildren(n); i++)
+      if (!FT_indexAll(Node_getChild(n, i)))
+         return FALSE;
+   return TRUE;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Adds the files of the hierarchy rooted at n to the index of files
+   by length, which must be kept. Returns TRUE if successful, FALSE if
+   the index cannot grow.
+*/
+static boolean FT_sizeIndexAll(Node n) {
+   size_t i;
+
+   assert(n != NULL);
+
+   if (Node_getType(n) == FIL)
+      return (boolean)SizeIndex_add(sizeIndex, n);
+   if (Node_expand(n) != SUCCESS)
+      return FALSE;
+   for (i = 0; i < Node_getNumChildren(n); i++)
+      if (!FT_sizeIndexAll(Node_getChild(n, i)))
+         return FALSE;
+   return TRUE;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Removes the hierarchy rooted at n from the indexes of nodes by name
+   and of files by length, if they are kept.
+*/
+static void FT_unindex(Node n) {
+   size_t i;
+
+   assert(n != NULL);
+
+   if (nameIndex == NULL && sizeIndex == NULL)
+      return;
+
+   if (nameIndex != NULL)
+      NameIndex_remove(nameIndex, n);
+   if (sizeIndex != NULL && Node_getType(n) == FIL)
+      SizeIndex_remove(sizeIndex, n);
+   for (i = 0; i < Node_getNumChildren(n); i++)
+      FT_unindex(Node_getChild(n, i));
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Readies n to change: expands n if it is a copy whose children are
+   not yet copied, and unshares n and each of its ancestors, from the
+   root down, so that no copy sees the change. Returns SUCCESS, or
+   MEMORY_ERROR if unable to allocate sufficient memory.
+*/
+static int FT_prepare(Node n) {
+   int status;
+
+   assert(n != NULL);
+
+   if (Node_getParent(n) != NULL) {
+      status = FT_prepare(Node_getParent(n));
+      if (status != SUCCESS)
+         return status;
    }
 
-   return FT_traversePathFrom(path, root);
+   status = Node_unshare(n);
+   if (status != SUCCESS)
+      return status;
+   return Node_expand(n);
 }
 
 /*--------------------------------------------------------------------*/
@@ -121,6 +399,11 @@ static int FT_linkParentToChild(Node parent, Node child) {
    returns PARENT_CHID_ERROR
 
    Otherwise, returns SUCCESS.
+
+   New nodes are linked top-down as they are created, so that the
+   totals below each directory are updated once, through ancestors
+   that are already in the tree. On failure, the new nodes, last
+   included, are unlinked and destroyed, leaving the tree as it was.
 */
 static int FT_insertRestOfPath(char *path, Node parent, Node last) {
 
@@ -129,106 +412,111 @@ static int FT_insertRestOfPath(char *path, Node parent, Node last) {
    Node new;
    char *copyPath;
    char *restPath = path;
+   const char *currPath;
    char *dirToken;
    char *nextToken;
-   int result;
+   int result = SUCCESS;
    size_t newCount = 0;
 
    assert(path != NULL);
    assert(last != NULL);
 
-   /* Test if need to root at a file. */
-   if ((root == NULL) && (Node_getType(last) == FIL)) {
+   /* Test if need to root at a file or at a one-component dir. */
+   if ((root == NULL) && ((Node_getType(last) == FIL) ||
+                          (strchr(path, '/') == NULL))) {
       count++;
       root = last;
+      FT_indexNew(root, NULL);
       return SUCCESS;
    }
 
    /* Test root case and if already exists or get rest of path. */
    if (curr == NULL) {
       if (root != NULL) {
+         (void)Node_destroy(last);
          return CONFLICTING_PATH;
       }
    } else {
-      if (strcmp(path, Node_getPath(curr)) == EQUAL)
+      if (Node_hasPath(curr, path)) {
+         (void)Node_destroy(last);
          return ALREADY_IN_TREE;
+      }
 
-      restPath += (strlen(Node_getPath(curr)) + 1);
+      currPath = Node_getPath(curr);
+      if (currPath == NULL || FT_prepare(curr) != SUCCESS) {
+         (void)Node_destroy(last);
+         return MEMORY_ERROR;
+      }
+      restPath += (strlen(currPath) + 1);
    }
 
    /* Set up tokenizing for inserting path. */
    copyPath = malloc(strlen(restPath) + 1);
-   if (copyPath == NULL)
+   if (copyPath == NULL) {
+      (void)Node_destroy(last);
       return MEMORY_ERROR;
+   }
    strcpy(copyPath, restPath);
    dirToken = strtok(copyPath, "/");
 
-   /* Create necessary new nodes and link. */
+   /* Create necessary new nodes and link each below the last. */
    while ((nextToken = strtok(NULL, "/")) != NULL) {
       new = Node_createDir(dirToken, curr);
-      newCount++;
-
-      /* Test if first in chain or link successively. */
-      if (firstNew == NULL)
-         firstNew = new;
-      else {
-         result = FT_linkParentToChild(curr, new);
-         if (result != SUCCESS) {
-            (void)Node_destroy(new);
-            (void)Node_destroy(firstNew);
-            free(copyPath);
-            return result;
-         }
+      if (new == NULL) {
+         result = MEMORY_ERROR;
+         break;
       }
 
-      if (new == NULL) {
-         (void)Node_destroy(firstNew);
-         free(copyPath);
-         return MEMORY_ERROR;
+      /* Without a parent, the first new node becomes the root. */
+      if (curr != NULL) {
+         result = FT_linkParentToChild(curr, new);
+         if (result != SUCCESS)
+            break;
       }
 
+      if (firstNew == NULL)
+         firstNew = new;
+      newCount++;
       curr = new;
       dirToken = nextToken;
    }
-
-   /* Insert last node. */
-   newCount++;
-   result = FT_linkParentToChild(curr, last);
-   if (result != SUCCESS) {
-      (void)Node_destroy(last);
-      (void)Node_destroy(firstNew);
-      free(copyPath);
-      return result;
-   }
    free(copyPath);
 
-   /* See if this is the first insert. */
-   if (firstNew == NULL) {
-      firstNew = last;
-      count += newCount;
-      return SUCCESS;
+   /* Insert last node. */
+   if (result == SUCCESS) {
+      result = FT_linkParentToChild(curr, last);
+      newCount++;
    }
+   else
+      (void)Node_destroy(last);
 
-   /* Finish linking process to given prefix. */
-   if (parent == NULL) {
-      root = firstNew;
-      count = newCount;
-      return SUCCESS;
-   } else {
-      result = FT_linkParentToChild(parent, firstNew);
-      if (result == SUCCESS)
-         count += newCount;
-      else
+   /* Undo the partial insertion. */
+   if (result != SUCCESS) {
+      if (firstNew != NULL) {
+         if (parent != NULL)
+            (void)Node_unlinkChild(parent, firstNew);
          (void)Node_destroy(firstNew);
-
+      }
       return result;
    }
+
+   if (parent == NULL)
+      root = firstNew;
+   count += newCount;
+   FT_indexNew(last, parent);
+   return SUCCESS;
 }
 
 /*--------------------------------------------------------------------*/
-int FT_insertDir(char *path) {
+/*
+   Does the work of FT_insertDir, as declared in ft.h.
+*/
+static int FT_doInsertDir(char *path) {
    Node curr;
    Node farthestNew;
+   int result;
+
+   FT_CHECK();
 
    assert(path != NULL);
 
@@ -236,7 +524,9 @@ int FT_insertDir(char *path) {
       return INITIALIZATION_ERROR;
 
    /* Go down as far as possible on prefix. */
-   curr = FT_traversePath(path);
+   result = FT_traversePath(path, &curr);
+   if (result != SUCCESS)
+      return result;
 
    /* Create final dir node to insert. */
    farthestNew = Node_createDir(path, NULL);
@@ -248,18 +538,26 @@ int FT_insertDir(char *path) {
 }
 
 /*--------------------------------------------------------------------*/
-int FT_insertFile(char *path, void *contents, size_t length) {
+/*
+   Does the work of FT_insertFile, as declared in ft.h.
+*/
+static int FT_doInsertFile(char *path, void *contents,
+                           size_t length) {
    Node curr;
    Node farthestNew;
    int result;
 
+   FT_CHECK();
+
    assert(path != NULL);
 
    if (!isInitialized)
       return INITIALIZATION_ERROR;
 
    /* Go down as far as possible on prefix. */
-   curr = FT_traversePath(path);
+   result = FT_traversePath(path, &curr);
+   if (result != SUCCESS)
+      return result;
 
    /* Create final file node to insert. */
    farthestNew = Node_createFile(path, contents, length);
@@ -268,8 +566,10 @@ int FT_insertFile(char *path, void *contents, size_t length) {
 
    /* Test if it's parent is a file. */
    if ((curr != NULL) && (Node_getType(curr) == FIL) &&
-       (strcmp(path, Node_getPath(curr)) != EQUAL))
+       (!Node_hasPath(curr, path))) {
+      (void)Node_destroy(farthestNew);
       return NOT_A_DIRECTORY;
+   }
 
    /* Insert the Node(s) and all other paths not in tree. */
    result = FT_insertRestOfPath(path, curr, farthestNew);
@@ -281,23 +581,29 @@ int FT_insertFile(char *path, void *contents, size_t length) {
 }
 
 /*--------------------------------------------------------------------*/
-boolean FT_containsDir(char *path) {
+/*
+   Does the work of FT_containsDir, as declared in ft.h.
+*/
+static boolean FT_doContainsDir(char *path) {
    Node curr;
 
+   FT_CHECK();
+
    assert(path != NULL);
 
    if (!isInitialized)
       return FALSE;
 
    /* Try to reach node. */
-   curr = FT_traversePath(path);
+   if (FT_traversePath(path, &curr) != SUCCESS)
+      return FALSE;
 
    /* Root Failure. */
    if (curr == NULL)
       return FALSE;
 
    /* Mismatch Failure. */
-   if (strcmp(path, Node_getPath(curr)) != EQUAL)
+   if (!Node_hasPath(curr, path))
       return FALSE;
 
    /* File Failure. */
@@ -308,23 +614,29 @@ boolean FT_containsDir(char *path) {
 }
 
 /*--------------------------------------------------------------------*/
-boolean FT_containsFile(char *path) {
+/*
+   Does the work of FT_containsFile, as declared in ft.h.
+*/
+static boolean FT_doContainsFile(char *path) {
    Node curr;
 
+   FT_CHECK();
+
    assert(path != NULL);
 
    if (!isInitialized)
       return FALSE;
 
    /* Try to reach node. */
-   curr = FT_traversePath(path);
+   if (FT_traversePath(path, &curr) != SUCCESS)
+      return FALSE;
 
    /* Root Failure. */
    if (curr == NULL)
       return FALSE;
 
    /* Mismatch Failure. */
-   if (strcmp(path, Node_getPath(curr)) != EQUAL)
+   if (!Node_hasPath(curr, path))
       return FALSE;
 
    /* Dir Failure. */
@@ -335,23 +647,29 @@ boolean FT_containsFile(char *path) {
 }
 
 /*--------------------------------------------------------------------*/
-void *FT_getFileContents(char *path) {
+/*
+   Does the work of FT_getFileContents, as declared in ft.h.
+*/
+static void *FT_doGetFileContents(char *path) {
    Node curr;
 
+   FT_CHECK();
+
    assert(path != NULL);
 
    if (!isInitialized)
       return NULL;
 
    /* Try to reach node. */
-   curr = FT_traversePath(path);
+   if (FT_traversePath(path, &curr) != SUCCESS)
+      return NULL;
 
    /* Root Failure. */
    if (curr == NULL)
       return NULL;
 
    /* Mismatch Failure. */
-   if (strcmp(path, Node_getPath(curr)) != EQUAL)
+   if (!Node_hasPath(curr, path))
       return NULL;
 
    /* Dir Failure. */
@@ -362,9 +680,16 @@ void *FT_getFileContents(char *path) {
 }
 
 /*--------------------------------------------------------------------*/
-void *FT_replaceFileContents(char *path, void *newContents,
-                             size_t newLength) {
+/*
+   Does the work of FT_replaceFileContents, as declared in ft.h.
+*/
+static void *FT_doReplaceFileContents(char *path, void *newContents,
+                                     size_t newLength) {
    Node curr;
+   void *oldContents;
+   size_t oldLength;
+
+   FT_CHECK();
 
    assert(path != NULL);
 
@@ -372,27 +697,41 @@ void *FT_replaceFileContents(char *path, void *newContents,
       return NULL;
 
    /* Try to reach node. */
-   curr = FT_traversePath(path);
+   if (FT_traversePath(path, &curr) != SUCCESS)
+      return NULL;
 
    /* Root Failure. */
    if (curr == NULL)
       return NULL;
 
    /* Mismatch Failure. */
-   if (strcmp(path, Node_getPath(curr)) != EQUAL)
+   if (!Node_hasPath(curr, path))
       return NULL;
 
    /* Dir Failure. */
    if (Node_getType(curr) == DIR)
       return NULL;
 
-   return Node_replaceFileContents(curr, newContents, newLength);
+   if (FT_prepare(curr) != SUCCESS)
+      return NULL;
+
+   oldLength = Node_getLength(curr);
+   oldContents = Node_replaceFileContents(curr, newContents, newLength);
+   if (sizeIndex != NULL)
+      SizeIndex_update(sizeIndex, curr, oldLength);
+   return oldContents;
 }
 
 /*--------------------------------------------------------------------*/
-int FT_rmDir(char *path) {
+/*
+   Does the work of FT_rmDir, as declared in ft.h.
+*/
+static int FT_doRmDir(char *path) {
    Node curr;
    Node parent;
+   int status;
+
+   FT_CHECK();
 
    assert(path != NULL);
 
@@ -400,7 +739,9 @@ int FT_rmDir(char *path) {
       return INITIALIZATION_ERROR;
 
    /* Traverse to requested node. */
-   curr = FT_traversePath(path);
+   status = FT_traversePath(path, &curr);
+   if (status != SUCCESS)
+      return status;
 
    /* Root Failure. */
    if (curr == NULL)
@@ -411,12 +752,17 @@ int FT_rmDir(char *path) {
       return NOT_A_DIRECTORY;
 
    parent = Node_getParent(curr);
-   if (!strcmp(path, Node_getPath(curr))) {
+   if (Node_hasPath(curr, path)) {
+      if (parent != NULL && FT_prepare(parent) != SUCCESS)
+         return MEMORY_ERROR;
+
       if (parent == NULL)
          root = NULL;
       else
          Node_unlinkChild(parent, curr);
 
+      FT_unindex(curr);
+
       count -= Node_destroy(curr);
 
       return SUCCESS;
@@ -425,9 +771,15 @@ int FT_rmDir(char *path) {
 }
 
 /*--------------------------------------------------------------------*/
-int FT_rmFile(char *path) {
+/*
+   Does the work of FT_rmFile, as declared in ft.h.
+*/
+static int FT_doRmFile(char *path) {
    Node curr;
    Node parent;
+   int status;
+
+   FT_CHECK();
 
    assert(path != NULL);
 
@@ -435,7 +787,9 @@ int FT_rmFile(char *path) {
       return INITIALIZATION_ERROR;
 
    /* Traverse to requested node. */
-   curr = FT_traversePath(path);
+   status = FT_traversePath(path, &curr);
+   if (status != SUCCESS)
+      return status;
 
    /* Root Failure. */
    if (curr == NULL)
@@ -446,12 +800,17 @@ int FT_rmFile(char *path) {
       return NOT_A_FILE;
 
    parent = Node_getParent(curr);
-   if (!strcmp(path, Node_getPath(curr))) {
+   if (Node_hasPath(curr, path)) {
+      if (parent != NULL && FT_prepare(parent) != SUCCESS)
+         return MEMORY_ERROR;
+
       if (parent == NULL)
          root = NULL;
       else
          Node_unlinkChild(parent, curr);
 
+      FT_unindex(curr);
+
       count -= Node_destroy(curr);
 
       return SUCCESS;
@@ -460,7 +819,11 @@ int FT_rmFile(char *path) {
 }
 
 /*--------------------------------------------------------------------*/
-int FT_init(void) {
+/*
+   Does the work of FT_init, as declared in ft.h.
+*/
+static int FT_doInit(void) {
+   FT_CHECK();
 
    if (isInitialized)
       return INITIALIZATION_ERROR;
@@ -474,43 +837,100 @@ int FT_init(void) {
 }
 
 /*--------------------------------------------------------------------*/
-int FT_destroy(void) {
+/*
+   Does the work of FT_destroy, as declared in ft.h.
+*/
+static int FT_doDestroy(void) {
+   FT_CHECK();
 
    if (!isInitialized)
       return INITIALIZATION_ERROR;
 
    /* Destroy tree and reset AO. */
+   if (nameIndex != NULL)
+      NameIndex_clear(nameIndex);
+   if (sizeIndex != NULL)
+      SizeIndex_clear(sizeIndex);
    if (root != NULL)
       (void)Node_destroy(root);
    root = NULL;
+   count = 0;
    isInitialized = FALSE;
 
+   free(nthPath.text);
+   memset(&nthPath, 0, sizeof(nthPath));
+
    return SUCCESS;
 }
 
 /*--------------------------------------------------------------------*/
 /*
-   Performs a pre-order traversal of the tree rooted at n,
-   inserting each payload to DynArray_T d beginning at index i.
-   Returns the next unused index in d after the insertion(s).
+   Performs a pre-order traversal of the tree rooted at n, whose path
+   is in path, inserting each path to DynArray_T d beginning at index
+   *i, and advancing *i past them. A copy is read through the directory
+   it copies, and once shared is TRUE, so is n: the paths found that
+   way are built, and added to built as well, for the caller to free.
+   Returns SUCCESS, or MEMORY_ERROR if unable to allocate sufficient
+   memory.
 */
-static size_t FT_preOrderTraversal(Node n, DynArray_T d, size_t i) {
+static int FT_preOrderTraversal(Node n, struct NodePath *path,
+                                boolean shared, DynArray_T d,
+                                size_t *i, DynArray_T built) {
+   const char *nodePath;
+   char *copyPath;
+   Node source;
+   size_t length;
    size_t c;
+   int status = SUCCESS;
 
+   assert(n != NULL);
+   assert(path != NULL);
    assert(d != NULL);
+   assert(i != NULL);
+   assert(built != NULL);
 
-   if (n != NULL) {
-      (void)DynArray_set(d, i, Node_getPath(n));
-      i++;
-      for (c = 0; c < Node_getNumChildren(n); c++)
-         i = FT_preOrderTraversal(Node_getChild(n, c), d, i);
+   if (!shared) {
+      nodePath = Node_getPath(n);
+      if (nodePath == NULL)
+         return MEMORY_ERROR;
+   }
+   else {
+      copyPath = malloc(path->length + 1);
+      if (copyPath == NULL)
+         return MEMORY_ERROR;
+      strcpy(copyPath, path->text);
+      if (!DynArray_add(built, copyPath)) {
+         free(copyPath);
+         return MEMORY_ERROR;
+      }
+      nodePath = copyPath;
+   }
+   (void)DynArray_set(d, (*i)++, nodePath);
+
+   source = Node_getShared(n);
+   if (source != n)
+      shared = TRUE;
+   length = path->length;
+   for (c = 0; status == SUCCESS && c < Node_getNumChildren(source);
+        c++) {
+      status = Node_appendName(Node_getChild(source, c), path);
+      if (status == SUCCESS)
+         status = FT_preOrderTraversal(Node_getChild(source, c), path,
+                                       shared, d, i, built);
+      Node_truncatePath(path, length);
    }
-   return i;
+   return status;
 }
 
 /*--------------------------------------------------------------------*/
-int FT_stat(char *path, boolean *type, size_t *length) {
+/*
+   Does the work of FT_stat, as declared in ft.h.
+*/
+static int FT_doStat(char *path, boolean *type, size_t *length) {
    Node curr;
+   int status;
+
+   FT_CHECK();
 
    assert(path != NULL);
 
@@ -518,7 +938,9 @@ int FT_stat(char *path, boolean *type, size_t *length) {
       return INITIALIZATION_ERROR;
 
    /* Traverse to requested node. */
-   curr = FT_traversePath(path);
+   status = FT_traversePath(path, &curr);
+   if (status != SUCCESS)
+      return status;
 
    /* Root Failure. */
    if (curr == NULL)
@@ -537,29 +959,101 @@ int FT_stat(char *path, boolean *type, size_t *length) {
 }
 
 /*--------------------------------------------------------------------*/
-char *FT_toString(void) {
+/*
+   Adds the length of str plus one for its newline to *pAcc,
+   if str is not NULL.
+*/
+static void FT_strlenAccumulate(char *str, size_t *pAcc) {
+   assert(pAcc != NULL);
+
+   if (str != NULL)
+      *pAcc += (strlen(str) + 1);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Adds the partial sum *pPartial into *pSum.
+*/
+static void FT_sumCombine(size_t *pPartial, size_t *pSum) {
+   assert(pPartial != NULL);
+   assert(pSum != NULL);
+
+   *pSum += *pPartial;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Frees the DynArray_T of paths d, and the DynArray_T built of the
+   paths in it that were built, with those paths.
+*/
+static void FT_freeBuilt(DynArray_T d, DynArray_T built) {
+   size_t i;
+
+   assert(d != NULL);
+   assert(built != NULL);
+
+   for (i = 0; i < DynArray_getLength(built); i++)
+      free(DynArray_get(built, i));
+   DynArray_free(built);
+   DynArray_free(d);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Does the work of FT_toString, as declared in ft.h.
+*/
+static char *FT_doToString(void) {
    DynArray_T nodes;
+   DynArray_T built;
+   struct NodePath path = {NULL, 0, 0};
    size_t i;
+   size_t next = 0;
    char *tmp;
    size_t totalStrlen = 1;
    char *result = NULL;
+   int status = SUCCESS;
+
+   FT_CHECK();
 
    if (!isInitialized)
       return NULL;
 
    nodes = DynArray_new(count);
-   (void)FT_preOrderTraversal(root, nodes, 0);
+   built = DynArray_new(0);
+   if (nodes == NULL || built == NULL) {
+      if (nodes != NULL)
+         DynArray_free(nodes);
+      if (built != NULL)
+         DynArray_free(built);
+      return NULL;
+   }
 
-   /* Don't use map() as too many funcs - get total strlen needed. */
-   for (i = 0; i < DynArray_getLength(nodes); i++) {
-      tmp = DynArray_get(nodes, i);
-      if (tmp != NULL)
-         totalStrlen += (strlen(tmp) + 1);
+   /* Copies are listed through the directories they copy, so they
+      stay lazy; a path that cannot be built fails the whole list. */
+   if (root != NULL) {
+      status = Node_appendName(root, &path);
+      if (status == SUCCESS)
+         status = FT_preOrderTraversal(root, &path, FALSE, nodes,
+                                       &next, built);
+      free(path.text);
+   }
+   if (status != SUCCESS) {
+      FT_freeBuilt(nodes, built);
+      return NULL;
+   }
+
+   /* Get total strlen needed, spread over the ThreadPool. */
+   if (!DynArray_parallelReduce(
+          nodes, (void (*)(void *, void *))FT_strlenAccumulate,
+          (void (*)(void *, void *))FT_sumCombine, sizeof(size_t),
+          &totalStrlen)) {
+      FT_freeBuilt(nodes, built);
+      return NULL;
    }
 
    result = malloc(totalStrlen);
    if (result == NULL) {
-      DynArray_free(nodes);
+      FT_freeBuilt(nodes, built);
       return NULL;
    }
    *result = '\0';
@@ -572,7 +1066,1355 @@ char *FT_toString(void) {
       strcat(result, "\n");
    }
 
-   DynArray_free(nodes);
+   FT_freeBuilt(nodes, built);
+
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Returns the current time in nanoseconds from a monotonic clock.
+*/
+static uint64_t FT_nanoseconds(void) {
+   struct timespec now;
+
+   (void)clock_gettime(CLOCK_MONOTONIC, &now);
+   return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Finishes a call to the function op that started at start. Counts
+   the call in the stats as ending in status, logs it if it took at
+   least the slow-call threshold, and if a trace is being recorded and
+   op is traced, writes a record of it to the trace file given the
+   call's path and second path (NULL if none), whether it was given
+   non-NULL contents, its length, and its result. If the write fails,
+   stops recording.
+*/
+static void FT_finish(int op, int status, const char *path,
+                      const char *path2, boolean hasContents,
+                      size_t length, int result, uint64_t start) {
+   struct TraceRecord record;
+   uint64_t nanoseconds = FT_nanoseconds() - start;
+
+   Stats_record(op, status, nanoseconds);
+#ifdef FT_COUNTERS
+   Counters_take(&opCounters[op]);
+#endif
+   if (slowThreshold != 0 && nanoseconds >= slowThreshold)
+      SlowLog_record(op, path, status, nanoseconds, callNodes);
+   callNodes = 0;
+   if (traceFile == NULL || op >= FT_NUM_TRACED_OPS)
+      return;
+
+   record.op = op;
+   record.path = path;
+   record.path2 = path2;
+   record.hasContents = hasContents;
+   record.length = length;
+   record.result = (uint64_t)result;
+   record.nanoseconds = nanoseconds;
+
+   if (!Trace_write(traceFile, &record)) {
+      (void)fclose(traceFile);
+      traceFile = NULL;
+      traceFailed = TRUE;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Returns the status counted for a call of a function that returns
+   no status, given whether it found what it was called for. A call
+   that did not find it counts as INITIALIZATION_ERROR if the FT is
+   not initialized, and as notFound otherwise.
+*/
+static int FT_statusOf(boolean found, int notFound) {
+   if (found)
+      return SUCCESS;
+   if (!isInitialized)
+      return INITIALIZATION_ERROR;
+   return notFound;
+}
+
+/*--------------------------------------------------------------------*/
+boolean FT_traceOpen(const char *filename) {
+   assert(filename != NULL);
+
+   if (traceFile != NULL)
+      (void)FT_traceClose();
+
+   traceFile = fopen(filename, "wb");
+   if (traceFile == NULL)
+      return FALSE;
+   traceFailed = FALSE;
+
+   if (!Trace_writeHeader(traceFile)) {
+      (void)fclose(traceFile);
+      traceFile = NULL;
+      return FALSE;
+   }
+   return TRUE;
+}
+
+/*--------------------------------------------------------------------*/
+boolean FT_traceClose(void) {
+   boolean wasOpen = (boolean)(traceFile != NULL);
+
+   if (traceFile != NULL && fclose(traceFile) != 0)
+      traceFailed = TRUE;
+   traceFile = NULL;
+
+   return (boolean)(wasOpen && !traceFailed);
+}
+
+/*--------------------------------------------------------------------*/
+void FT_getStats(struct Stats *stats) {
+   assert(stats != NULL);
+
+   Stats_get(stats);
+}
+
+/*--------------------------------------------------------------------*/
+void FT_resetStats(void) {
+   Stats_reset();
+}
+
+/*--------------------------------------------------------------------*/
+int FT_explain(char *path, struct Explain *explain) {
+   Node curr;
+   Node reached;
+   int status;
+
+   assert(path != NULL);
+   assert(explain != NULL);
+
+   memset(explain, 0, sizeof(struct Explain));
+   if (!isInitialized)
+      return INITIALIZATION_ERROR;
+
+   Counters_take(NULL);
+   explaining = explain;
+   status = FT_traversePath(path, &curr);
+   explaining = NULL;
+   callNodes = 0;
+   Counters_take(&explain->counters);
+
+   if (status != SUCCESS)
+      return status;
+   if (curr == NULL)
+      return NO_SUCH_PATH;
+
+   explain->depth = 1;
+   for (reached = Node_getParent(curr); reached != NULL;
+        reached = Node_getParent(reached))
+      explain->depth++;
+
+   if (!Node_hasPath(curr, path))
+      return NO_SUCH_PATH;
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_shapeStats(struct ShapeStats *stats, size_t maxChildren) {
+   assert(stats != NULL);
+
+   if (!isInitialized)
+      return INITIALIZATION_ERROR;
+
+   return Shape_compute(root, stats, maxChildren, SHAPE_SEED);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Does the work of FT_glob, as declared in ft.h.
+*/
+static int FT_doGlob(const char *pattern,
+                     void (*callback)(const char *path, boolean isFile,
+                                      void *extra),
+                     void *extra) {
+   assert(pattern != NULL);
+   assert(callback != NULL);
+
+   if (!isInitialized)
+      return INITIALIZATION_ERROR;
+
+   return PathGlob_find(root, pattern, callback, extra);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Does the work of FT_listDir, as declared in ft.h.
+*/
+static int FT_doListDir(char *path, struct FT_Entry *entries,
+                        size_t maxEntries, size_t *cursor,
+                        size_t *numEntries) {
+   struct FT_Entry *entry;
+   Node dir;
+   Node child;
+   size_t numChildren;
+   size_t i;
+   int status;
+
+   FT_CHECK();
+
+   assert(path != NULL);
+   assert(entries != NULL || maxEntries == 0);
+   assert(cursor != NULL);
+   assert(numEntries != NULL);
+
+   *numEntries = 0;
+   if (!isInitialized)
+      return INITIALIZATION_ERROR;
+
+   /* Resolve the directory once. */
+   status = FT_traversePath(path, &dir);
+   if (status != SUCCESS)
+      return status;
+   if (dir == NULL || !Node_hasPath(dir, path))
+      return NO_SUCH_PATH;
+   if (Node_getType(dir) == FIL)
+      return NOT_A_DIRECTORY;
+
+   /* A copy is listed through the directory it copies. */
+   dir = Node_getShared(dir);
+
+   numChildren = Node_getNumChildren(dir);
+   for (i = *cursor; i < numChildren && *numEntries < maxEntries;
+        i++) {
+      child = Node_getChild(dir, i);
+      entry = &entries[(*numEntries)++];
+      entry->name = Node_getName(child);
+      entry->isFile = (boolean)(Node_getType(child) == FIL);
+      entry->length = entry->isFile ? Node_getLength(child) : 0;
+   }
+
+   *cursor = i;
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Does the work of FT_statEx, as declared in ft.h.
+*/
+static int FT_doStatEx(char *path, struct FT_Stat *stat) {
+   Node curr;
+   int status;
+
+   FT_CHECK();
+
+   assert(path != NULL);
+   assert(stat != NULL);
+
+   if (!isInitialized)
+      return INITIALIZATION_ERROR;
+
+   status = FT_traversePath(path, &curr);
+   if (status != SUCCESS)
+      return status;
+   if (curr == NULL || !Node_hasPath(curr, path))
+      return NO_SUCH_PATH;
+
+   stat->isFile = (boolean)(Node_getType(curr) == FIL);
+   if (stat->isFile) {
+      stat->length = Node_getLength(curr);
+      stat->files = 0;
+      stat->dirs = 0;
+      stat->bytes = stat->length;
+   }
+   else {
+      stat->length = 0;
+      stat->files = Node_getFilesBelow(curr);
+      stat->dirs = Node_getDirsBelow(curr);
+      stat->bytes = Node_getBytesBelow(curr);
+   }
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_nameIndexEnable(boolean enable) {
+   if (!enable) {
+      FT_dropNameIndex();
+      return SUCCESS;
+   }
+   if (nameIndex != NULL)
+      return SUCCESS;
+
+   nameIndex = NameIndex_new();
+   if (nameIndex == NULL)
+      return MEMORY_ERROR;
+   if (root != NULL && !FT_indexAll(root)) {
+      FT_dropNameIndex();
+      return MEMORY_ERROR;
+   }
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Calls callback, as FT_findByName does, with each Node in the
+   hierarchy rooted at n, whose path is in path, whose name is name,
+   or starts with name if prefix is TRUE, where name has length len.
+   A copy is read through the directory it copies. Returns SUCCESS, or
+   MEMORY_ERROR if unable to allocate sufficient memory.
+*/
+static int FT_findFrom(Node n, struct NodePath *path, const char *name,
+                       size_t len, boolean prefix,
+                       void (*callback)(const char *path,
+                                        boolean isFile, void *extra),
+                       void *extra) {
+   const char *nodeName;
+   Node source;
+   size_t length;
+   size_t i;
+   int status = SUCCESS;
+
+   assert(n != NULL);
+   assert(path != NULL);
+   assert(name != NULL);
+   assert(callback != NULL);
+
+   nodeName = Node_getName(n);
+   if (strncmp(nodeName, name, len) == EQUAL &&
+       (prefix || nodeName[len] == '\0'))
+      callback(path->text, (boolean)(Node_getType(n) == FIL), extra);
+
+   source = Node_getShared(n);
+   length = path->length;
+   for (i = 0; status == SUCCESS && i < Node_getNumChildren(source);
+        i++) {
+      status = Node_appendName(Node_getChild(source, i), path);
+      if (status == SUCCESS)
+         status = FT_findFrom(Node_getChild(source, i), path, name,
+                              len, prefix, callback, extra);
+      Node_truncatePath(path, length);
+   }
+   return status;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Does the work of FT_findByName and FT_findByNamePrefix, as declared
+   in ft.h: finds the Nodes named name, or whose names start with name
+   if prefix is TRUE, using the index if one is kept.
+*/
+static int FT_doFindByName(const char *name, boolean prefix,
+                           void (*callback)(const char *path,
+                                            boolean isFile,
+                                            void *extra),
+                           void *extra) {
+   struct NodePath path = {NULL, 0, 0};
+   int status;
+
+   FT_CHECK();
+
+   assert(name != NULL);
+   assert(callback != NULL);
+
+   if (!isInitialized)
+      return INITIALIZATION_ERROR;
+
+   if (nameIndex != NULL)
+      return NameIndex_find(nameIndex, name, prefix, callback, extra);
+   if (root == NULL)
+      return SUCCESS;
+
+   status = Node_appendName(root, &path);
+   if (status == SUCCESS)
+      status = FT_findFrom(root, &path, name, strlen(name), prefix,
+                           callback, extra);
+   free(path.text);
+   return status;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_sizeIndexEnable(boolean enable) {
+   if (!enable) {
+      FT_dropSizeIndex();
+      return SUCCESS;
+   }
+   if (sizeIndex != NULL)
+      return SUCCESS;
+
+   sizeIndex = SizeIndex_new();
+   if (sizeIndex == NULL)
+      return MEMORY_ERROR;
+   if (root != NULL && !FT_sizeIndexAll(root)) {
+      FT_dropSizeIndex();
+      return MEMORY_ERROR;
+   }
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Adds the files of the hierarchy rooted at n, whose path is in path,
+   whose lengths are from min to max to files, each as a struct
+   FT_SizedFile that the caller frees. A copy is read through the
+   directory it copies. Returns FALSE if insufficient memory is
+   available, and TRUE otherwise.
+*/
+static boolean FT_collectBySize(Node n, struct NodePath *path,
+                                size_t min, size_t max,
+                                DynArray_T files) {
+   struct FT_SizedFile *file;
+   Node source;
+   size_t length;
+   size_t i;
+
+   assert(n != NULL);
+   assert(path != NULL);
+   assert(files != NULL);
+
+   if (Node_getType(n) == FIL) {
+      if (Node_getLength(n) < min || Node_getLength(n) > max)
+         return TRUE;
+
+      /* The path is kept just after the struct, in one block. */
+      file = malloc(sizeof(struct FT_SizedFile) + path->length + 1);
+      if (file == NULL)
+         return FALSE;
+      file->length = Node_getLength(n);
+      file->path = (char *)(file + 1);
+      strcpy(file->path, path->text);
+      if (!DynArray_add(files, file)) {
+         free(file);
+         return FALSE;
+      }
+      return TRUE;
+   }
+
+   source = Node_getShared(n);
+   length = path->length;
+   for (i = 0; i < Node_getNumChildren(source); i++) {
+      if (Node_appendName(Node_getChild(source, i), path) != SUCCESS ||
+          !FT_collectBySize(Node_getChild(source, i), path, min, max,
+                            files))
+         return FALSE;
+      Node_truncatePath(path, length);
+   }
+   return TRUE;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Compares the struct FT_SizedFiles file1 and file2 by length.
+*/
+static int FT_compareBySize(const void *file1, const void *file2) {
+   size_t length1;
+   size_t length2;
+
+   assert(file1 != NULL);
+   assert(file2 != NULL);
+
+   length1 = ((const struct FT_SizedFile *)file1)->length;
+   length2 = ((const struct FT_SizedFile *)file2)->length;
+   if (length1 != length2)
+      return (length1 < length2) ? -1 : 1;
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Does the work of FT_filesBySize and FT_largestFiles, as declared in
+   ft.h, without the index: collects the files whose lengths are from
+   min to max and sorts them by length, then calls callback with the
+   first limit of them in increasing order, or if largest is TRUE, the
+   last limit of them in decreasing order.
+*/
+static int FT_sortBySize(size_t min, size_t max, size_t limit,
+                         boolean largest,
+                         void (*callback)(const char *path,
+                                          size_t length, void *extra),
+                         void *extra) {
+   struct FT_SizedFile *file;
+   struct NodePath path = {NULL, 0, 0};
+   DynArray_T files;
+   size_t numFiles;
+   size_t i;
+   boolean collected;
+
+   assert(callback != NULL);
+
+   if (root == NULL)
+      return SUCCESS;
+
+   files = DynArray_new(0);
+   if (files == NULL)
+      return MEMORY_ERROR;
+   collected = FALSE;
+   if (Node_appendName(root, &path) == SUCCESS)
+      collected = FT_collectBySize(root, &path, min, max, files);
+   free(path.text);
+
+   numFiles = DynArray_getLength(files);
+   if (collected) {
+      DynArray_sort(files, FT_compareBySize);
+      for (i = 0; i < numFiles && i < limit; i++) {
+         file = DynArray_get(files, largest ? numFiles - 1 - i : i);
+         callback(file->path, file->length, extra);
+      }
+   }
+
+   for (i = 0; i < numFiles; i++)
+      free(DynArray_get(files, i));
+   DynArray_free(files);
+   return collected ? SUCCESS : MEMORY_ERROR;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Does the work of FT_filesBySize, as declared in ft.h.
+*/
+static int FT_doFilesBySize(size_t min, size_t max,
+                            void (*callback)(const char *path,
+                                             size_t length,
+                                             void *extra),
+                            void *extra) {
+   FT_CHECK();
+
+   assert(callback != NULL);
+
+   if (!isInitialized)
+      return INITIALIZATION_ERROR;
+
+   if (sizeIndex == NULL)
+      return FT_sortBySize(min, max, SIZE_MAX, FALSE, callback, extra);
+   return SizeIndex_findRange(sizeIndex, min, max, callback, extra);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Does the work of FT_largestFiles, as declared in ft.h.
+*/
+static int FT_doLargestFiles(size_t k,
+                             void (*callback)(const char *path,
+                                              size_t length,
+                                              void *extra),
+                             void *extra) {
+   FT_CHECK();
+
+   assert(callback != NULL);
+
+   if (!isInitialized)
+      return INITIALIZATION_ERROR;
+
+   if (sizeIndex == NULL)
+      return FT_sortBySize(0, SIZE_MAX, k, TRUE, callback, extra);
+   return SizeIndex_findLargest(sizeIndex, k, callback, extra);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Compares the paths path1 and path2 in the order of FT_scanRange:
+   as strcmp does, but with '/' less than every other character, so
+   that paths compare component by component.
+   Returns <0, 0, or >0 if path1 is less than, equal to, or greater
+   than path2, respectively.
+*/
+static int FT_comparePaths(const char *path1, const char *path2) {
+   int rank1;
+   int rank2;
+
+   assert(path1 != NULL);
+   assert(path2 != NULL);
+
+   while (*path1 == *path2 && *path1 != '\0') {
+      path1++;
+      path2++;
+   }
+
+   rank1 = (*path1 == '/') ? 1 : (*path1 == '\0') ? 0 :
+      (unsigned char)*path1 + 1;
+   rank2 = (*path2 == '/') ? 1 : (*path2 == '\0') ? 0 :
+      (unsigned char)*path2 + 1;
+   return rank1 - rank2;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Returns the first of the children lo up to hi of the directory dir,
+   all of one type, whose name is not less than the name of len
+   characters at name, or hi if there is none.
+*/
+static size_t FT_lowerBoundName(Node dir, size_t lo, size_t hi,
+                                const char *name, size_t len) {
+   const char *childName;
+   size_t mid;
+
+   assert(dir != NULL);
+   assert(name != NULL);
+
+   while (lo < hi) {
+      mid = lo + (hi - lo) / 2;
+      childName = Node_getName(Node_getChild(dir, mid));
+      COUNTERS_ADD(COUNTER_PROBES, 1);
+      if (strncmp(childName, name, len) < 0)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   return lo;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Calls callback, as FT_scanRange does, with each path of the
+   hierarchy rooted at n, whose path is in path, that is not less than
+   lo and less than hi, in order, where a NULL lo or hi is no bound. A
+   copy is read through the directory it copies. Returns FALSE once a
+   path not less than hi is reached, since no later path can be in
+   the range, and TRUE otherwise. Also returns FALSE, after storing
+   MEMORY_ERROR in *status, if unable to allocate sufficient memory.
+*/
+static boolean FT_scanFrom(Node n, struct NodePath *path,
+                           const char *lo, const char *hi,
+                           void (*callback)(const char *path,
+                                            boolean isFile,
+                                            void *extra),
+                           void *extra, int *status) {
+   size_t len;
+   size_t numFiles;
+   size_t numChildren;
+   size_t nextLen;
+   size_t i;
+   size_t j;
+   boolean isAncestor = FALSE;
+   boolean more = TRUE;
+   Node child;
+
+   assert(n != NULL);
+   assert(path != NULL);
+   assert(callback != NULL);
+   assert(status != NULL);
+
+   len = path->length;
+   FT_VISIT();
+
+   /* Below lo, only an ancestor of lo can lead into the range. Past
+      lo, so is everything after, and lo no longer matters. */
+   if (lo != NULL && FT_comparePaths(path->text, lo) < 0) {
+      if (strncmp(path->text, lo, len) != EQUAL || lo[len] != '/')
+         return TRUE;
+      isAncestor = TRUE;
+   }
+   else
+      lo = NULL;
+
+   if (!isAncestor) {
+      if (hi != NULL && FT_comparePaths(path->text, hi) >= 0)
+         return FALSE;
+      callback(path->text, (boolean)(Node_getType(n) == FIL), extra);
+   }
+
+   n = Node_getShared(n);
+   numChildren = Node_getNumChildren(n);
+   if (numChildren == 0)
+      return TRUE;
+
+   /* Files and directories are each sorted by name: merge them,
+      starting each at the name of lo's next component, if any. */
+   numFiles = Node_getNumFileChildren(n);
+   i = 0;
+   j = numFiles;
+   if (isAncestor) {
+      nextLen = strcspn(lo + len + 1, "/");
+      i = FT_lowerBoundName(n, 0, numFiles, lo + len + 1, nextLen);
+      j = FT_lowerBoundName(n, numFiles, numChildren, lo + len + 1,
+                            nextLen);
+   }
+
+   while (more && (i < numFiles || j < numChildren)) {
+      if (j == numChildren ||
+          (i < numFiles &&
+           strcmp(Node_getName(Node_getChild(n, i)),
+                  Node_getName(Node_getChild(n, j))) < 0))
+         child = Node_getChild(n, i++);
+      else
+         child = Node_getChild(n, j++);
+
+      if (Node_appendName(child, path) != SUCCESS) {
+         *status = MEMORY_ERROR;
+         return FALSE;
+      }
+      more = FT_scanFrom(child, path, lo, hi, callback, extra, status);
+      Node_truncatePath(path, len);
+   }
+   return more;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Does the work of FT_scanRange, as declared in ft.h.
+*/
+static int FT_doScanRange(const char *lo, const char *hi,
+                          void (*callback)(const char *path,
+                                           boolean isFile,
+                                           void *extra),
+                          void *extra) {
+   struct NodePath path = {NULL, 0, 0};
+   int status;
+
+   FT_CHECK();
+
+   assert(callback != NULL);
+
+   if (!isInitialized)
+      return INITIALIZATION_ERROR;
+   if (root == NULL)
+      return SUCCESS;
+
+   status = Node_appendName(root, &path);
+   if (status == SUCCESS)
+      (void)FT_scanFrom(root, &path, lo, hi, callback, extra, &status);
+   free(path.text);
+   return status;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Appends to path, which holds the path of n, the rest of the path of
+   the k'th Node, counting from 0, of the hierarchy rooted at n in
+   pre-order, where k is less than its size, descending straight to it
+   by the sizes of the subtrees before each child. A copy is read
+   through the directory it copies. Returns SUCCESS, or MEMORY_ERROR
+   if unable to allocate sufficient memory.
+*/
+static int FT_select(Node n, size_t k, struct NodePath *path) {
+   size_t childID;
+   size_t before;
+   int status;
+
+   assert(n != NULL);
+   assert(k < Node_getSubtreeSize(n));
+   assert(path != NULL);
+
+   /* Each step passes n itself, then the subtrees before the one
+      holding the k'th Node. */
+   while (k > 0) {
+      n = Node_getShared(n);
+      status = Node_findChildAt(n, k - 1, &childID, &before);
+      if (status != SUCCESS)
+         return status;
+      k -= 1 + before;
+      n = Node_getChild(n, childID);
+      FT_VISIT();
+      status = Node_appendName(n, path);
+      if (status != SUCCESS)
+         return status;
+   }
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Does the work of FT_nth, as declared in ft.h.
+*/
+static int FT_doNth(char *path, size_t k, const char **result) {
+   Node n;
+   int status;
+
+   FT_CHECK();
+
+   assert(path != NULL);
+   assert(result != NULL);
+
+   if (!isInitialized)
+      return INITIALIZATION_ERROR;
+
+   status = FT_traversePath(path, &n);
+   if (status != SUCCESS)
+      return status;
+   if (n == NULL || !Node_hasPath(n, path) ||
+       k >= Node_getSubtreeSize(n))
+      return NO_SUCH_PATH;
+
+   Node_truncatePath(&nthPath, 0);
+   status = Node_appendName(n, &nthPath);
+   if (status == SUCCESS)
+      status = FT_select(n, k, &nthPath);
+   if (status != SUCCESS)
+      return status;
+   *result = nthPath.text;
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Does the work of FT_rank, as declared in ft.h.
+*/
+static int FT_doRank(char *path, size_t *rank) {
+   Node n;
+   Node parent;
+   size_t before;
+   size_t position = 0;
+   int status;
+
+   FT_CHECK();
+
+   assert(path != NULL);
+   assert(rank != NULL);
+
+   if (!isInitialized)
+      return INITIALIZATION_ERROR;
+
+   status = FT_traversePath(path, &n);
+   if (status != SUCCESS)
+      return status;
+   if (n == NULL || !Node_hasPath(n, path))
+      return NO_SUCH_PATH;
+
+   /* Each ancestor comes before n, and so do the subtrees before the
+      child it leads to n through. */
+   for (parent = Node_getParent(n); parent != NULL;
+        n = parent, parent = Node_getParent(n)) {
+      status = Node_getSizeBefore(parent, n, &before);
+      if (status != SUCCESS)
+         return status;
+      position += 1 + before;
+   }
+   *rank = position;
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Does the work of FT_grep, as declared in ft.h.
+*/
+static int FT_doGrep(char *path, const char *pattern, boolean isRegex,
+                     void (*callback)(const char *path, size_t offset,
+                                      size_t length, void *extra),
+                     void *extra) {
+   Node subtree;
+   int status;
+
+   FT_CHECK();
+
+   assert(path != NULL);
+   assert(pattern != NULL);
+   assert(callback != NULL);
+
+   if (!isInitialized)
+      return INITIALIZATION_ERROR;
+
+   status = FT_traversePath(path, &subtree);
+   if (status != SUCCESS)
+      return status;
+   if (subtree == NULL || !Node_hasPath(subtree, path))
+      return NO_SUCH_PATH;
+
+   return Grep_find(subtree, pattern, isRegex, callback, extra);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Finds where dst, the destination of FT_move or FT_copy, would be:
+   stores the directory it would be in in *parent, and its name, the
+   last component of dst, in *name. Returns SUCCESS, or
+   CONFLICTING_PATH, NOT_A_DIRECTORY, NO_SUCH_PATH or MEMORY_ERROR as
+   FT_move does.
+*/
+static int FT_findDestination(char *dst, Node *parent,
+                              const char **name) {
+   char *parentPath;
+   const char *slash;
+   Node curr;
+   int status;
+
+   assert(dst != NULL);
+   assert(parent != NULL);
+   assert(name != NULL);
+
+   slash = strrchr(dst, '/');
+   if (slash == NULL || slash[1] == '\0')
+      return CONFLICTING_PATH;
+
+   /* Find the directory dst names, the part of dst before slash. */
+   parentPath = malloc((size_t)(slash - dst) + 1);
+   if (parentPath == NULL)
+      return MEMORY_ERROR;
+   strncpy(parentPath, dst, (size_t)(slash - dst));
+   parentPath[slash - dst] = '\0';
+
+   status = FT_traversePath(parentPath, &curr);
+   if (status != SUCCESS) {
+      free(parentPath);
+      return status;
+   }
+   if (curr == NULL) {
+      free(parentPath);
+      return CONFLICTING_PATH;
+   }
+   if (!Node_hasPath(curr, parentPath)) {
+      free(parentPath);
+      return (Node_getType(curr) == FIL) ? NOT_A_DIRECTORY
+                                         : NO_SUCH_PATH;
+   }
+   free(parentPath);
+
+   *parent = curr;
+   *name = slash + 1;
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Does the work of FT_move, as declared in ft.h.
+*/
+static int FT_doMove(char *src, char *dst) {
+   Node n;
+   Node parent;
+   const char *name;
+   int status;
+
+   FT_CHECK();
+
+   assert(src != NULL);
+   assert(dst != NULL);
+
+   if (!isInitialized)
+      return INITIALIZATION_ERROR;
+
+   status = FT_traversePath(src, &n);
+   if (status != SUCCESS)
+      return status;
+   if (n == NULL || !Node_hasPath(n, src))
+      return NO_SUCH_PATH;
+
+   /* The root has no parent to move it from. */
+   if (Node_getParent(n) == NULL)
+      return CONFLICTING_PATH;
+   status = FT_findDestination(dst, &parent, &name);
+   if (status != SUCCESS)
+      return status;
+
+   /* Neither directory may change while a copy still shares it. */
+   status = FT_prepare(Node_getParent(n));
+   if (status == SUCCESS)
+      status = FT_prepare(parent);
+   if (status != SUCCESS)
+      return status;
+
+   /* Only n's name can change, so only it is indexed anew. */
+   if (nameIndex != NULL)
+      NameIndex_remove(nameIndex, n);
+   status = Node_move(n, parent, name);
+   if (nameIndex != NULL && !NameIndex_add(nameIndex, n))
+      FT_dropNameIndex();
+
+   if (status == PARENT_CHILD_ERROR)
+      return CONFLICTING_PATH;
+   return status;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+   Does the work of FT_copy, as declared in ft.h.
+*/
+static int FT_doCopy(char *src, char *dst) {
+   Node n;
+   Node parent;
+   Node copy;
+   const char *name;
+   int status;
+
+   FT_CHECK();
+
+   assert(src != NULL);
+   assert(dst != NULL);
+
+   if (!isInitialized)
+      return INITIALIZATION_ERROR;
+
+   status = FT_traversePath(src, &n);
+   if (status != SUCCESS)
+      return status;
+   if (n == NULL || !Node_hasPath(n, src))
+      return NO_SUCH_PATH;
+
+   status = FT_findDestination(dst, &parent, &name);
+   if (status == SUCCESS)
+      status = FT_prepare(parent);
+   if (status == SUCCESS)
+      status = Node_copy(n, parent, name, &copy);
+   if (status == PARENT_CHILD_ERROR)
+      return CONFLICTING_PATH;
+   if (status != SUCCESS)
+      return status;
+   count += Node_getSubtreeSize(copy);
+
+   /* The indexes hold every Node, so they copy the whole subtree. */
+   if (nameIndex != NULL && !FT_indexAll(copy))
+      FT_dropNameIndex();
+   if (sizeIndex != NULL && !FT_sizeIndexAll(copy))
+      FT_dropSizeIndex();
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+void FT_getCounters(struct Counters *counters) {
+   assert(counters != NULL);
+
+   memcpy(counters, opCounters, sizeof(opCounters));
+}
+
+/*--------------------------------------------------------------------*/
+void FT_resetCounters(void) {
+   memset(opCounters, 0, sizeof(opCounters));
+}
+
+/*--------------------------------------------------------------------*/
+void FT_slowLogSetThreshold(uint64_t nanoseconds) {
+   slowThreshold = nanoseconds;
+}
+
+/*--------------------------------------------------------------------*/
+size_t FT_slowLogRead(struct SlowOp *ops, size_t maxOps) {
+   assert(ops != NULL || maxOps == 0);
+
+   return SlowLog_read(ops, maxOps);
+}
+
+/*--------------------------------------------------------------------*/
+void FT_slowLogDump(int fd) {
+   SlowLog_dump(fd);
+}
+
+/*--------------------------------------------------------------------*/
+boolean FT_slowLogDumpOnSignal(int signum, int fd) {
+   return (boolean)SlowLog_dumpOnSignal(signum, fd);
+}
+
+/*--------------------------------------------------------------------*/
+void FT_slowLogClear(void) {
+   SlowLog_clear();
+}
+
+/*--------------------------------------------------------------------*/
+int FT_insertDir(char *path) {
+   uint64_t start;
+   int result;
+
+   start = FT_nanoseconds();
+   result = FT_doInsertDir(path);
+   FT_finish(FT_OP_INSERT_DIR, result, path, NULL, FALSE, 0, result,
+             start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_insertFile(char *path, void *contents, size_t length) {
+   uint64_t start;
+   int result;
+
+   start = FT_nanoseconds();
+   result = FT_doInsertFile(path, contents, length);
+   FT_finish(FT_OP_INSERT_FILE, result, path, NULL,
+             (boolean)(contents != NULL), length, result, start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+boolean FT_containsDir(char *path) {
+   uint64_t start;
+   boolean result;
+
+   start = FT_nanoseconds();
+   result = FT_doContainsDir(path);
+   FT_finish(FT_OP_CONTAINS_DIR,
+             FT_statusOf(result, NO_SUCH_PATH), path, NULL, FALSE, 0,
+             result, start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+boolean FT_containsFile(char *path) {
+   uint64_t start;
+   boolean result;
+
+   start = FT_nanoseconds();
+   result = FT_doContainsFile(path);
+   FT_finish(FT_OP_CONTAINS_FILE,
+             FT_statusOf(result, NO_SUCH_PATH), path, NULL, FALSE, 0,
+             result, start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+void *FT_getFileContents(char *path) {
+   uint64_t start;
+   void *result;
+
+   start = FT_nanoseconds();
+   result = FT_doGetFileContents(path);
+   FT_finish(FT_OP_GET_CONTENTS,
+             FT_statusOf((boolean)(result != NULL), NO_SUCH_PATH),
+             path, NULL, FALSE, 0, result != NULL, start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+void *FT_replaceFileContents(char *path, void *newContents,
+                             size_t newLength) {
+   uint64_t start;
+   void *result;
+
+   start = FT_nanoseconds();
+   result = FT_doReplaceFileContents(path, newContents, newLength);
+   FT_finish(FT_OP_REPLACE_CONTENTS,
+             FT_statusOf((boolean)(result != NULL), NO_SUCH_PATH),
+             path, NULL, (boolean)(newContents != NULL), newLength,
+             result != NULL, start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_rmDir(char *path) {
+   uint64_t start;
+   int result;
+
+   start = FT_nanoseconds();
+   result = FT_doRmDir(path);
+   FT_finish(FT_OP_RM_DIR, result, path, NULL, FALSE, 0, result,
+             start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_rmFile(char *path) {
+   uint64_t start;
+   int result;
+
+   start = FT_nanoseconds();
+   result = FT_doRmFile(path);
+   FT_finish(FT_OP_RM_FILE, result, path, NULL, FALSE, 0, result,
+             start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_stat(char *path, boolean *type, size_t *length) {
+   uint64_t start;
+   int result;
+
+   start = FT_nanoseconds();
+   result = FT_doStat(path, type, length);
+   FT_finish(FT_OP_STAT, result, path, NULL, FALSE,
+             (result == SUCCESS && *type) ? *length : 0, result, start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_move(char *src, char *dst) {
+   uint64_t start;
+   int result;
+
+   start = FT_nanoseconds();
+   result = FT_doMove(src, dst);
+   FT_finish(FT_OP_MOVE, result, src, dst, FALSE, 0, result, start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_copy(char *src, char *dst) {
+   uint64_t start;
+   int result;
+
+   start = FT_nanoseconds();
+   result = FT_doCopy(src, dst);
+   FT_finish(FT_OP_COPY, result, src, dst, FALSE, 0, result, start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_init(void) {
+   uint64_t start;
+   int result;
+
+   start = FT_nanoseconds();
+   result = FT_doInit();
+   FT_finish(FT_OP_INIT, result, NULL, NULL, FALSE, 0, result,
+             start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_destroy(void) {
+   uint64_t start;
+   int result;
+
+   start = FT_nanoseconds();
+   result = FT_doDestroy();
+   FT_finish(FT_OP_DESTROY, result, NULL, NULL, FALSE, 0, result,
+             start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+char *FT_toString(void) {
+   uint64_t start;
+   char *result;
+
+   start = FT_nanoseconds();
+   result = FT_doToString();
+   FT_finish(FT_OP_TO_STRING,
+             FT_statusOf((boolean)(result != NULL), MEMORY_ERROR),
+             NULL, NULL, FALSE, (result == NULL) ? 0 : strlen(result),
+             result != NULL, start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_glob(const char *pattern,
+            void (*callback)(const char *path, boolean isFile,
+                             void *extra),
+            void *extra) {
+   uint64_t start;
+   int result;
+
+   start = FT_nanoseconds();
+   result = FT_doGlob(pattern, callback, extra);
+   FT_finish(FT_OP_GLOB, result, pattern, NULL, FALSE, 0, result,
+             start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_listDir(char *path, struct FT_Entry *entries, size_t maxEntries,
+               size_t *cursor, size_t *numEntries) {
+   uint64_t start;
+   int result;
+
+   start = FT_nanoseconds();
+   result = FT_doListDir(path, entries, maxEntries, cursor,
+                         numEntries);
+   FT_finish(FT_OP_LIST_DIR, result, path, NULL, FALSE, 0, result,
+             start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_statEx(char *path, struct FT_Stat *stat) {
+   uint64_t start;
+   int result;
+
+   start = FT_nanoseconds();
+   result = FT_doStatEx(path, stat);
+   FT_finish(FT_OP_STAT_EX, result, path, NULL, FALSE, 0, result,
+             start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_findByName(const char *name,
+                  void (*callback)(const char *path, boolean isFile,
+                                   void *extra),
+                  void *extra) {
+   uint64_t start;
+   int result;
+
+   start = FT_nanoseconds();
+   result = FT_doFindByName(name, FALSE, callback, extra);
+   FT_finish(FT_OP_FIND_BY_NAME, result, name, NULL, FALSE, 0,
+             result, start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_findByNamePrefix(const char *prefix,
+                        void (*callback)(const char *path,
+                                         boolean isFile, void *extra),
+                        void *extra) {
+   uint64_t start;
+   int result;
+
+   start = FT_nanoseconds();
+   result = FT_doFindByName(prefix, TRUE, callback, extra);
+   FT_finish(FT_OP_FIND_BY_NAME_PREFIX, result, prefix, NULL, FALSE,
+             0, result, start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_scanRange(const char *lo, const char *hi,
+                 void (*callback)(const char *path, boolean isFile,
+                                  void *extra),
+                 void *extra) {
+   uint64_t start;
+   int result;
+
+   start = FT_nanoseconds();
+   result = FT_doScanRange(lo, hi, callback, extra);
+   FT_finish(FT_OP_SCAN_RANGE, result, lo, NULL, FALSE, 0, result,
+             start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_grep(char *path, const char *pattern, boolean isRegex,
+            void (*callback)(const char *path, size_t offset,
+                             size_t length, void *extra),
+            void *extra) {
+   uint64_t start;
+   int result;
+
+   start = FT_nanoseconds();
+   result = FT_doGrep(path, pattern, isRegex, callback, extra);
+   FT_finish(FT_OP_GREP, result, path, NULL, FALSE, 0, result,
+             start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_filesBySize(size_t min, size_t max,
+                   void (*callback)(const char *path, size_t length,
+                                    void *extra),
+                   void *extra) {
+   uint64_t start;
+   int result;
+
+   start = FT_nanoseconds();
+   result = FT_doFilesBySize(min, max, callback, extra);
+   FT_finish(FT_OP_FILES_BY_SIZE, result, NULL, NULL, FALSE, 0,
+             result, start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_largestFiles(size_t k,
+                    void (*callback)(const char *path, size_t length,
+                                     void *extra),
+                    void *extra) {
+   uint64_t start;
+   int result;
+
+   start = FT_nanoseconds();
+   result = FT_doLargestFiles(k, callback, extra);
+   FT_finish(FT_OP_LARGEST_FILES, result, NULL, NULL, FALSE, 0,
+             result, start);
+   return result;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_nth(char *path, size_t k, const char **result) {
+   uint64_t start;
+   int status;
+
+   start = FT_nanoseconds();
+   status = FT_doNth(path, k, result);
+   FT_finish(FT_OP_NTH, status, path, NULL, FALSE, 0, status, start);
+   return status;
+}
+
+/*--------------------------------------------------------------------*/
+int FT_rank(char *path, size_t *rank) {
+   uint64_t start;
+   int result;
 
+   start = FT_nanoseconds();
+   result = FT_doRank(path, rank);
+   FT_finish(FT_OP_RANK, result, path, NULL, FALSE, 0, result,
+             start);
    return result;
 }
@@ -13,8 +13,22 @@
 */
 
 #include <stddef.h>
+#include <stdint.h>
 #include "a4def.h"
 
+/* Identifiers of the FT functions, in traces and stats. Calls of
+   those from FT_NUM_TRACED_OPS on, which report what they find
+   through callbacks and buffers, are counted but not traced. */
+enum { FT_OP_INIT, FT_OP_DESTROY, FT_OP_INSERT_DIR, FT_OP_INSERT_FILE,
+       FT_OP_CONTAINS_DIR, FT_OP_CONTAINS_FILE, FT_OP_RM_DIR,
+       FT_OP_RM_FILE, FT_OP_GET_CONTENTS, FT_OP_REPLACE_CONTENTS,
+       FT_OP_STAT, FT_OP_TO_STRING, FT_OP_MOVE, FT_OP_COPY,
+       FT_NUM_TRACED_OPS,
+       FT_OP_GLOB = FT_NUM_TRACED_OPS, FT_OP_LIST_DIR, FT_OP_STAT_EX,
+       FT_OP_FIND_BY_NAME, FT_OP_FIND_BY_NAME_PREFIX, FT_OP_SCAN_RANGE,
+       FT_OP_GREP, FT_OP_FILES_BY_SIZE, FT_OP_LARGEST_FILES, FT_OP_NTH,
+       FT_OP_RANK, FT_NUM_OPS };
+
 /*
    Inserts a new directory into the tree at path, if possible.
    Returns SUCCESS if the new directory is inserted,
@@ -38,6 +52,8 @@ boolean FT_containsDir(char *path);
   Returns INITIALIZATION_ERROR if not in an initialized state.
   Returns NOT_A_DIRECTORY if path exists but is a file not a directory.
   Returns NO_SUCH_PATH if the path does not exist in the hierarchy.
+  Returns MEMORY_ERROR if a copy made by FT_copy must first be given
+  its own children, and memory for them cannot be allocated.
 */
 int FT_rmDir(char *path);
 
@@ -67,6 +83,8 @@ boolean FT_containsFile(char *path);
   Returns INITIALIZATION_ERROR if not in an initialized state.
   Returns NOT_A_FILE if path exists but is a directory not a file.
   Returns NO_SUCH_PATH if the path does not exist in the hierarchy.
+  Returns MEMORY_ERROR if a copy made by FT_copy must first be given
+  its own children, and memory for them cannot be allocated.
 */
 int FT_rmFile(char *path);
 
@@ -83,7 +101,9 @@ void *FT_getFileContents(char *path);
   Replaces current contents of the file at the full path parameter with
   the parameter newContents of size newLength.
   Returns the old contents if successful.
-  Returns NULL if the path does not already exist or is a directory.
+  Returns NULL if the path does not already exist or is a directory,
+  or if a copy made by FT_copy must first be given its own children,
+  and memory for them cannot be allocated.
 */
 void *FT_replaceFileContents(char *path, void *newContents,
                              size_t newLength);
@@ -128,4 +148,421 @@ int FT_destroy(void);
 */
 char *FT_toString(void);
 
+/*
+  Starts recording every call of an FT function that changes or
+  probes the hierarchy, those with an FT_OP_ value below
+  FT_NUM_TRACED_OPS, to a new binary trace file at filename,
+  replacing any trace already being recorded. Each record holds the
+  function, its paths, its content length, its result and how long it
+  took; see trace.h for the format.
+  Returns TRUE if the file is opened and FALSE otherwise.
+
+  Recording is independent of initialization: calls made before
+  FT_init are recorded too.
+*/
+boolean FT_traceOpen(const char *filename);
+
+/*
+  Stops recording, closing the trace file.
+  Returns TRUE if every record was written, and FALSE if
+  no trace was open or a write failed, in which case the trace
+  ends at the failed record.
+*/
+boolean FT_traceClose(void);
+
+/* The counts of FT function calls, declared in stats.h. */
+struct Stats;
+
+/*
+  Stores in *stats, for each FT function, the number of calls, the
+  number that ended in each status, and a histogram of their
+  latencies, counted since the program started or FT_resetStats was
+  last called. Calls from every thread are counted; see stats.h for
+  the layout and for reading quantiles from the histograms.
+
+  Counting is independent of initialization: calls made before
+  FT_init are counted too.
+*/
+void FT_getStats(struct Stats *stats);
+
+/*
+  Sets the counts returned by FT_getStats to zero.
+*/
+void FT_resetStats(void);
+
+/* The shape of a File Tree, declared in shape.h. */
+struct ShapeStats;
+
+/*
+  Stores in *stats the shape of the hierarchy: the directories and
+  files at each depth, a histogram of the number of children of the
+  directories at each depth, the largest directories, and histograms
+  of path lengths and of file content lengths, all from one traversal.
+  If maxChildren is 0, every node is visited and the counts are exact.
+  Otherwise at most maxChildren children of each directory are
+  visited, and the counts are estimates from that sample.
+  Returns SUCCESS if successful,
+  returns INITIALIZATION_ERROR if the structure is not initialized,
+  and returns MEMORY_ERROR if unable to allocate sufficient memory, in
+  which case *stats is incomplete.
+
+  The paths of the largest directories are only valid until
+  FT_shapeStats is next called.
+*/
+int FT_shapeStats(struct ShapeStats *stats, size_t maxChildren);
+
+/*
+  Calls callback with each path in the hierarchy that matches pattern,
+  with whether it is a file, and with extra. Within each '/'-separated
+  component of pattern, '*' matches any characters, '?' any one
+  character, "[...]" any one character of a class such as [a-z] or
+  [!0-9], and '\' makes the next character literal; a component that
+  is exactly "**" matches any number of components, including none.
+  Paths are reported in pre-order, files before directories, and
+  subtrees that cannot match are not visited. callback must not change
+  the hierarchy.
+  Returns SUCCESS if every match is reported,
+  returns INITIALIZATION_ERROR if the structure is not initialized, and
+  returns MEMORY_ERROR if unable to allocate sufficient memory, in
+  which case only some matches may have been reported.
+*/
+int FT_glob(const char *pattern,
+            void (*callback)(const char *path, boolean isFile,
+                             void *extra),
+            void *extra);
+
+/* One entry of a directory listing. */
+struct FT_Entry {
+   /* The entry's name within its directory, which belongs to the
+      hierarchy and is only valid until it next changes. */
+   const char *name;
+   /* TRUE if the entry is a file, FALSE if it is a directory. */
+   boolean isFile;
+   /* The length of a file's contents, or 0 for a directory. */
+   size_t length;
+};
+
+/*
+  Stores in entries, an array of maxEntries elements, the entries of
+  the directory at path from the one numbered *cursor on, in the order
+  files first and then directories, each sorted by name. Stores the
+  number stored in *numEntries, and advances *cursor past them, so
+  that starting *cursor at 0 and calling again until *numEntries is
+  less than
+  maxEntries lists the whole directory. Costs one lookup of path plus
+  the entries stored, whatever the size of the hierarchy. The
+  numbering shifts if the directory changes between calls.
+  Returns SUCCESS if path is a directory,
+  returns INITIALIZATION_ERROR if the structure is not initialized,
+  returns NO_SUCH_PATH if path does not exist in the hierarchy,
+  returns NOT_A_DIRECTORY if path is a file, and
+  returns MEMORY_ERROR if unable to allocate sufficient memory.
+  *numEntries is 0 and *cursor is unchanged when returning a
+  non-SUCCESS status.
+*/
+int FT_listDir(char *path, struct FT_Entry *entries, size_t maxEntries,
+               size_t *cursor, size_t *numEntries);
+
+/* What FT_statEx reports about a path. */
+struct FT_Stat {
+   /* TRUE if the path is a file, FALSE if it is a directory. */
+   boolean isFile;
+   /* The length of a file's contents, or 0 for a directory. */
+   size_t length;
+   /* The files and directories anywhere below a directory, and the
+      total length of those files. For a file, 0, 0 and its length. */
+   size_t files;
+   size_t dirs;
+   size_t bytes;
+};
+
+/*
+  Stores in *stat what FT_stat reports about path, along with the
+  number of files and directories anywhere below it and the total
+  length of their contents. The totals are kept up to date as the
+  hierarchy changes, so this costs one lookup of path, whatever the
+  size of the subtree below it.
+  Returns SUCCESS if path exists in the hierarchy,
+  returns NO_SUCH_PATH if it does not, and
+  returns INITIALIZATION_ERROR if the structure is not initialized.
+  *stat is unchanged when returning a non-SUCCESS status.
+*/
+int FT_statEx(char *path, struct FT_Stat *stat);
+
+/*
+  Starts keeping an index from each name, the last component of a
+  path, to the paths with that name, if enable is TRUE, and stops
+  keeping it otherwise. The index is built from the hierarchy as it
+  stands, kept up to date as paths are inserted and removed, and
+  kept across FT_destroy and FT_init. It makes FT_findByName and
+  FT_findByNamePrefix cost a binary search plus the paths found,
+  rather than a traversal of the whole hierarchy, at the cost of
+  memory and of some time on every insertion and removal. If the
+  index cannot grow as the hierarchy does, it is dropped.
+  Returns SUCCESS if successful and MEMORY_ERROR if unable to
+  allocate sufficient memory, in which case no index is kept.
+*/
+int FT_nameIndexEnable(boolean enable);
+
+/*
+  Calls callback with each path in the hierarchy whose last component
+  is name, with whether it is a file, and with extra. callback must
+  not change the hierarchy. The order of the paths is unspecified.
+  Returns SUCCESS if every path is reported,
+  returns INITIALIZATION_ERROR if the structure is not initialized,
+  and returns MEMORY_ERROR if unable to allocate sufficient memory, in
+  which case only some paths may have been reported.
+*/
+int FT_findByName(const char *name,
+                  void (*callback)(const char *path, boolean isFile,
+                                   void *extra),
+                  void *extra);
+
+/*
+  Calls callback, as FT_findByName does, with each path in the
+  hierarchy whose last component starts with prefix, and returns
+  the same statuses.
+*/
+int FT_findByNamePrefix(const char *prefix,
+                        void (*callback)(const char *path,
+                                         boolean isFile, void *extra),
+                        void *extra);
+
+/*
+  Starts keeping an index of the files in the hierarchy ordered by
+  length, if enable is TRUE, and stops keeping it otherwise. Like the
+  index by name, it is built from the hierarchy as it stands, kept up
+  to date as files are inserted, removed and given new contents, and
+  kept across FT_destroy and FT_init, and it is dropped if it cannot
+  grow. It makes FT_filesBySize and FT_largestFiles cost a search of
+  O(log n) expected steps plus the files found, rather than a
+  traversal of the whole hierarchy and a sort.
+  Returns SUCCESS if successful and MEMORY_ERROR if unable to
+  allocate sufficient memory, in which case no index is kept.
+*/
+int FT_sizeIndexEnable(boolean enable);
+
+/*
+  Calls callback with the path and length of each file in the
+  hierarchy whose length is from min to max, inclusive, and with
+  extra, in increasing order of length; the order of files of equal
+  length is unspecified. callback must not change the hierarchy.
+  Returns SUCCESS if every file is reported,
+  returns INITIALIZATION_ERROR if the structure is not initialized,
+  and returns MEMORY_ERROR if unable to allocate sufficient memory,
+  in which case no file is reported without the index, and only some
+  may have been with it.
+*/
+int FT_filesBySize(size_t min, size_t max,
+                   void (*callback)(const char *path, size_t length,
+                                    void *extra),
+                   void *extra);
+
+/*
+  Calls callback, as FT_filesBySize does, with the k longest files in
+  the hierarchy, or all of them if there are fewer, in decreasing
+  order of length.
+  Returns SUCCESS if every file is reported,
+  returns INITIALIZATION_ERROR if the structure is not initialized,
+  and returns MEMORY_ERROR if unable to allocate sufficient memory,
+  in which case no file is reported without the index, and only some
+  may have been with it.
+*/
+int FT_largestFiles(size_t k,
+                    void (*callback)(const char *path, size_t length,
+                                     void *extra),
+                    void *extra);
+
+/*
+  Calls callback with each path in the hierarchy that is not less
+  than lo and is less than hi, with whether it is a file, and with
+  extra, in increasing order. Paths are ordered as strcmp orders them
+  but with '/' less than every other character, so that they compare
+  component by component and each directory comes just before the
+  paths below it. A NULL lo or hi is no bound. The scan goes straight
+  to lo by binary search at each level, and stops at hi, so it visits
+  only the paths in the range and their ancestors. callback must not
+  change the hierarchy.
+  Returns SUCCESS if every path in the range is reported,
+  returns INITIALIZATION_ERROR if the structure is not initialized,
+  and returns MEMORY_ERROR if unable to allocate sufficient memory, in
+  which case the scan stops there.
+*/
+int FT_scanRange(const char *lo, const char *hi,
+                 void (*callback)(const char *path, boolean isFile,
+                                  void *extra),
+                 void *extra);
+
+/*
+  Stores in *result the path of the k'th node, counting from 0, of
+  the subtree rooted at path in pre-order, files before directories,
+  as FT_toString lists them, so that k = 0 gives path itself. Each
+  directory keeps the number of nodes in the subtrees before each of
+  its children, up to date as nodes are inserted and removed, so the
+  node is found by one binary search per level below path. The
+  path is only valid until FT_nth or FT_destroy is next called.
+  Directory order within one directory is paged by FT_listDir.
+  Returns SUCCESS if successful,
+  returns INITIALIZATION_ERROR if the structure is not initialized,
+  returns NO_SUCH_PATH if path is not in the hierarchy or its subtree
+  has no more than k nodes, and
+  returns MEMORY_ERROR if unable to allocate sufficient memory.
+  *result is unchanged when returning a non-SUCCESS status.
+*/
+int FT_nth(char *path, size_t k, const char **result);
+
+/*
+  Stores in *rank the position of path among all the paths of the
+  hierarchy in pre-order, counting from 0, as FT_nth counts from the
+  root, adding up the counts FT_nth uses along path's ancestors.
+  Returns SUCCESS if successful,
+  returns INITIALIZATION_ERROR if the structure is not initialized,
+  returns NO_SUCH_PATH if path is not in the hierarchy, and
+  returns MEMORY_ERROR if unable to allocate sufficient memory.
+  *rank is unchanged when returning a non-SUCCESS status.
+*/
+int FT_rank(char *path, size_t *rank);
+
+/*
+  Searches the contents of every file in the subtree rooted at path,
+  which may itself be a file, for pattern, and calls callback with the
+  path of each file that matches, the offset and length in bytes of
+  its leftmost match, and extra. pattern is literal unless isRegex is
+  TRUE, in which case '.' matches any character but a newline, '*'
+  repeats the character before it, '\' makes the next character
+  literal, and a leading '^' and a trailing '$' match the start and
+  end of a line. Files are searched in parallel, but reported in
+  pre-order, files before directories, as FT_toString lists them.
+  callback must not change the hierarchy.
+  Returns SUCCESS if every match is reported,
+  returns INITIALIZATION_ERROR if the structure is not initialized,
+  returns NO_SUCH_PATH if path is not in the hierarchy, and
+  returns MEMORY_ERROR if unable to allocate sufficient memory, in
+  which case no match is reported.
+*/
+int FT_grep(char *path, const char *pattern, boolean isRegex,
+            void (*callback)(const char *path, size_t offset,
+                             size_t length, void *extra),
+            void *extra);
+
+/*
+  Moves the node at src, and the whole subtree below it, to dst, which
+  may give it a new name, a new parent directory, or both. Nodes keep
+  only their own names, and build their paths from their parents'
+  when next asked for them, so a move unlinks one node from its
+  parent's children and links it into its new parent's, whatever the
+  size of the subtree, and each path below it is rebuilt once, when
+  it is next used.
+  Returns SUCCESS if successful,
+  returns INITIALIZATION_ERROR if the structure is not initialized,
+  returns NO_SUCH_PATH if src is not in the hierarchy, or if dst's
+  parent is not though a prefix of it is,
+  returns CONFLICTING_PATH if src is the root, if dst is not below the
+  root, or if dst is below src,
+  returns NOT_A_DIRECTORY if dst's parent is a file,
+  returns ALREADY_IN_TREE if dst is already in the hierarchy, src
+  included, and
+  returns MEMORY_ERROR if unable to allocate sufficient memory, in
+  which case the hierarchy is unchanged.
+*/
+int FT_move(char *src, char *dst);
+
+/*
+  Copies the node at src, and the whole subtree below it, to dst, as
+  FT_move would move it there, leaving src as it is. The copy is
+  lazy: a copied directory records the directory it copies, and gets
+  its own children, each a copy in turn, only when a path below it is
+  looked up, or when it or the directory it copies is about to
+  change. Listings, searches and FT_toString read a copy through the
+  directory it copies instead, and leave it lazy. So a copy costs one
+  node however large the subtree, and copying a skeleton tree many
+  times costs only the parts of it later used.
+  File contents are shared with src, as the client owns them. If an
+  index of FT_nameIndexEnable or FT_sizeIndexEnable is kept, the whole
+  copy is made at once, since the index lists every node.
+  Returns SUCCESS if successful,
+  returns INITIALIZATION_ERROR if the structure is not initialized,
+  returns NO_SUCH_PATH if src is not in the hierarchy, or if dst's
+  parent is not though a prefix of it is,
+  returns CONFLICTING_PATH if dst is not below the root, or if dst is
+  below src,
+  returns NOT_A_DIRECTORY if dst's parent is a file,
+  returns ALREADY_IN_TREE if dst is already in the hierarchy, and
+  returns MEMORY_ERROR if unable to allocate sufficient memory, in
+  which case the hierarchy is unchanged.
+*/
+int FT_copy(char *src, char *dst);
+
+/* The work counters of path lookups, declared in counters.h. */
+struct Counters;
+struct Explain;
+
+/*
+  Looks up path as the other FT functions do, storing in *explain the
+  work the lookup took: the nodes it descended through, the elements
+  its binary searches probed, the strings it compared and the bytes
+  they read, and the blocks it allocated. Also stores how many
+  components of path matched, and which directory's search for a
+  child read the most bytes.
+  Returns SUCCESS if path exists in the hierarchy,
+  returns NO_SUCH_PATH if it does not, and
+  returns INITIALIZATION_ERROR if the structure is not initialized.
+
+  Work is only counted in builds with -DFT_COUNTERS; otherwise every
+  count in *explain is 0.
+*/
+int FT_explain(char *path, struct Explain *explain);
+
+/*
+  Stores in counters, an array of FT_NUM_OPS elements indexed by
+  FT_OP_ value, the total work counted by each FT function's calls
+  since the program started or FT_resetCounters was last called.
+  Every count is 0 unless built with -DFT_COUNTERS.
+*/
+void FT_getCounters(struct Counters *counters);
+
+/*
+  Sets the totals returned by FT_getCounters to zero.
+*/
+void FT_resetCounters(void);
+
+/* A logged slow call, declared in slowlog.h. */
+struct SlowOp;
+
+/*
+  Logs every later FT function call that takes at least nanoseconds,
+  with its function, path, status, duration and the nodes its path
+  lookups descended through, or stops logging if nanoseconds is 0,
+  as it is when the program starts. The log keeps the last
+  SLOWLOG_SIZE calls logged; see slowlog.h.
+
+  Logging is independent of initialization: calls made before
+  FT_init are logged too.
+*/
+void FT_slowLogSetThreshold(uint64_t nanoseconds);
+
+/*
+  Copies the logged calls, oldest first, to ops, an array of maxOps
+  elements. Returns the number copied.
+*/
+size_t FT_slowLogRead(struct SlowOp *ops, size_t maxOps);
+
+/*
+  Writes the logged calls, oldest first, one per line, to the file
+  descriptor fd. Is safe to call from a signal handler.
+*/
+void FT_slowLogDump(int fd);
+
+/*
+  Makes the signal signum write the logged calls to the file
+  descriptor fd, as FT_slowLogDump does.
+  Returns TRUE if the handler is installed and FALSE otherwise.
+*/
+boolean FT_slowLogDumpOnSignal(int signum, int fd);
+
+/*
+  Empties the log.
+*/
+void FT_slowLogClear(void);
+
 #endif
@@ -0,0 +1,896 @@
+/*--------------------------------------------------------------------*/
+/* ft_bench.c                                                         */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <math.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ft.h"
+#include "shape.h"
+#include "stats.h"
+
+/*--------------------------------------------------------------------*/
+/* The FT operations whose latencies are reported. */
+enum { OP_INSERT_DIR, OP_INSERT_FILE, OP_CONTAINS_DIR,
+       OP_CONTAINS_FILE, OP_STAT, OP_GET_CONTENTS, OP_REPLACE_CONTENTS,
+       OP_RM_DIR, OP_RM_FILE, OP_TO_STRING, NUM_OPS };
+
+/* Printable names of the reported operations. */
+static const char *opNames[NUM_OPS] = {
+   "FT_insertDir", "FT_insertFile", "FT_containsDir",
+   "FT_containsFile", "FT_stat", "FT_getFileContents",
+   "FT_replaceFileContents", "FT_rmDir", "FT_rmFile", "FT_toString"
+};
+
+/* The kinds of request in the mixed workload. Each kind is served by
+   one or two of the operations above, by the type of its target. */
+enum { KIND_CONTAINS, KIND_STAT, KIND_GET, KIND_REPLACE, KIND_INSERT,
+       KIND_REMOVE, KIND_TO_STRING, NUM_KINDS };
+
+/* The argument names of the workload weights, by kind. */
+static const char *kindNames[NUM_KINDS] = {
+   "contains", "stat", "get", "replace", "insert", "remove", "tostring"
+};
+
+/* The ways the number of children of a directory is drawn. */
+enum { SPREAD_FIXED, SPREAD_UNIFORM, SPREAD_GEOMETRIC, NUM_SPREADS };
+
+/* The argument values of the fan-out spreads. */
+static const char *spreadNames[NUM_SPREADS] = {
+   "fixed", "uniform", "geometric"
+};
+
+/* How many times a target of the wanted type is redrawn before the
+   request settles for whatever it drew. */
+enum { MAX_REDRAWS = 8 };
+
+/* The largest contents length given to a file. */
+enum { MAX_CONTENTS_LENGTH = 4096 };
+
+/* The path of the root directory of the synthetic tree. */
+static const char *ROOT_NAME = "root";
+
+/*--------------------------------------------------------------------*/
+/* The parameters of a run, set from name=value arguments. */
+struct Config {
+   /* The number of nodes in the tree built before the workload. */
+   size_t nodes;
+   /* The greatest depth of a node; the root is at depth 0. */
+   size_t depth;
+   /* The mean number of children given to a directory. */
+   size_t fanout;
+   /* How the number of children is drawn around the mean. */
+   int spread;
+   /* The fraction of new nodes that are files. */
+   double files;
+   /* The mean length of the random part of each name. */
+   size_t name;
+   /* The number of requests in the mixed workload. */
+   size_t ops;
+   /* The Zipf exponent of target popularity; 0 is uniform. */
+   double skew;
+   /* The seed of the random number generator. */
+   unsigned long seed;
+   /* The relative weight of each kind of request. */
+   unsigned long weights[NUM_KINDS];
+   /* The children sampled per directory by the report of the built
+      tree's shape, 0 for all, or -1 for no report. */
+   long shape;
+   /* The nanoseconds from which calls are logged as slow, or 0. */
+   uint64_t slow;
+};
+
+/* A growable list of paths kept in one block of text, with each
+   path's type and depth. */
+struct Paths {
+   /* The text of all paths, each followed by '\0'. */
+   char *text;
+   size_t textLength;
+   size_t textSize;
+   /* The offset in text of each path. */
+   size_t *offsets;
+   /* The type (DIR or FIL) and depth of each path. */
+   unsigned char *types;
+   unsigned char *depths;
+   size_t length;
+   size_t size;
+};
+
+/* The state of the Zipf generator over a population of n items. */
+struct Zipf {
+   size_t n;
+   double theta;
+   double alpha;
+   double zetan;
+   double eta;
+};
+
+/* The type values stored in struct Paths. */
+enum { DIR, FIL };
+
+/*--------------------------------------------------------------------*/
+/* The state of the random number generator. */
+static uint64_t randomState = 217;
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the current time in nanoseconds from a monotonic clock.
+*/
+static uint64_t Bench_nanoseconds(void) {
+   struct timespec now;
+
+   (void)clock_gettime(CLOCK_MONOTONIC, &now);
+   return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the next 64 random bits, by xorshift64*.
+*/
+static uint64_t Bench_random(void) {
+   randomState ^= randomState >> 12;
+   randomState ^= randomState << 25;
+   randomState ^= randomState >> 27;
+   return randomState * UINT64_C(2685821657736338717);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns a random number uniform in [0, 1).
+*/
+static double Bench_uniform(void) {
+   return (double)(Bench_random() >> 11) / 9007199254740992.0;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns a random number uniform in [0, uBound), or 0 if uBound is 0.
+*/
+static size_t Bench_below(size_t uBound) {
+   if (uBound == 0)
+      return 0;
+   return (size_t)(Bench_random() % uBound);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Prints the title, then one row for each operation in asHists that
+  was called: its count, its throughput counting only the time spent
+  in it, and its p50, p99, p999 and greatest latencies.
+*/
+static void Bench_report(const char *title,
+                         const struct OpStats asHists[NUM_OPS]) {
+   int op;
+   const struct OpStats *psHist;
+
+   assert(title != NULL);
+
+   printf("\n%s\n", title);
+   printf("%-24s %10s %12s %10s %10s %10s %10s\n", "operation",
+          "count", "ops/s", "p50(ns)", "p99(ns)", "p999(ns)",
+          "max(ns)");
+   for (op = 0; op < NUM_OPS; op++) {
+      psHist = &asHists[op];
+      if (psHist->calls == 0)
+         continue;
+      printf("%-24s %10lu %12.0f %10lu %10lu %10lu %10lu\n",
+             opNames[op], (unsigned long)psHist->calls,
+             (double)psHist->calls * 1e9 /
+             (double)(psHist->totalNanoseconds ?
+                      psHist->totalNanoseconds : 1),
+             (unsigned long)Stats_quantile(psHist, 0.50),
+             (unsigned long)Stats_quantile(psHist, 0.99),
+             (unsigned long)Stats_quantile(psHist, 0.999),
+             (unsigned long)psHist->maxNanoseconds);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the path at index uIndex of *psPaths.
+*/
+static char *Paths_get(struct Paths *psPaths, size_t uIndex) {
+   assert(psPaths != NULL);
+   assert(uIndex < psPaths->length);
+
+   return psPaths->text + psPaths->offsets[uIndex];
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Appends to *psPaths the path of the child named name under the path
+  at index uParent of *psParents, or the path name itself if psParents
+  is NULL, with the given type and depth. psParents may be psPaths.
+  Returns 1 if successful, 0 if there is an allocation error.
+*/
+static int Paths_add(struct Paths *psPaths, struct Paths *psParents,
+                     size_t uParent, const char *name, int type,
+                     size_t depth) {
+   size_t uParentLength = 0;
+   size_t uNeeded;
+   size_t uNewSize;
+   char *end;
+   void *pvNew;
+
+   assert(psPaths != NULL);
+   assert(name != NULL);
+
+   if (psParents != NULL)
+      uParentLength = strlen(Paths_get(psParents, uParent)) + 1;
+   uNeeded = uParentLength + strlen(name) + 1;
+
+   if (psPaths->textLength + uNeeded > psPaths->textSize) {
+      uNewSize = 2 * psPaths->textSize + uNeeded;
+      pvNew = realloc(psPaths->text, uNewSize);
+      if (pvNew == NULL)
+         return 0;
+      psPaths->text = pvNew;
+      psPaths->textSize = uNewSize;
+   }
+
+   if (psPaths->length == psPaths->size) {
+      uNewSize = 2 * psPaths->size + 16;
+      pvNew = realloc(psPaths->offsets, uNewSize * sizeof(size_t));
+      if (pvNew == NULL)
+         return 0;
+      psPaths->offsets = pvNew;
+      pvNew = realloc(psPaths->types, uNewSize);
+      if (pvNew == NULL)
+         return 0;
+      psPaths->types = pvNew;
+      pvNew = realloc(psPaths->depths, uNewSize);
+      if (pvNew == NULL)
+         return 0;
+      psPaths->depths = pvNew;
+      psPaths->size = uNewSize;
+   }
+
+   /* Find the parent's path only now, as the text may have moved. */
+   end = psPaths->text + psPaths->textLength;
+   if (psParents != NULL) {
+      memcpy(end, Paths_get(psParents, uParent), uParentLength - 1);
+      end[uParentLength - 1] = '/';
+   }
+   strcpy(end + uParentLength, name);
+
+   psPaths->offsets[psPaths->length] = psPaths->textLength;
+   psPaths->types[psPaths->length] = (unsigned char)type;
+   psPaths->depths[psPaths->length] = (unsigned char)depth;
+   psPaths->length++;
+   psPaths->textLength += uNeeded;
+
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Removes the path at index uIndex of *psPaths by moving the last path
+  into its place. The text of the path is not reclaimed.
+*/
+static void Paths_remove(struct Paths *psPaths, size_t uIndex) {
+   assert(psPaths != NULL);
+   assert(uIndex < psPaths->length);
+
+   psPaths->length--;
+   psPaths->offsets[uIndex] = psPaths->offsets[psPaths->length];
+   psPaths->types[uIndex] = psPaths->types[psPaths->length];
+   psPaths->depths[uIndex] = psPaths->depths[psPaths->length];
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Frees the memory held by *psPaths.
+*/
+static void Paths_free(struct Paths *psPaths) {
+   assert(psPaths != NULL);
+
+   free(psPaths->text);
+   free(psPaths->offsets);
+   free(psPaths->types);
+   free(psPaths->depths);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Sets up *psZipf to draw ranks in [0, n) with probability
+  proportional to 1/(rank+1)^theta, for theta in [0, 1). Takes time
+  linear in n, once. Uses the method of Gray et al., "Quickly
+  Generating Billion-Record Synthetic Databases".
+*/
+static void Zipf_init(struct Zipf *psZipf, size_t n, double theta) {
+   double zeta2;
+   size_t i;
+
+   assert(psZipf != NULL);
+   assert(n > 0);
+   assert(theta >= 0.0 && theta < 1.0);
+
+   psZipf->n = n;
+   psZipf->theta = theta;
+   psZipf->alpha = 1.0 / (1.0 - theta);
+   psZipf->zetan = 0.0;
+   for (i = 1; i <= n; i++)
+      psZipf->zetan += 1.0 / pow((double)i, theta);
+   zeta2 = 1.0 + 1.0 / pow(2.0, theta);
+   psZipf->eta = (1.0 - pow(2.0 / (double)n, 1.0 - theta)) /
+      (1.0 - zeta2 / psZipf->zetan);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns a Zipf-distributed item of the population of *psZipf. Ranks
+  are scattered over the items by a hash so the most popular items are
+  not all the earliest built, which lie nearest the root.
+*/
+static size_t Zipf_next(const struct Zipf *psZipf) {
+   double u;
+   double uz;
+   uint64_t rank;
+
+   assert(psZipf != NULL);
+
+   if (psZipf->theta == 0.0 || psZipf->n < 2)
+      return Bench_below(psZipf->n);
+
+   u = Bench_uniform();
+   uz = u * psZipf->zetan;
+   if (uz < 1.0)
+      rank = 0;
+   else if (uz < 1.0 + pow(0.5, psZipf->theta))
+      rank = 1;
+   else
+      rank = (uint64_t)((double)psZipf->n *
+                        pow(psZipf->eta * u - psZipf->eta + 1.0,
+                            psZipf->alpha));
+   if (rank >= psZipf->n)
+      rank = psZipf->n - 1;
+
+   /* Scatter by a 64-bit multiplicative hash. */
+   rank = (rank + 1) * UINT64_C(0x9E3779B97F4A7C15);
+   rank ^= rank >> 29;
+   return (size_t)(rank % psZipf->n);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Draws the number of children to give a directory under *psConfig.
+*/
+static size_t Bench_fanout(const struct Config *psConfig) {
+   double p;
+
+   assert(psConfig != NULL);
+
+   if (psConfig->fanout <= 1 || psConfig->spread == SPREAD_FIXED)
+      return psConfig->fanout;
+
+   if (psConfig->spread == SPREAD_UNIFORM)
+      return 1 + Bench_below(2 * psConfig->fanout - 1);
+
+   /* A geometric count of at least one, with the given mean. */
+   p = 1.0 / (double)psConfig->fanout;
+   return 1 + (size_t)floor(log(1.0 - Bench_uniform()) / log(1.0 - p));
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Writes to name a new name with a random part of mean length uLength
+  followed by the unique number uId. name must have room for
+  2 * uLength + 18 characters.
+*/
+static void Bench_makeName(char *name, size_t uLength, size_t uId) {
+   size_t uChars;
+   size_t i;
+
+   assert(name != NULL);
+
+   uChars = (uLength == 0) ? 0 : uLength / 2 + Bench_below(uLength + 1);
+   for (i = 0; i < uChars; i++)
+      name[i] = (char)('a' + Bench_below(26));
+   sprintf(name + uChars, "%lx", (unsigned long)uId);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the index of a target of *psBuilt drawn by *psZipf,
+  redrawing a few times to find one of the given type.
+*/
+static size_t Bench_target(struct Paths *psBuilt,
+                           const struct Zipf *psZipf, int type) {
+   size_t uIndex;
+   int tries;
+
+   assert(psBuilt != NULL);
+   assert(psZipf != NULL);
+
+   uIndex = Zipf_next(psZipf);
+   for (tries = 0; tries < MAX_REDRAWS; tries++) {
+      if (psBuilt->types[uIndex] == type)
+         break;
+      uIndex = Zipf_next(psZipf);
+   }
+   return uIndex;
+}
+/*--------------------------------------------------------------------*/
+/*
+  Reports that the call of operation op on path returned the
+  unexpected status. Returns 1.
+*/
+static int Bench_fail(int op, const char *path, int status) {
+   fprintf(stderr, "%s(\"%s\") returned %d unexpectedly\n",
+           opNames[op], path, status);
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Inserts path into the FT as a new directory or file, by type,
+  recording the latency in asHists. Returns 0 if successful, 1 if the
+  insertion fails.
+*/
+static int Bench_insert(char *path, int type,
+                        struct OpStats asHists[NUM_OPS]) {
+   static char acContents[MAX_CONTENTS_LENGTH];
+   uint64_t start;
+   int status;
+
+   assert(path != NULL);
+
+   if (type == DIR) {
+      start = Bench_nanoseconds();
+      status = FT_insertDir(path);
+      Stats_add(&asHists[OP_INSERT_DIR], SUCCESS,
+                Bench_nanoseconds() - start);
+      if (status != SUCCESS)
+         return Bench_fail(OP_INSERT_DIR, path, status);
+   }
+   else {
+      start = Bench_nanoseconds();
+      status = FT_insertFile(path, acContents,
+                             Bench_below(MAX_CONTENTS_LENGTH + 1));
+      Stats_add(&asHists[OP_INSERT_FILE], SUCCESS,
+                Bench_nanoseconds() - start);
+      if (status != SUCCESS)
+         return Bench_fail(OP_INSERT_FILE, path, status);
+   }
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Builds the synthetic tree of *psConfig in the FT, breadth first,
+  recording every path in *psBuilt and every insertion's latency in
+  asHists. Directories deeper than the configured depth get no
+  children; when every directory has had its turn, the turns start
+  again at the root. Returns 0 if successful, 1 otherwise.
+*/
+static int Bench_build(const struct Config *psConfig,
+                       struct Paths *psBuilt,
+                       struct OpStats asHists[NUM_OPS]) {
+   enum { NAME_SIZE = 2 * 255 + 18 };
+   char name[NAME_SIZE];
+   size_t uHead = 0;
+   size_t uNextId = 0;
+   size_t uChildren;
+   size_t i;
+   int type;
+
+   assert(psConfig != NULL);
+   assert(psBuilt != NULL);
+
+   if (!Paths_add(psBuilt, NULL, 0, ROOT_NAME, DIR, 0))
+      return 1;
+   if (Bench_insert(Paths_get(psBuilt, 0), DIR, asHists) != 0)
+      return 1;
+
+   while (psBuilt->length < psConfig->nodes) {
+      /* Find the next directory that may have children. */
+      while (psBuilt->types[uHead] != DIR ||
+             psBuilt->depths[uHead] >= psConfig->depth)
+         if (++uHead == psBuilt->length)
+            uHead = 0;
+
+      uChildren = Bench_fanout(psConfig);
+      for (i = 0; i < uChildren && psBuilt->length < psConfig->nodes;
+           i++) {
+         type = (Bench_uniform() < psConfig->files) ? FIL : DIR;
+         Bench_makeName(name, psConfig->name, uNextId++);
+         if (!Paths_add(psBuilt, psBuilt, uHead, name, type,
+                        (size_t)psBuilt->depths[uHead] + 1))
+            return 1;
+         if (Bench_insert(Paths_get(psBuilt, psBuilt->length - 1), type,
+                          asHists) != 0)
+            return 1;
+      }
+
+      if (++uHead == psBuilt->length)
+         uHead = 0;
+   }
+
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Draws a kind of request with probability proportional to the
+  weights of *psConfig, whose sum is uTotal.
+*/
+static int Bench_kind(const struct Config *psConfig,
+                      unsigned long uTotal) {
+   unsigned long uPick;
+   int kind;
+
+   assert(psConfig != NULL);
+   assert(uTotal > 0);
+
+   uPick = (unsigned long)Bench_below(uTotal);
+   for (kind = 0; kind < NUM_KINDS - 1; kind++) {
+      if (uPick < psConfig->weights[kind])
+         break;
+      uPick -= psConfig->weights[kind];
+   }
+   return kind;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Serves one request of the given kind against the built tree, whose
+  paths are in *psBuilt with popularity drawn by *psZipf. Paths the
+  workload inserts are kept in *psChurn, and only those are removed,
+  so the built tree stays whole. Records the latency in asHists.
+  Returns 0 if successful, 1 otherwise.
+*/
+static int Bench_request(int kind, const struct Config *psConfig,
+                         struct Paths *psBuilt, struct Paths *psChurn,
+                         const struct Zipf *psZipf,
+                         struct OpStats asHists[NUM_OPS]) {
+   static char acContents[MAX_CONTENTS_LENGTH];
+   enum { NAME_SIZE = 2 * 255 + 19 };
+   char name[NAME_SIZE];
+   static size_t uNextId;
+   uint64_t start;
+   size_t uIndex;
+   char *path;
+   int type;
+   int status;
+   int op;
+   boolean isFile;
+   size_t length;
+   void *pvResult;
+
+   assert(psConfig != NULL);
+   assert(psBuilt != NULL);
+   assert(psChurn != NULL);
+   assert(psZipf != NULL);
+
+   /* With nothing of its own to remove, the workload inserts. */
+   if (kind == KIND_REMOVE && psChurn->length == 0)
+      kind = KIND_INSERT;
+
+   if (kind == KIND_CONTAINS) {
+      uIndex = Zipf_next(psZipf);
+      path = Paths_get(psBuilt, uIndex);
+      if (psBuilt->types[uIndex] == DIR) {
+         op = OP_CONTAINS_DIR;
+         start = Bench_nanoseconds();
+         status = FT_containsDir(path);
+      }
+      else {
+         op = OP_CONTAINS_FILE;
+         start = Bench_nanoseconds();
+         status = FT_containsFile(path);
+      }
+      Stats_add(&asHists[op], SUCCESS, Bench_nanoseconds() - start);
+      if (status != TRUE)
+         return Bench_fail(op, path, status);
+   }
+   else if (kind == KIND_STAT) {
+      path = Paths_get(psBuilt, Zipf_next(psZipf));
+      start = Bench_nanoseconds();
+      status = FT_stat(path, &isFile, &length);
+      Stats_add(&asHists[OP_STAT], SUCCESS,
+                Bench_nanoseconds() - start);
+      if (status != SUCCESS)
+         return Bench_fail(OP_STAT, path, status);
+   }
+   else if (kind == KIND_GET || kind == KIND_REPLACE) {
+      uIndex = Bench_target(psBuilt, psZipf, FIL);
+      path = Paths_get(psBuilt, uIndex);
+      if (kind == KIND_GET) {
+         op = OP_GET_CONTENTS;
+         start = Bench_nanoseconds();
+         pvResult = FT_getFileContents(path);
+      }
+      else {
+         op = OP_REPLACE_CONTENTS;
+         start = Bench_nanoseconds();
+         pvResult = FT_replaceFileContents(
+            path, acContents, Bench_below(MAX_CONTENTS_LENGTH + 1));
+      }
+      Stats_add(&asHists[op], SUCCESS, Bench_nanoseconds() - start);
+      /* Every file is given non-NULL contents. */
+      if ((pvResult != NULL) != (psBuilt->types[uIndex] == FIL))
+         return Bench_fail(op, path, pvResult != NULL);
+   }
+   else if (kind == KIND_INSERT) {
+      uIndex = Bench_target(psBuilt, psZipf, DIR);
+      if (psBuilt->types[uIndex] != DIR)
+         uIndex = 0;
+      type = (Bench_uniform() < psConfig->files) ? FIL : DIR;
+      /* A leading '.' keeps the names apart from the built tree's. */
+      name[0] = '.';
+      Bench_makeName(name + 1, psConfig->name, uNextId++);
+      if (!Paths_add(psChurn, psBuilt, uIndex, name, type, 0))
+         return 1;
+      return Bench_insert(Paths_get(psChurn, psChurn->length - 1), type,
+                          asHists);
+   }
+   else if (kind == KIND_REMOVE) {
+      uIndex = Bench_below(psChurn->length);
+      path = Paths_get(psChurn, uIndex);
+      if (psChurn->types[uIndex] == DIR) {
+         op = OP_RM_DIR;
+         start = Bench_nanoseconds();
+         status = FT_rmDir(path);
+      }
+      else {
+         op = OP_RM_FILE;
+         start = Bench_nanoseconds();
+         status = FT_rmFile(path);
+      }
+      Stats_add(&asHists[op], SUCCESS, Bench_nanoseconds() - start);
+      if (status != SUCCESS)
+         return Bench_fail(op, path, status);
+      Paths_remove(psChurn, uIndex);
+   }
+   else {
+      start = Bench_nanoseconds();
+      pvResult = FT_toString();
+      Stats_add(&asHists[OP_TO_STRING], SUCCESS,
+                Bench_nanoseconds() - start);
+      if (pvResult == NULL)
+         return Bench_fail(OP_TO_STRING, "", 0);
+      free(pvResult);
+   }
+
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the index of value in the count names, or -1 if it is not
+  one of them.
+*/
+static int Bench_lookup(const char *value, const char *names[],
+                        int count) {
+   int i;
+
+   assert(value != NULL);
+   assert(names != NULL);
+
+   for (i = 0; i < count; i++)
+      if (strcmp(value, names[i]) == 0)
+         return i;
+   return -1;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Sets the field of *psConfig named by the argument arg, of the form
+  name=value. Returns 0 if successful, 1 if arg is not understood.
+*/
+static int Bench_parseArg(struct Config *psConfig, const char *arg) {
+   const char *value;
+   size_t uNameLength;
+   int kind;
+
+   assert(psConfig != NULL);
+   assert(arg != NULL);
+
+   value = strchr(arg, '=');
+   if (value == NULL)
+      return 1;
+   uNameLength = (size_t)(value - arg);
+   value++;
+
+   if (strncmp(arg, "nodes", uNameLength) == 0 && uNameLength == 5)
+      psConfig->nodes = (size_t)strtod(value, NULL);
+   else if (strncmp(arg, "depth", uNameLength) == 0 && uNameLength == 5)
+      psConfig->depth = (size_t)strtoul(value, NULL, 10);
+   else if (strncmp(arg, "fanout", uNameLength) == 0 &&
+            uNameLength == 6)
+      psConfig->fanout = (size_t)strtoul(value, NULL, 10);
+   else if (strncmp(arg, "spread", uNameLength) == 0 &&
+            uNameLength == 6) {
+      psConfig->spread = Bench_lookup(value, spreadNames, NUM_SPREADS);
+      if (psConfig->spread < 0)
+         return 1;
+   }
+   else if (strncmp(arg, "files", uNameLength) == 0 && uNameLength == 5)
+      psConfig->files = strtod(value, NULL);
+   else if (strncmp(arg, "name", uNameLength) == 0 && uNameLength == 4)
+      psConfig->name = (size_t)strtoul(value, NULL, 10);
+   else if (strncmp(arg, "ops", uNameLength) == 0 && uNameLength == 3)
+      psConfig->ops = (size_t)strtod(value, NULL);
+   else if (strncmp(arg, "skew", uNameLength) == 0 && uNameLength == 4)
+      psConfig->skew = strtod(value, NULL);
+   else if (strncmp(arg, "seed", uNameLength) == 0 && uNameLength == 4)
+      psConfig->seed = strtoul(value, NULL, 10);
+   else if (strncmp(arg, "shape", uNameLength) == 0 && uNameLength == 5)
+      psConfig->shape = strtol(value, NULL, 10);
+   else if (strncmp(arg, "slow", uNameLength) == 0 && uNameLength == 4)
+      psConfig->slow = (uint64_t)strtod(value, NULL);
+   else {
+      for (kind = 0; kind < NUM_KINDS; kind++)
+         if (strncmp(arg, kindNames[kind], uNameLength) == 0 &&
+             strlen(kindNames[kind]) == uNameLength)
+            break;
+      if (kind == NUM_KINDS)
+         return 1;
+      psConfig->weights[kind] = strtoul(value, NULL, 10);
+   }
+
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Prints how to call the program to stderr. Returns 1.
+*/
+static int Bench_usage(const char *program) {
+   fprintf(stderr,
+           "usage: %s [name=value]...\n"
+           "  nodes=N     nodes in the built tree (100000)\n"
+           "  depth=D     deepest directory given children, "
+           "1-255 (8)\n"
+           "  fanout=F    mean children per directory (8)\n"
+           "  spread=S    fixed, uniform or geometric (geometric)\n"
+           "  files=R     fraction of nodes that are files (0.75)\n"
+           "  name=L      mean name length, 0-255 (8)\n"
+           "  ops=N       requests in the workload (1000000)\n"
+           "  skew=Z      Zipf exponent of popularity, 0-0.999 (0.99)\n"
+           "  seed=S      random seed (217)\n"
+           "  shape=K     report the built tree's shape, sampling K "
+           "children\n"
+           "              per directory, or all if 0 (off)\n"
+           "  slow=NS     log calls taking NS ns or more, dumping the "
+           "log\n"
+           "              at the end and on SIGUSR1 (off)\n"
+           "  contains=W stat=W get=W replace=W insert=W remove=W "
+           "tostring=W\n"
+           "              request weights (50 20 10 5 8 7 0)\n",
+           program);
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Builds a synthetic File Tree with the shape given by the name=value
+  arguments, then runs a mixed workload on it with Zipfian path
+  popularity, and prints the throughput and latency percentiles of
+  each FT operation for both phases. Returns 0 if successful, 1
+  otherwise.
+*/
+int main(int argc, char *argv[]) {
+   static struct OpStats asBuildHists[NUM_OPS];
+   static struct OpStats asRunHists[NUM_OPS];
+   static struct ShapeStats sShape;
+   static const unsigned long aulWeights[NUM_KINDS] = {
+      50, 20, 10, 5, 8, 7, 0
+   };
+   struct Config sConfig;
+   struct Paths sBuilt;
+   struct Paths sChurn;
+   struct Zipf sZipf;
+   unsigned long uTotal = 0;
+   uint64_t start;
+   double seconds;
+   size_t i;
+   int kind;
+   int status = 0;
+
+   sConfig.nodes = 100000;
+   sConfig.depth = 8;
+   sConfig.fanout = 8;
+   sConfig.spread = SPREAD_GEOMETRIC;
+   sConfig.files = 0.75;
+   sConfig.name = 8;
+   sConfig.ops = 1000000;
+   sConfig.skew = 0.99;
+   sConfig.seed = 217;
+   sConfig.shape = -1;
+   sConfig.slow = 0;
+   for (kind = 0; kind < NUM_KINDS; kind++)
+      sConfig.weights[kind] = aulWeights[kind];
+
+   for (i = 1; i < (size_t)argc; i++)
+      if (Bench_parseArg(&sConfig, argv[i]) != 0)
+         return Bench_usage(argv[0]);
+   for (kind = 0; kind < NUM_KINDS; kind++)
+      uTotal += sConfig.weights[kind];
+   if (sConfig.nodes == 0 || sConfig.depth == 0 ||
+       sConfig.depth > 255 || sConfig.fanout == 0 ||
+       sConfig.files < 0.0 || sConfig.files > 1.0 ||
+       sConfig.name > 255 || sConfig.skew < 0.0 ||
+       sConfig.skew >= 1.0 || uTotal == 0)
+      return Bench_usage(argv[0]);
+
+   randomState = (uint64_t)sConfig.seed * 2 + 1;
+   memset(&sBuilt, 0, sizeof(sBuilt));
+   memset(&sChurn, 0, sizeof(sChurn));
+
+   printf("nodes=%lu depth=%lu fanout=%lu spread=%s files=%.2f "
+          "name=%lu ops=%lu skew=%.3f seed=%lu\n",
+          (unsigned long)sConfig.nodes, (unsigned long)sConfig.depth,
+          (unsigned long)sConfig.fanout, spreadNames[sConfig.spread],
+          sConfig.files, (unsigned long)sConfig.name,
+          (unsigned long)sConfig.ops, sConfig.skew, sConfig.seed);
+
+   (void)FT_init();
+   if (sConfig.slow != 0) {
+      FT_slowLogSetThreshold(sConfig.slow);
+      (void)FT_slowLogDumpOnSignal(SIGUSR1, STDERR_FILENO);
+   }
+
+   /* Build the tree. */
+   start = Bench_nanoseconds();
+   if (Bench_build(&sConfig, &sBuilt, asBuildHists) != 0) {
+      fprintf(stderr, "Building the tree failed\n");
+      status = 1;
+   }
+   seconds = (double)(Bench_nanoseconds() - start) / 1e9;
+   printf("built %lu nodes in %.3f s (%.0f nodes/s)\n",
+          (unsigned long)sBuilt.length, seconds,
+          (double)sBuilt.length / seconds);
+   Bench_report("build", asBuildHists);
+
+   /* Report the shape of the tree. */
+   if (status == 0 && sConfig.shape >= 0) {
+      start = Bench_nanoseconds();
+      (void)FT_shapeStats(&sShape, (size_t)sConfig.shape);
+      printf("\nshape, gathered in %.3f s\n",
+             (double)(Bench_nanoseconds() - start) / 1e9);
+      Shape_write(stdout, &sShape);
+   }
+
+   /* Run the mixed workload. */
+   if (status == 0 && sConfig.ops > 0) {
+      Zipf_init(&sZipf, sBuilt.length, sConfig.skew);
+      start = Bench_nanoseconds();
+      for (i = 0; i < sConfig.ops && status == 0; i++) {
+         kind = Bench_kind(&sConfig, uTotal);
+         status = Bench_request(kind, &sConfig, &sBuilt, &sChurn,
+                                &sZipf, asRunHists);
+      }
+      seconds = (double)(Bench_nanoseconds() - start) / 1e9;
+      printf("\nran %lu requests in %.3f s (%.0f requests/s)\n",
+             (unsigned long)i, seconds, (double)i / seconds);
+      Bench_report("workload", asRunHists);
+   }
+
+   /* Dump the slowest calls. */
+   if (sConfig.slow != 0) {
+      printf("\nslow calls, %.0f ns or more:\n", (double)sConfig.slow);
+      (void)fflush(stdout);
+      FT_slowLogDump(STDOUT_FILENO);
+      FT_slowLogSetThreshold(0);
+   }
+
+   start = Bench_nanoseconds();
+   (void)FT_destroy();
+   printf("\ndestroyed in %.3f s\n",
+          (double)(Bench_nanoseconds() - start) / 1e9);
+
+   Paths_free(&sBuilt);
+   Paths_free(&sChurn);
+   return status;
+}
@@ -10,6 +10,47 @@
 #include <string.h>
 #include "ft.h"
 
+/* The size of the buffers the callbacks below collect results in. */
+enum { RESULT_SIZE = 1024 };
+
+/* Appends text to result, a string in a buffer of RESULT_SIZE
+   bytes. */
+static void appendResult(char *result, const char *text) {
+  assert(strlen(result) + strlen(text) < RESULT_SIZE);
+  strcat(result, text);
+}
+
+/* Appends path to the result string extra, followed by '/' if it is
+   a directory and then a space. */
+static void collectPath(const char *path, boolean isFile,
+                        void *extra) {
+  appendResult(extra, path);
+  appendResult(extra, isFile ? " " : "/ ");
+}
+
+/* Appends path and length to the result string extra as
+   "path=length ". */
+static void collectLength(const char *path, size_t length,
+                          void *extra) {
+  char equals[32];
+
+  sprintf(equals, "=%lu ", (unsigned long)length);
+  appendResult(extra, path);
+  appendResult(extra, equals);
+}
+
+/* Appends path and the offset and length of its match to the result
+   string extra as "path@offset+length ". */
+static void collectMatch(const char *path, size_t offset,
+                         size_t length, void *extra) {
+  char match[64];
+
+  sprintf(match, "@%lu+%lu ", (unsigned long)offset,
+          (unsigned long)length);
+  appendResult(extra, path);
+  appendResult(extra, match);
+}
+
 /* Tests the FT implementation with an assortment of checks.
    Prints the status of the data structure along the way to stderr.
    Returns 0. */
@@ -17,6 +58,16 @@ int main(void) {
   char* temp;
   boolean b;
   size_t l;
+  int status;
+  char result[RESULT_SIZE];
+  struct FT_Entry entries[3];
+  size_t cursor;
+  size_t numEntries;
+  struct FT_Stat stat;
+  int indexed;
+  const char *found;
+  size_t k;
+  size_t position;
 
   /* Before the data structure is initialized, insert*, remove*,
      and destroy operations should return INITIALIZATION_ERROR, and
@@ -177,5 +228,653 @@ int main(void) {
   assert(FT_containsDir("a") == FALSE);
   assert(FT_containsFile("a") == FALSE);
 
+  /* glob reports matches in pre-order, files before directories,
+     a "**" component matches any number of components, none
+     included, and '\\' makes a wildcard literal */
+  *result = '\0';
+  status = FT_glob("*", collectPath, result);
+  assert(status == INITIALIZATION_ERROR);
+  status = FT_init();
+  assert(status == SUCCESS);
+  status = FT_glob("*", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, ""));
+  status = FT_insertDir("a");
+  assert(status == SUCCESS);
+  status = FT_insertDir("a/b/c");
+  assert(status == SUCCESS);
+  status = FT_insertFile("a/b/x.c", NULL, 0);
+  assert(status == SUCCESS);
+  status = FT_insertFile("a/b/*", NULL, 0);
+  assert(status == SUCCESS);
+  status = FT_insertFile("a/b/c/y.c", NULL, 0);
+  assert(status == SUCCESS);
+  status = FT_insertFile("a/z.h", NULL, 0);
+  assert(status == SUCCESS);
+  status = FT_glob("*", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/ "));
+  *result = '\0';
+  status = FT_glob("a/*", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/z.h a/b/ "));
+  *result = '\0';
+  status = FT_glob("a/b/*", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/b/* a/b/x.c a/b/c/ "));
+  *result = '\0';
+  status = FT_glob("a/b/\\*", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/b/* "));
+  *result = '\0';
+  status = FT_glob("a/b/?.c", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/b/x.c "));
+  *result = '\0';
+  status = FT_glob("a/b/[a-x].c", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/b/x.c "));
+  *result = '\0';
+  status = FT_glob("a/b/[!x].c", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, ""));
+  status = FT_glob("a/*.c", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, ""));
+  status = FT_glob("a/b/c/y.c/*", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, ""));
+  status = FT_glob("b/**", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, ""));
+  status = FT_glob("a/**/*.c", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/b/x.c a/b/c/y.c "));
+  *result = '\0';
+  status = FT_glob("a/**/c", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/b/c/ "));
+  *result = '\0';
+  status = FT_glob("**/a", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/ "));
+  *result = '\0';
+  status = FT_glob("a/**", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result,
+                 "a/ a/z.h a/b/ a/b/* a/b/x.c a/b/c/ a/b/c/y.c "));
+  *result = '\0';
+  status = FT_glob("**", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result,
+                 "a/ a/z.h a/b/ a/b/* a/b/x.c a/b/c/ a/b/c/y.c "));
+  status = FT_destroy();
+  assert(status == SUCCESS);
+
+  /* listDir pages through a directory, files first, from cursor on,
+     until it stores fewer entries than asked for, and on failure
+     stores none and leaves the cursor alone */
+  cursor = 0;
+  status = FT_listDir("a", entries, 3, &cursor, &numEntries);
+  assert(status == INITIALIZATION_ERROR);
+  assert(numEntries == 0);
+  status = FT_init();
+  assert(status == SUCCESS);
+  status = FT_insertDir("a");
+  assert(status == SUCCESS);
+  status = FT_listDir("a", entries, 3, &cursor, &numEntries);
+  assert(status == SUCCESS);
+  assert(numEntries == 0);
+  assert(cursor == 0);
+  status = FT_insertDir("a/d");
+  assert(status == SUCCESS);
+  status = FT_insertFile("a/B", "Bell", 5);
+  assert(status == SUCCESS);
+  status = FT_insertDir("a/c");
+  assert(status == SUCCESS);
+  status = FT_insertFile("a/A", NULL, 0);
+  assert(status == SUCCESS);
+  status = FT_listDir("a", entries, 0, &cursor, &numEntries);
+  assert(status == SUCCESS);
+  assert(numEntries == 0);
+  assert(cursor == 0);
+  status = FT_listDir("a", entries, 3, &cursor, &numEntries);
+  assert(status == SUCCESS);
+  assert(numEntries == 3);
+  assert(cursor == 3);
+  assert(!strcmp(entries[0].name, "A"));
+  assert(entries[0].isFile == TRUE);
+  assert(entries[0].length == 0);
+  assert(!strcmp(entries[1].name, "B"));
+  assert(entries[1].isFile == TRUE);
+  assert(entries[1].length == 5);
+  assert(!strcmp(entries[2].name, "c"));
+  assert(entries[2].isFile == FALSE);
+  assert(entries[2].length == 0);
+  status = FT_listDir("a", entries, 3, &cursor, &numEntries);
+  assert(status == SUCCESS);
+  assert(numEntries == 1);
+  assert(cursor == 4);
+  assert(!strcmp(entries[0].name, "d"));
+  status = FT_listDir("a", entries, 3, &cursor, &numEntries);
+  assert(status == SUCCESS);
+  assert(numEntries == 0);
+  assert(cursor == 4);
+  cursor = 1;
+  status = FT_listDir("a", entries, 2, &cursor, &numEntries);
+  assert(status == SUCCESS);
+  assert(numEntries == 2);
+  assert(cursor == 3);
+  assert(!strcmp(entries[0].name, "B"));
+  assert(!strcmp(entries[1].name, "c"));
+  status = FT_listDir("a/B", entries, 3, &cursor, &numEntries);
+  assert(status == NOT_A_DIRECTORY);
+  assert(numEntries == 0);
+  assert(cursor == 3);
+  status = FT_listDir("a/e", entries, 3, &cursor, &numEntries);
+  assert(status == NO_SUCH_PATH);
+  status = FT_listDir("b", entries, 3, &cursor, &numEntries);
+  assert(status == NO_SUCH_PATH);
+  assert(numEntries == 0);
+  assert(cursor == 3);
+  status = FT_destroy();
+  assert(status == SUCCESS);
+
+  /* statEx totals the files, directories and bytes below a
+     directory, and keeps them up to date as the hierarchy changes */
+  status = FT_statEx("a", &stat);
+  assert(status == INITIALIZATION_ERROR);
+  status = FT_init();
+  assert(status == SUCCESS);
+  status = FT_insertDir("a");
+  assert(status == SUCCESS);
+  status = FT_statEx("a", &stat);
+  assert(status == SUCCESS);
+  assert(stat.isFile == FALSE);
+  assert(stat.length == 0);
+  assert(stat.files == 0 && stat.dirs == 0 && stat.bytes == 0);
+  status = FT_insertFile("a/x", "abc", 3);
+  assert(status == SUCCESS);
+  status = FT_insertFile("a/d/y", "defgh", 5);
+  assert(status == SUCCESS);
+  status = FT_insertDir("a/d/e");
+  assert(status == SUCCESS);
+  status = FT_statEx("a", &stat);
+  assert(status == SUCCESS);
+  assert(stat.files == 2 && stat.dirs == 2 && stat.bytes == 8);
+  status = FT_statEx("a/d", &stat);
+  assert(status == SUCCESS);
+  assert(stat.files == 1 && stat.dirs == 1 && stat.bytes == 5);
+  status = FT_statEx("a/x", &stat);
+  assert(status == SUCCESS);
+  assert(stat.isFile == TRUE);
+  assert(stat.length == 3);
+  assert(stat.files == 0 && stat.dirs == 0 && stat.bytes == 3);
+  assert(FT_replaceFileContents("a/d/y", "d", 1) != NULL);
+  status = FT_statEx("a", &stat);
+  assert(status == SUCCESS);
+  assert(stat.files == 2 && stat.dirs == 2 && stat.bytes == 4);
+  status = FT_statEx("a/d/z", &stat);
+  assert(status == NO_SUCH_PATH);
+  status = FT_statEx("a/x/y", &stat);
+  assert(status == NO_SUCH_PATH);
+  assert(stat.files == 2 && stat.dirs == 2 && stat.bytes == 4);
+  status = FT_rmDir("a/d");
+  assert(status == SUCCESS);
+  status = FT_statEx("a", &stat);
+  assert(status == SUCCESS);
+  assert(stat.files == 1 && stat.dirs == 0 && stat.bytes == 3);
+  status = FT_destroy();
+  assert(status == SUCCESS);
+
+  /* findByName and findByNamePrefix find the same paths, in some
+     order, with or without the index by name, which is kept up to
+     date from when it is enabled */
+  for (indexed = FALSE; indexed <= TRUE; indexed++) {
+    status = FT_init();
+    assert(status == SUCCESS);
+    status = FT_insertDir("a");
+    assert(status == SUCCESS);
+    status = FT_insertFile("a/f", NULL, 0);
+    assert(status == SUCCESS);
+    status = FT_insertDir("a/b");
+    assert(status == SUCCESS);
+    status = FT_nameIndexEnable((boolean)indexed);
+    assert(status == SUCCESS);
+    status = FT_insertDir("a/b/f");
+    assert(status == SUCCESS);
+    status = FT_insertFile("a/b/fg", NULL, 0);
+    assert(status == SUCCESS);
+    status = FT_insertFile("a/c/g", NULL, 0);
+    assert(status == SUCCESS);
+    *result = '\0';
+    status = FT_findByName("a", collectPath, result);
+    assert(status == SUCCESS);
+    assert(!strcmp(result, "a/ "));
+    *result = '\0';
+    status = FT_findByName("x", collectPath, result);
+    assert(status == SUCCESS);
+    status = FT_findByName("", collectPath, result);
+    assert(status == SUCCESS);
+    status = FT_findByNamePrefix("x", collectPath, result);
+    assert(status == SUCCESS);
+    assert(!strcmp(result, ""));
+    status = FT_findByName("f", collectPath, result);
+    assert(status == SUCCESS);
+    assert(strlen(result) == strlen("a/f a/b/f/ "));
+    assert(strstr(result, "a/f ") != NULL);
+    assert(strstr(result, "a/b/f/ ") != NULL);
+    *result = '\0';
+    status = FT_findByNamePrefix("f", collectPath, result);
+    assert(status == SUCCESS);
+    assert(strlen(result) == strlen("a/f a/b/f/ a/b/fg "));
+    assert(strstr(result, "a/f ") != NULL);
+    assert(strstr(result, "a/b/f/ ") != NULL);
+    assert(strstr(result, "a/b/fg ") != NULL);
+    *result = '\0';
+    status = FT_findByNamePrefix("fg", collectPath, result);
+    assert(status == SUCCESS);
+    assert(!strcmp(result, "a/b/fg "));
+    *result = '\0';
+    status = FT_rmFile("a/f");
+    assert(status == SUCCESS);
+    status = FT_rmDir("a/b/f");
+    assert(status == SUCCESS);
+    status = FT_findByName("f", collectPath, result);
+    assert(status == SUCCESS);
+    assert(!strcmp(result, ""));
+    status = FT_destroy();
+    assert(status == SUCCESS);
+  }
+  status = FT_nameIndexEnable(FALSE);
+  assert(status == SUCCESS);
+
+  /* scanRange reports the paths from lo, included, up to hi,
+     excluded, in path order with '/' before every other character,
+     so each directory comes just before the paths below it */
+  status = FT_scanRange(NULL, NULL, collectPath, result);
+  assert(status == INITIALIZATION_ERROR);
+  status = FT_init();
+  assert(status == SUCCESS);
+  *result = '\0';
+  status = FT_scanRange(NULL, NULL, collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, ""));
+  status = FT_insertDir("a");
+  assert(status == SUCCESS);
+  status = FT_insertFile("a/z", NULL, 0);
+  assert(status == SUCCESS);
+  status = FT_insertFile("a/ba", NULL, 0);
+  assert(status == SUCCESS);
+  status = FT_insertDir("a/b-x");
+  assert(status == SUCCESS);
+  status = FT_insertFile("a/b/c", NULL, 0);
+  assert(status == SUCCESS);
+  status = FT_scanRange(NULL, NULL, collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/ a/b/ a/b/c a/b-x/ a/ba a/z "));
+  *result = '\0';
+  status = FT_scanRange("a/b", NULL, collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/b/ a/b/c a/b-x/ a/ba a/z "));
+  *result = '\0';
+  status = FT_scanRange(NULL, "a/b", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/ "));
+  *result = '\0';
+  status = FT_scanRange("a/b", "a/b-x", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/b/ a/b/c "));
+  *result = '\0';
+  status = FT_scanRange("a/b/d", "a/bz", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/b-x/ a/ba "));
+  *result = '\0';
+  status = FT_scanRange("a/z", "a/z", collectPath, result);
+  assert(status == SUCCESS);
+  status = FT_scanRange("a/z", "a/b", collectPath, result);
+  assert(status == SUCCESS);
+  status = FT_scanRange("a/zz", NULL, collectPath, result);
+  assert(status == SUCCESS);
+  status = FT_scanRange(NULL, "a", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, ""));
+  status = FT_scanRange("a/z", "b", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/z "));
+  status = FT_destroy();
+  assert(status == SUCCESS);
+
+  /* grep reports the leftmost match in each file of a subtree, in
+     pre-order, files before directories; '.' does not match a
+     newline, and '^' and '$' match at line boundaries */
+  *result = '\0';
+  status = FT_grep("a", "x", FALSE, collectMatch, result);
+  assert(status == INITIALIZATION_ERROR);
+  status = FT_init();
+  assert(status == SUCCESS);
+  status = FT_insertDir("a");
+  assert(status == SUCCESS);
+  status = FT_insertFile("a/x", "hello world", 11);
+  assert(status == SUCCESS);
+  status = FT_insertFile("a/d/y", "say hello\nbye", 13);
+  assert(status == SUCCESS);
+  status = FT_insertFile("a/e", NULL, 0);
+  assert(status == SUCCESS);
+  status = FT_insertFile("a/z", "Hello", 5);
+  assert(status == SUCCESS);
+  status = FT_grep("a", "hello", FALSE, collectMatch, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/x@0+5 a/d/y@4+5 "));
+  *result = '\0';
+  status = FT_grep("a", "l*o", TRUE, collectMatch, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/x@2+3 a/z@2+3 a/d/y@6+3 "));
+  *result = '\0';
+  status = FT_grep("a", "^bye$", TRUE, collectMatch, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/d/y@10+3 "));
+  *result = '\0';
+  status = FT_grep("a", "^hello", TRUE, collectMatch, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/x@0+5 "));
+  *result = '\0';
+  status = FT_grep("a", "o.b", TRUE, collectMatch, result);
+  assert(status == SUCCESS);
+  status = FT_grep("a", "l*o", FALSE, collectMatch, result);
+  assert(status == SUCCESS);
+  status = FT_grep("a", "hello world!", FALSE, collectMatch, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, ""));
+  status = FT_grep("a/x", "world", FALSE, collectMatch, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/x@6+5 "));
+  status = FT_grep("a/w", "world", FALSE, collectMatch, result);
+  assert(status == NO_SUCH_PATH);
+  status = FT_destroy();
+  assert(status == SUCCESS);
+
+  /* filesBySize and largestFiles report the same files, ordered by
+     length, with or without the index by length, which follows
+     inserts, new contents and removals */
+  for (indexed = FALSE; indexed <= TRUE; indexed++) {
+    status = FT_init();
+    assert(status == SUCCESS);
+    status = FT_insertDir("a");
+    assert(status == SUCCESS);
+    status = FT_insertFile("a/q", "Pike!", 5);
+    assert(status == SUCCESS);
+    status = FT_sizeIndexEnable((boolean)indexed);
+    assert(status == SUCCESS);
+    status = FT_insertFile("a/p", "K", 1);
+    assert(status == SUCCESS);
+    status = FT_insertFile("a/d/r", "Aho", 3);
+    assert(status == SUCCESS);
+    status = FT_insertFile("a/d/s", NULL, 0);
+    assert(status == SUCCESS);
+    *result = '\0';
+    status = FT_filesBySize(1, 3, collectLength, result);
+    assert(status == SUCCESS);
+    assert(!strcmp(result, "a/p=1 a/d/r=3 "));
+    *result = '\0';
+    status = FT_filesBySize(0, 0, collectLength, result);
+    assert(status == SUCCESS);
+    assert(!strcmp(result, "a/d/s=0 "));
+    *result = '\0';
+    status = FT_filesBySize(4, 2, collectLength, result);
+    assert(status == SUCCESS);
+    status = FT_filesBySize(6, (size_t)-1, collectLength, result);
+    assert(status == SUCCESS);
+    status = FT_largestFiles(0, collectLength, result);
+    assert(status == SUCCESS);
+    assert(!strcmp(result, ""));
+    status = FT_largestFiles(2, collectLength, result);
+    assert(status == SUCCESS);
+    assert(!strcmp(result, "a/q=5 a/d/r=3 "));
+    *result = '\0';
+    status = FT_largestFiles(10, collectLength, result);
+    assert(status == SUCCESS);
+    assert(!strcmp(result, "a/q=5 a/d/r=3 a/p=1 a/d/s=0 "));
+    *result = '\0';
+    assert(FT_replaceFileContents("a/p", "Kernighan", 9) != NULL);
+    status = FT_largestFiles(1, collectLength, result);
+    assert(status == SUCCESS);
+    assert(!strcmp(result, "a/p=9 "));
+    *result = '\0';
+    status = FT_rmDir("a/d");
+    assert(status == SUCCESS);
+    status = FT_filesBySize(0, 4, collectLength, result);
+    assert(status == SUCCESS);
+    assert(!strcmp(result, ""));
+    status = FT_filesBySize(0, (size_t)-1, collectLength, result);
+    assert(status == SUCCESS);
+    assert(!strcmp(result, "a/q=5 a/p=9 "));
+    status = FT_destroy();
+    assert(status == SUCCESS);
+  }
+  status = FT_sizeIndexEnable(FALSE);
+  assert(status == SUCCESS);
+
+  /* nth and rank number the paths in pre-order, files before
+     directories, as toString lists them, and undo each other as
+     the hierarchy changes */
+  status = FT_nth("a", 0, &found);
+  assert(status == INITIALIZATION_ERROR);
+  status = FT_rank("a", &position);
+  assert(status == INITIALIZATION_ERROR);
+  status = FT_init();
+  assert(status == SUCCESS);
+  status = FT_nth("a", 0, &found);
+  assert(status == NO_SUCH_PATH);
+  status = FT_insertDir("a");
+  assert(status == SUCCESS);
+  status = FT_insertDir("a/c");
+  assert(status == SUCCESS);
+  status = FT_insertFile("a/b/g", NULL, 0);
+  assert(status == SUCCESS);
+  status = FT_insertFile("a/f", NULL, 0);
+  assert(status == SUCCESS);
+  *result = '\0';
+  for (k = 0; FT_nth("a", k, &found) == SUCCESS; k++) {
+    appendResult(result, found);
+    appendResult(result, " ");
+    status = FT_rank((char*)found, &position);
+    assert(status == SUCCESS);
+    assert(position == k);
+  }
+  assert(k == 5);
+  assert(!strcmp(result, "a a/f a/b a/b/g a/c "));
+  status = FT_nth("a/b", 1, &found);
+  assert(status == SUCCESS);
+  assert(!strcmp(found, "a/b/g"));
+  status = FT_nth("a/b", 2, &found);
+  assert(status == NO_SUCH_PATH);
+  status = FT_nth("a/f", 0, &found);
+  assert(status == SUCCESS);
+  assert(!strcmp(found, "a/f"));
+  status = FT_nth("a/f", 1, &found);
+  assert(status == NO_SUCH_PATH);
+  status = FT_nth("a/e", 0, &found);
+  assert(status == NO_SUCH_PATH);
+  assert(!strcmp(found, "a/f"));
+  status = FT_rank("a/e", &position);
+  assert(status == NO_SUCH_PATH);
+  assert(position == 4);
+  status = FT_insertFile("a/b/a", NULL, 0);
+  assert(status == SUCCESS);
+  status = FT_rank("a/b/g", &position);
+  assert(status == SUCCESS);
+  assert(position == 4);
+  status = FT_nth("a", 3, &found);
+  assert(status == SUCCESS);
+  assert(!strcmp(found, "a/b/a"));
+  status = FT_rmDir("a/b");
+  assert(status == SUCCESS);
+  status = FT_rank("a/c", &position);
+  assert(status == SUCCESS);
+  assert(position == 2);
+  status = FT_nth("a", 3, &found);
+  assert(status == NO_SUCH_PATH);
+  status = FT_destroy();
+  assert(status == SUCCESS);
+
+  /* after move, a subtree is found only under its new path, by
+     lookups, queries and the index by name alike */
+  status = FT_move("a/b", "a/c");
+  assert(status == INITIALIZATION_ERROR);
+  status = FT_init();
+  assert(status == SUCCESS);
+  status = FT_nameIndexEnable(TRUE);
+  assert(status == SUCCESS);
+  status = FT_insertDir("a");
+  assert(status == SUCCESS);
+  status = FT_insertFile("a/b/c/f", "Bentley", 8);
+  assert(status == SUCCESS);
+  status = FT_insertFile("a/g", NULL, 0);
+  assert(status == SUCCESS);
+  status = FT_insertDir("a/d");
+  assert(status == SUCCESS);
+  status = FT_move("a", "a/d/a");
+  assert(status == CONFLICTING_PATH);
+  status = FT_move("a/b", "a/b/c/b");
+  assert(status == CONFLICTING_PATH);
+  status = FT_move("a/b", "b/b");
+  assert(status == CONFLICTING_PATH);
+  status = FT_move("a/b", "a/d");
+  assert(status == ALREADY_IN_TREE);
+  status = FT_move("a/x", "a/d/x");
+  assert(status == NO_SUCH_PATH);
+  status = FT_move("a/b", "a/x/b");
+  assert(status == NO_SUCH_PATH);
+  status = FT_move("a/b", "a/g/b");
+  assert(status == NOT_A_DIRECTORY);
+  status = FT_move("a/b", "a/d/e");
+  assert(status == SUCCESS);
+  assert(FT_containsDir("a/b") == FALSE);
+  assert(FT_containsFile("a/b/c/f") == FALSE);
+  assert(FT_containsDir("a/d/e/c") == TRUE);
+  assert(FT_containsFile("a/d/e/c/f") == TRUE);
+  assert(!strcmp((char*)FT_getFileContents("a/d/e/c/f"), "Bentley"));
+  status = FT_statEx("a/d", &stat);
+  assert(status == SUCCESS);
+  assert(stat.files == 1 && stat.dirs == 2 && stat.bytes == 8);
+  *result = '\0';
+  status = FT_findByName("f", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/d/e/c/f "));
+  *result = '\0';
+  status = FT_glob("**/f", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/d/e/c/f "));
+  status = FT_nth("a", 5, &found);
+  assert(status == SUCCESS);
+  assert(!strcmp(found, "a/d/e/c/f"));
+  status = FT_move("a/d/e", "a/d/E");
+  assert(status == SUCCESS);
+  status = FT_move("a/g", "a/d/E/c/g");
+  assert(status == SUCCESS);
+  assert(FT_containsFile("a/d/E/c/f") == TRUE);
+  assert(FT_containsFile("a/d/E/c/g") == TRUE);
+  assert(FT_containsDir("a/d/e") == FALSE);
+  status = FT_rank("a/d/E/c/g", &position);
+  assert(status == SUCCESS);
+  assert(position == 5);
+  *result = '\0';
+  status = FT_findByNamePrefix("E", collectPath, result);
+  assert(status == SUCCESS);
+  assert(!strcmp(result, "a/d/E/ "));
+  status = FT_insertFile("a/b/c/f", NULL, 0);
+  assert(status == SUCCESS);
+  assert(FT_getFileContents("a/b/c/f") == NULL);
+  temp = FT_toString();
+  assert(temp != NULL);
+  assert(!strcmp(temp, "a\na/b\na/b/c\na/b/c/f\na/d\na/d/E\n"
+                 "a/d/E/c\na/d/E/c/f\na/d/E/c/g\n"));
+  free(temp);
+  status = FT_destroy();
+  assert(status == SUCCESS);
+  status = FT_nameIndexEnable(FALSE);
+  assert(status == SUCCESS);
+
+  /* a copy keeps what its source held when it was copied, however
+     the source changes afterwards, and the other way around, with
+     or without the indexes */
+  status = FT_copy("a/b", "a/c");
+  assert(status == INITIALIZATION_ERROR);
+  for (indexed = FALSE; indexed <= TRUE; indexed++) {
+    status = FT_init();
+    assert(status == SUCCESS);
+    status = FT_nameIndexEnable((boolean)indexed);
+    assert(status == SUCCESS);
+    status = FT_sizeIndexEnable((boolean)indexed);
+    assert(status == SUCCESS);
+    status = FT_insertDir("a");
+    assert(status == SUCCESS);
+    status = FT_insertFile("a/s/f", "McIlroy", 8);
+    assert(status == SUCCESS);
+    status = FT_insertFile("a/s/t/g", "Ossanna", 8);
+    assert(status == SUCCESS);
+    status = FT_copy("a/s", "a/s/t/s");
+    assert(status == CONFLICTING_PATH);
+    status = FT_copy("a/s", "a/s");
+    assert(status == ALREADY_IN_TREE);
+    status = FT_copy("a/x", "a/y");
+    assert(status == NO_SUCH_PATH);
+    status = FT_copy("a/s", "a/s/f/s");
+    assert(status == NOT_A_DIRECTORY);
+    status = FT_copy("a/s", "a/c");
+    assert(status == SUCCESS);
+    status = FT_copy("a/c", "a/d");
+    assert(status == SUCCESS);
+    status = FT_copy("a/s/f", "a/e");
+    assert(status == SUCCESS);
+    status = FT_insertFile("a/s/t/h", NULL, 0);
+    assert(status == SUCCESS);
+    status = FT_rmFile("a/s/f");
+    assert(status == SUCCESS);
+    assert(!strcmp(FT_replaceFileContents("a/s/t/g", "Morris", 7),
+                   "Ossanna"));
+    assert(FT_containsFile("a/s/f") == FALSE);
+    assert(FT_containsFile("a/c/f") == TRUE);
+    assert(FT_containsFile("a/c/t/h") == FALSE);
+    assert(!strcmp((char*)FT_getFileContents("a/c/t/g"), "Ossanna"));
+    assert(!strcmp((char*)FT_getFileContents("a/s/t/g"), "Morris"));
+    assert(!strcmp((char*)FT_getFileContents("a/e"), "McIlroy"));
+    status = FT_rmDir("a/c/t");
+    assert(status == SUCCESS);
+    assert(FT_containsFile("a/s/t/h") == TRUE);
+    assert(FT_containsFile("a/d/t/g") == TRUE);
+    assert(FT_containsFile("a/d/t/h") == FALSE);
+    status = FT_statEx("a/d", &stat);
+    assert(status == SUCCESS);
+    assert(stat.files == 2 && stat.dirs == 1 && stat.bytes == 16);
+    status = FT_statEx("a", &stat);
+    assert(status == SUCCESS);
+    assert(stat.files == 6 && stat.dirs == 5 && stat.bytes == 39);
+    *result = '\0';
+    status = FT_glob("a/*/t/*", collectPath, result);
+    assert(status == SUCCESS);
+    assert(!strcmp(result, "a/d/t/g a/s/t/g a/s/t/h "));
+    *result = '\0';
+    status = FT_findByName("g", collectPath, result);
+    assert(status == SUCCESS);
+    assert(strlen(result) == strlen("a/d/t/g a/s/t/g "));
+    assert(strstr(result, "a/d/t/g ") != NULL);
+    *result = '\0';
+    status = FT_largestFiles(2, collectLength, result);
+    assert(status == SUCCESS);
+    assert(strstr(result, "=8 ") != NULL);
+    assert(strstr(result, "a/s/t/g") == NULL);
+    status = FT_destroy();
+    assert(status == SUCCESS);
+  }
+  status = FT_nameIndexEnable(FALSE);
+  assert(status == SUCCESS);
+  status = FT_sizeIndexEnable(FALSE);
+  assert(status == SUCCESS);
+
+  /* status is read only by assert. */
+  (void)status;
+
   return 0;
 }
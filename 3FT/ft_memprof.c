@@ -0,0 +1,362 @@
+/*--------------------------------------------------------------------*/
+/* ft_memprof.c                                                       */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <malloc.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+
+#include "ft.h"
+#include "memprof.h"
+
+/* The bytes of the header memprof.c puts before each block. */
+enum { PROFILER_HEADER_SIZE = 16 };
+
+/* The most ancestors a node can have, as fanout is at least 2. */
+enum { MAX_DEPTH = 64 };
+
+/* The room for the path of a node. */
+enum { PATH_SIZE = MAX_DEPTH * 256 + 8 };
+
+/* The path of the root directory of the grown tree. */
+static const char *ROOT_NAME = "root";
+
+/* Bytes in a mebibyte. */
+static const double MIB = 1024.0 * 1024.0;
+
+/*--------------------------------------------------------------------*/
+/* The parameters of a run, set from name=value arguments. */
+struct Config {
+   /* The number of nodes the tree is grown to. */
+   size_t nodes;
+   /* The number of children of each directory. */
+   size_t fanout;
+   /* The fraction of leaves that are files. */
+   double files;
+   /* The length of each name but the root's. */
+   size_t name;
+   /* The number of reports while growing. */
+   size_t rows;
+};
+
+/* The memory use of the process at one moment. */
+struct Sample {
+   /* The live blocks by subsystem. */
+   struct MemProfStats stats;
+   /* The bytes malloc holds from the system, and has handed out. */
+   size_t heap;
+   size_t inUse;
+   /* The greatest resident set size so far, in bytes. */
+   size_t peakRss;
+};
+
+/*--------------------------------------------------------------------*/
+/*
+  Stores the current memory use of the process in *psSample.
+*/
+static void MemProf_sample(struct Sample *psSample) {
+   struct mallinfo2 info;
+   struct rusage usage;
+
+   assert(psSample != NULL);
+
+   MemProf_getStats(&psSample->stats);
+   info = mallinfo2();
+   psSample->heap = info.arena + info.hblkhd;
+   psSample->inUse = info.uordblks + info.hblkhd;
+   (void)getrusage(RUSAGE_SELF, &usage);
+   psSample->peakRss = (size_t)usage.ru_maxrss * 1024;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns whether node uIndex of the tree of *psConfig is a file.
+  Only leaves are files, and a scattered share of them are.
+*/
+static int MemProf_isFile(const struct Config *psConfig,
+                          size_t uIndex) {
+   size_t uHash;
+
+   assert(psConfig != NULL);
+
+   /* The first child of node i is node i * fanout + 1. */
+   if (uIndex == 0 || uIndex * psConfig->fanout + 1 < psConfig->nodes)
+      return 0;
+   uHash = uIndex * (size_t)2654435761u;
+   return (double)(uHash % 1000) < psConfig->files * 1000.0;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Writes the path of node uIndex to path. The nodes are numbered
+  breadth first through a complete tree of the configured fanout, so
+  the parent of node i is node (i - 1) / fanout.
+*/
+static void MemProf_makePath(const struct Config *psConfig,
+                             size_t uIndex, char *path) {
+   size_t auAncestors[MAX_DEPTH];
+   size_t uDepth = 0;
+   size_t uLength;
+
+   assert(psConfig != NULL);
+   assert(path != NULL);
+
+   for (; uIndex != 0; uIndex = (uIndex - 1) / psConfig->fanout) {
+      assert(uDepth < MAX_DEPTH);
+      auAncestors[uDepth++] = uIndex;
+   }
+
+   strcpy(path, ROOT_NAME);
+   uLength = strlen(ROOT_NAME);
+   while (uDepth > 0) {
+      uIndex = auAncestors[--uDepth];
+      uLength += (size_t)sprintf(path + uLength, "/%0*lx",
+         (int)psConfig->name,
+         (unsigned long)((uIndex - 1) % psConfig->fanout));
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Prints the header of the table of reports.
+*/
+static void MemProf_printHeader(void) {
+   int tag;
+
+   printf("%10s", "nodes");
+   for (tag = 0; tag < MEMPROF_NUM_TAGS; tag++)
+      printf(" %9s", MemProf_getTagName(tag));
+   printf(" %9s %9s %9s %6s %9s\n", "requested", "usable", "heap",
+          "frag%", "rss(MiB)");
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Prints the report for a tree of uNodes nodes using the memory of
+  *psSample, beyond that of *psBase. All but the last two columns are
+  bytes per node.
+*/
+static void MemProf_printRow(size_t uNodes,
+                             const struct Sample *psSample,
+                             const struct Sample *psBase) {
+   double nodes = (double)uNodes;
+   size_t uRequested = 0;
+   size_t uUsable = 0;
+   int tag;
+
+   assert(psSample != NULL);
+   assert(psBase != NULL);
+
+   printf("%10lu", (unsigned long)uNodes);
+   for (tag = 0; tag < MEMPROF_NUM_TAGS; tag++) {
+      printf(" %9.1f", (double)psSample->stats.requested[tag] / nodes);
+      uRequested += psSample->stats.requested[tag];
+      uUsable += psSample->stats.usable[tag];
+   }
+   printf(" %9.1f %9.1f %9.1f %6.1f %9.1f\n",
+          (double)uRequested / nodes, (double)uUsable / nodes,
+          (double)(psSample->heap - psBase->heap) / nodes,
+          100.0 * (double)(psSample->heap - psSample->inUse) /
+          (double)(psSample->heap ? psSample->heap : 1),
+          (double)psSample->peakRss / MIB);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Prints where the memory of a tree of uNodes nodes goes, scaled to a
+  million nodes, using the memory of *psSample beyond that of
+  *psBase.
+*/
+static void MemProf_printBreakdown(size_t uNodes,
+                                   const struct Sample *psSample,
+                                   const struct Sample *psBase) {
+   double scale = 1e6 / (double)uNodes;
+   size_t uBlocks = 0;
+   size_t uRequested = 0;
+   size_t uUsable = 0;
+   size_t uHeaders;
+   size_t uRss;
+   int tag;
+
+   assert(psSample != NULL);
+   assert(psBase != NULL);
+
+   for (tag = 0; tag < MEMPROF_NUM_TAGS; tag++) {
+      uBlocks += psSample->stats.blocks[tag];
+      uRequested += psSample->stats.requested[tag];
+      uUsable += psSample->stats.usable[tag];
+   }
+   uHeaders = uBlocks * PROFILER_HEADER_SIZE;
+   uRss = psSample->peakRss - psBase->peakRss;
+
+   printf("\nper million nodes:\n");
+   printf("%-18s %12s %14s %14s %7s\n", "subsystem", "blocks/node",
+          "requested(MiB)", "usable(MiB)", "share%");
+   for (tag = 0; tag < MEMPROF_NUM_TAGS; tag++)
+      printf("%-18s %12.3f %14.2f %14.2f %7.1f\n",
+             MemProf_getTagName(tag),
+             (double)psSample->stats.blocks[tag] / (double)uNodes,
+             (double)psSample->stats.requested[tag] * scale / MIB,
+             (double)psSample->stats.usable[tag] * scale / MIB,
+             100.0 * (double)psSample->stats.requested[tag] /
+             (double)(uRequested ? uRequested : 1));
+   printf("%-18s %12.3f %14.2f %14.2f %7.1f\n", "total",
+          (double)uBlocks / (double)uNodes,
+          (double)uRequested * scale / MIB,
+          (double)uUsable * scale / MIB, 100.0);
+
+   printf("\n%-34s %10.2f MiB\n", "malloc rounding and chunk slack",
+          (double)(uUsable - uRequested - uHeaders) * scale / MIB);
+   printf("%-34s %10.2f MiB\n", "profiler headers (not in prod)",
+          (double)uHeaders * scale / MIB);
+   printf("%-34s %10.2f MiB\n", "heap held from the system",
+          (double)(psSample->heap - psBase->heap) * scale / MIB);
+   printf("%-34s %10.2f MiB\n", "heap held but free",
+          (double)(psSample->heap - psSample->inUse) * scale / MIB);
+   printf("%-34s %10.2f MiB\n", "peak RSS growth",
+          (double)uRss * scale / MIB);
+   printf("%-34s %10.2f MiB\n", "peak RSS growth without profiler",
+          (double)(uRss > uHeaders ? uRss - uHeaders : 0) * scale /
+          MIB);
+   printf("%-34s %10.2f MiB\n", "peak requested",
+          (double)psSample->stats.peakRequested * scale / MIB);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Sets the field of *psConfig named by the argument arg, of the form
+  name=value. Returns 0 if successful, 1 if arg is not understood.
+*/
+static int MemProf_parseArg(struct Config *psConfig, const char *arg) {
+   const char *value;
+   size_t uNameLength;
+
+   assert(psConfig != NULL);
+   assert(arg != NULL);
+
+   value = strchr(arg, '=');
+   if (value == NULL)
+      return 1;
+   uNameLength = (size_t)(value - arg);
+   value++;
+
+   if (strncmp(arg, "nodes", uNameLength) == 0 && uNameLength == 5)
+      psConfig->nodes = (size_t)strtod(value, NULL);
+   else if (strncmp(arg, "fanout", uNameLength) == 0 &&
+            uNameLength == 6)
+      psConfig->fanout = (size_t)strtoul(value, NULL, 10);
+   else if (strncmp(arg, "files", uNameLength) == 0 && uNameLength == 5)
+      psConfig->files = strtod(value, NULL);
+   else if (strncmp(arg, "name", uNameLength) == 0 && uNameLength == 4)
+      psConfig->name = (size_t)strtoul(value, NULL, 10);
+   else if (strncmp(arg, "rows", uNameLength) == 0 && uNameLength == 4)
+      psConfig->rows = (size_t)strtoul(value, NULL, 10);
+   else
+      return 1;
+
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Prints how to call the program to stderr. Returns 1.
+*/
+static int MemProf_usage(const char *program) {
+   fprintf(stderr,
+           "usage: %s [name=value]...\n"
+           "  nodes=N     nodes the tree is grown to (1000000)\n"
+           "  fanout=F    children per directory, 2 or more (8)\n"
+           "  files=R     fraction of leaves that are files (0.75)\n"
+           "  name=L      name length, 1-255 (8)\n"
+           "  rows=K      reports while growing (10)\n",
+           program);
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Grows a complete File Tree breadth first to the size and shape
+  given by the name=value arguments, reporting along the way the
+  bytes per node taken by each subsystem, by all requests, by malloc
+  and from the system, with the heap's fragmentation and the peak
+  resident set size. Ends with the breakdown scaled to a million
+  nodes, then destroys the tree and checks that no block of the
+  profiled subsystems outlives it. Returns 0 if successful, 1
+  otherwise.
+*/
+int main(int argc, char *argv[]) {
+   static char acPath[PATH_SIZE];
+   static char acContents[1];
+   struct Config sConfig;
+   struct Sample sBase;
+   struct Sample sSample;
+   size_t uNextRow;
+   size_t uRow = 1;
+   size_t i;
+   int tag;
+   int status = 0;
+
+   sConfig.nodes = 1000000;
+   sConfig.fanout = 8;
+   sConfig.files = 0.75;
+   sConfig.name = 8;
+   sConfig.rows = 10;
+
+   for (i = 1; i < (size_t)argc; i++)
+      if (MemProf_parseArg(&sConfig, argv[i]) != 0)
+         return MemProf_usage(argv[0]);
+   if (sConfig.nodes == 0 || sConfig.fanout < 2 ||
+       sConfig.files < 0.0 || sConfig.files > 1.0 ||
+       sConfig.name == 0 || sConfig.name > 255 || sConfig.rows == 0)
+      return MemProf_usage(argv[0]);
+
+   printf("nodes=%lu fanout=%lu files=%.2f name=%lu\n",
+          (unsigned long)sConfig.nodes, (unsigned long)sConfig.fanout,
+          sConfig.files, (unsigned long)sConfig.name);
+   printf("columns before requested are bytes per node by "
+          "subsystem\n\n");
+
+   MemProf_sample(&sBase);
+   (void)FT_init();
+   MemProf_printHeader();
+
+   uNextRow = sConfig.nodes / sConfig.rows;
+   for (i = 0; i < sConfig.nodes; i++) {
+      MemProf_makePath(&sConfig, i, acPath);
+      if (MemProf_isFile(&sConfig, i))
+         status = FT_insertFile(acPath, acContents, 0);
+      else
+         status = FT_insertDir(acPath);
+      if (status != SUCCESS) {
+         fprintf(stderr, "Inserting %s returned %d\n", acPath,
+                 status);
+         (void)FT_destroy();
+         return 1;
+      }
+
+      if (i + 1 == uNextRow || i + 1 == sConfig.nodes) {
+         MemProf_sample(&sSample);
+         MemProf_printRow(i + 1, &sSample, &sBase);
+         uRow++;
+         uNextRow = sConfig.nodes / sConfig.rows * uRow;
+      }
+   }
+
+   MemProf_printBreakdown(sConfig.nodes, &sSample, &sBase);
+
+   status = 0;
+   (void)FT_destroy();
+   MemProf_getStats(&sSample.stats);
+   for (tag = 0; tag < MEMPROF_NUM_TAGS; tag++)
+      if (tag != MEMPROF_OTHER && sSample.stats.blocks[tag] != 0) {
+         fprintf(stderr, "%lu blocks of %s outlived FT_destroy\n",
+                 (unsigned long)sSample.stats.blocks[tag],
+                 MemProf_getTagName(tag));
+         status = 1;
+      }
+   return status;
+}
@@ -0,0 +1,405 @@
+/*--------------------------------------------------------------------*/
+/* ft_replay.c                                                        */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "counters.h"
+#include "ft.h"
+#include "trace.h"
+
+/*--------------------------------------------------------------------*/
+/* Printable names of the FT functions, by FT_OP_ value. */
+static const char *opNames[FT_NUM_OPS] = {
+   "FT_init", "FT_destroy", "FT_insertDir", "FT_insertFile",
+   "FT_containsDir", "FT_containsFile", "FT_rmDir", "FT_rmFile",
+   "FT_getFileContents", "FT_replaceFileContents", "FT_stat",
+   "FT_toString", "FT_move", "FT_copy", "FT_glob", "FT_listDir",
+   "FT_statEx", "FT_findByName", "FT_findByNamePrefix", "FT_scanRange",
+   "FT_grep", "FT_filesBySize", "FT_largestFiles", "FT_nth", "FT_rank"
+};
+
+/* A trace read into memory, so that replaying it does no I/O. */
+struct Trace {
+   /* The records, whose paths are not set until reading is done. */
+   struct TraceRecord *records;
+   /* The offset in text of each record's path, which its second
+      path, if any, follows. */
+   size_t *offsets;
+   size_t length;
+   size_t size;
+   /* The text of all paths, each followed by '\0'. */
+   char *text;
+   size_t textLength;
+   size_t textSize;
+};
+
+/* The totals of one FT function over a replay. */
+struct Totals {
+   /* The number of calls. */
+   uint64_t calls;
+   /* The nanoseconds taken when replayed and when recorded. */
+   uint64_t replayed;
+   uint64_t recorded;
+   /* The number of calls whose result or length differed. */
+   uint64_t mismatches;
+};
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the current time in nanoseconds from a monotonic clock.
+*/
+static uint64_t Replay_nanoseconds(void) {
+   struct timespec now;
+
+   (void)clock_gettime(CLOCK_MONOTONIC, &now);
+   return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Appends *psRecord, with copies of its paths, to *psTrace.
+  Returns 1 if successful, 0 if there is an allocation error.
+*/
+static int Replay_add(struct Trace *psTrace,
+                      const struct TraceRecord *psRecord) {
+   size_t uPathSize = 0;
+   size_t uPath2Size = 0;
+   size_t uNewSize;
+   void *pvNew;
+
+   assert(psTrace != NULL);
+   assert(psRecord != NULL);
+
+   if (psTrace->length == psTrace->size) {
+      uNewSize = 2 * psTrace->size + 16;
+      pvNew = realloc(psTrace->records,
+                      uNewSize * sizeof(struct TraceRecord));
+      if (pvNew == NULL)
+         return 0;
+      psTrace->records = pvNew;
+      pvNew = realloc(psTrace->offsets, uNewSize * sizeof(size_t));
+      if (pvNew == NULL)
+         return 0;
+      psTrace->offsets = pvNew;
+      psTrace->size = uNewSize;
+   }
+
+   if (psRecord->path != NULL) {
+      uPathSize = strlen(psRecord->path) + 1;
+      if (psRecord->path2 != NULL)
+         uPath2Size = strlen(psRecord->path2) + 1;
+      if (psTrace->textLength + uPathSize + uPath2Size >
+          psTrace->textSize) {
+         uNewSize = 2 * psTrace->textSize + uPathSize + uPath2Size;
+         pvNew = realloc(psTrace->text, uNewSize);
+         if (pvNew == NULL)
+            return 0;
+         psTrace->text = pvNew;
+         psTrace->textSize = uNewSize;
+      }
+      memcpy(psTrace->text + psTrace->textLength, psRecord->path,
+             uPathSize);
+      if (psRecord->path2 != NULL)
+         memcpy(psTrace->text + psTrace->textLength + uPathSize,
+                psRecord->path2, uPath2Size);
+   }
+
+   psTrace->records[psTrace->length] = *psRecord;
+   psTrace->offsets[psTrace->length] = psTrace->textLength;
+   psTrace->length++;
+   psTrace->textLength += uPathSize + uPath2Size;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Reads the trace in the file named filename into *psTrace, which
+  must be zeroed. Returns 0 if successful, 1 otherwise, after
+  reporting the problem to stderr.
+*/
+static int Replay_load(struct Trace *psTrace, const char *filename) {
+   struct TraceRecord record;
+   struct TraceRecord *psRecord;
+   FILE *psFile;
+   char *pcPath = NULL;
+   size_t uPathSize = 0;
+   size_t i;
+   int iStatus;
+
+   assert(psTrace != NULL);
+   assert(filename != NULL);
+
+   psFile = fopen(filename, "rb");
+   if (psFile == NULL) {
+      fprintf(stderr, "Cannot open %s\n", filename);
+      return 1;
+   }
+   if (!Trace_readHeader(psFile)) {
+      fprintf(stderr, "%s is not an FT trace\n", filename);
+      (void)fclose(psFile);
+      return 1;
+   }
+
+   while ((iStatus = Trace_read(psFile, &record, &pcPath,
+                                &uPathSize)) == 1)
+      if (!Replay_add(psTrace, &record)) {
+         iStatus = -1;
+         break;
+      }
+   free(pcPath);
+   (void)fclose(psFile);
+
+   if (iStatus != 0) {
+      fprintf(stderr, "%s is malformed after %lu records, or there "
+              "is insufficient memory\n", filename,
+              (unsigned long)psTrace->length);
+      return 1;
+   }
+
+   /* The text has stopped moving, so the paths can be set. */
+   for (i = 0; i < psTrace->length; i++) {
+      psRecord = &psTrace->records[i];
+      if (Trace_hasPath(psRecord->op))
+         psRecord->path = psTrace->text + psTrace->offsets[i];
+      if (Trace_hasSecondPath(psRecord->op))
+         psRecord->path2 = psRecord->path + strlen(psRecord->path) + 1;
+   }
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Calls the FT function of *psRecord with its arguments, adding the
+  time taken to asTotals and counting a mismatch if the result or
+  length differs from the recorded one.
+*/
+static void Replay_call(const struct TraceRecord *psRecord,
+                        struct Totals asTotals[FT_NUM_OPS]) {
+   /* Stands in for the recorded contents, which are not in traces. */
+   static char acContents[1];
+   void *pvContents;
+   char *path;
+   boolean type = FALSE;
+   size_t length = 0;
+   uint64_t result = 0;
+   uint64_t start;
+   int op;
+
+   assert(psRecord != NULL);
+
+   op = psRecord->op;
+   path = (char *)psRecord->path;
+   pvContents = psRecord->hasContents ? acContents : NULL;
+
+   start = Replay_nanoseconds();
+   if (op == FT_OP_INIT)
+      result = (uint64_t)FT_init();
+   else if (op == FT_OP_DESTROY)
+      result = (uint64_t)FT_destroy();
+   else if (op == FT_OP_INSERT_DIR)
+      result = (uint64_t)FT_insertDir(path);
+   else if (op == FT_OP_INSERT_FILE) {
+      length = (size_t)psRecord->length;
+      result = (uint64_t)FT_insertFile(path, pvContents, length);
+   }
+   else if (op == FT_OP_CONTAINS_DIR)
+      result = (uint64_t)FT_containsDir(path);
+   else if (op == FT_OP_CONTAINS_FILE)
+      result = (uint64_t)FT_containsFile(path);
+   else if (op == FT_OP_RM_DIR)
+      result = (uint64_t)FT_rmDir(path);
+   else if (op == FT_OP_RM_FILE)
+      result = (uint64_t)FT_rmFile(path);
+   else if (op == FT_OP_GET_CONTENTS)
+      result = (FT_getFileContents(path) != NULL);
+   else if (op == FT_OP_REPLACE_CONTENTS) {
+      length = (size_t)psRecord->length;
+      result = (FT_replaceFileContents(path, pvContents, length)
+                != NULL);
+   }
+   else if (op == FT_OP_STAT) {
+      result = (uint64_t)FT_stat(path, &type, &length);
+      if (result != SUCCESS || !type)
+         length = 0;
+   }
+   else if (op == FT_OP_MOVE)
+      result = (uint64_t)FT_move(path, (char *)psRecord->path2);
+   else if (op == FT_OP_COPY)
+      result = (uint64_t)FT_copy(path, (char *)psRecord->path2);
+   else {
+      path = FT_toString();
+      result = (path != NULL);
+      if (path != NULL)
+         length = strlen(path);
+      free(path);
+   }
+   asTotals[op].replayed += Replay_nanoseconds() - start;
+
+   asTotals[op].calls++;
+   asTotals[op].recorded += psRecord->nanoseconds;
+   if (result != psRecord->result || length != psRecord->length)
+      asTotals[op].mismatches++;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Explains the lookup of the path of *psRecord, if it has one, keeping
+  the explanation in *psWorst if its lookup read more bytes than that
+  of any record before it.
+*/
+static void Replay_explain(const struct TraceRecord *psRecord,
+                           struct Explain *psWorst,
+                           const char **ppcWorstPath) {
+   struct Explain explain;
+
+   assert(psRecord != NULL);
+   assert(psWorst != NULL);
+   assert(ppcWorstPath != NULL);
+
+   if (psRecord->path == NULL)
+      return;
+
+   (void)FT_explain((char *)psRecord->path, &explain);
+   if (explain.counters.counts[COUNTER_BYTES] >
+       psWorst->counters.counts[COUNTER_BYTES]) {
+      *psWorst = explain;
+      *ppcWorstPath = psRecord->path;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Prints the mean work per call of each FT function called in
+  asTotals, then the lookup in *psWorst of the path pcWorstPath.
+*/
+static void Replay_printWork(const struct Totals asTotals[FT_NUM_OPS],
+                             const struct Explain *psWorst,
+                             const char *pcWorstPath) {
+   struct Counters asCounters[FT_NUM_OPS];
+   int counter;
+   int op;
+
+   assert(psWorst != NULL);
+
+   FT_getCounters(asCounters);
+
+   printf("\n%-24s", "work per call");
+   for (counter = 0; counter < COUNTER_NUM; counter++)
+      printf(" %12s", Counters_getName(counter));
+   printf("\n");
+   for (op = 0; op < FT_NUM_OPS; op++) {
+      if (asTotals[op].calls == 0)
+         continue;
+      printf("%-24s", opNames[op]);
+      for (counter = 0; counter < COUNTER_NUM; counter++)
+         printf(" %12.1f", (double)asCounters[op].counts[counter] /
+                (double)asTotals[op].calls);
+      printf("\n");
+   }
+
+   if (pcWorstPath == NULL)
+      return;
+   printf("\ncostliest lookup: %s\n", pcWorstPath);
+   for (counter = 0; counter < COUNTER_NUM; counter++)
+      printf("  %-12s %lu\n", Counters_getName(counter),
+             (unsigned long)psWorst->counters.counts[counter]);
+   printf("  depth %lu; costliest directory %.*s with %lu children, "
+          "%lu bytes read\n", (unsigned long)psWorst->depth,
+          (int)psWorst->worstLength, pcWorstPath,
+          (unsigned long)psWorst->worstChildren,
+          (unsigned long)psWorst->worstBytes);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Prints one row of the report, for the function called name.
+*/
+static void Replay_printRow(const char *name,
+                            const struct Totals *psTotals) {
+   assert(name != NULL);
+   assert(psTotals != NULL);
+
+   printf("%-24s %10lu %12.3f %12.3f %8.2f %10lu\n", name,
+          (unsigned long)psTotals->calls,
+          (double)psTotals->replayed / 1e6,
+          (double)psTotals->recorded / 1e6,
+          (double)psTotals->recorded /
+          (double)(psTotals->replayed ? psTotals->replayed : 1),
+          (unsigned long)psTotals->mismatches);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Replays the trace file named by the first argument against the FT
+  implementation this program is linked with, as many times as the
+  optional second argument says (1 by default), destroying the FT
+  between runs. Prints, for each FT function, the calls, the time
+  they took when replayed and when recorded, the speedup of the
+  replay, and the number of calls whose results differed from the
+  recording. Returns 0 if every result matched, 1 otherwise.
+
+  In builds with -DFT_COUNTERS, also prints the work each function
+  took per call, and explains the costliest lookup of the replay.
+*/
+int main(int argc, char *argv[]) {
+   static struct Totals asTotals[FT_NUM_OPS];
+   struct Explain sWorst;
+   const char *pcWorstPath = NULL;
+   struct Totals sAll;
+   struct Trace sTrace;
+   unsigned long ulRuns = 1;
+   unsigned long ulRun;
+   size_t i;
+   int op;
+
+   if (argc != 2 && argc != 3) {
+      fprintf(stderr, "usage: %s trace [runs]\n", argv[0]);
+      return 1;
+   }
+   if (argc == 3)
+      ulRuns = strtoul(argv[2], NULL, 10);
+
+   memset(&sTrace, 0, sizeof(sTrace));
+   if (Replay_load(&sTrace, argv[1]) != 0)
+      return 1;
+
+   memset(&sWorst, 0, sizeof(sWorst));
+   for (ulRun = 0; ulRun < ulRuns; ulRun++) {
+      for (i = 0; i < sTrace.length; i++) {
+         if (COUNTERS_ENABLED)
+            Replay_explain(&sTrace.records[i], &sWorst, &pcWorstPath);
+         Replay_call(&sTrace.records[i], asTotals);
+      }
+      (void)FT_destroy();
+   }
+
+   memset(&sAll, 0, sizeof(sAll));
+   printf("%-24s %10s %12s %12s %8s %10s\n", "operation", "calls",
+          "replay(ms)", "record(ms)", "speedup", "mismatches");
+   for (op = 0; op < FT_NUM_OPS; op++) {
+      if (asTotals[op].calls == 0)
+         continue;
+      Replay_printRow(opNames[op], &asTotals[op]);
+      sAll.calls += asTotals[op].calls;
+      sAll.replayed += asTotals[op].replayed;
+      sAll.recorded += asTotals[op].recorded;
+      sAll.mismatches += asTotals[op].mismatches;
+   }
+   Replay_printRow("total", &sAll);
+   if (COUNTERS_ENABLED)
+      Replay_printWork(asTotals, &sWorst, pcWorstPath);
+
+   free(sTrace.records);
+   free(sTrace.offsets);
+   free(sTrace.text);
+   return sAll.mismatches != 0;
+}
@@ -0,0 +1,417 @@
+/*--------------------------------------------------------------------*/
+/* grep.c                                                             */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dynarray.h"
+#include "grep.h"
+#include "node.h"
+#include "threadpool.h"
+
+/* The runs of files each worker searches, to even out their sizes. */
+enum { RUNS_PER_WORKER = 8 };
+
+/* The fewest bytes worth spreading over the ThreadPool. */
+enum { MIN_PARALLEL_BYTES = 65536 };
+
+/* The atom of a regular pattern that matches any character. */
+enum { ANY_CHAR = -1 };
+
+/* The offset recorded for a file without a match. */
+#define NO_MATCH SIZE_MAX
+
+/*
+  The shared state of one grep: the files to search, their paths, the
+  pattern, and per file, the offset and length of its leftmost match.
+*/
+struct Grep {
+   DynArray_T files;
+   /* The paths of the files, in order, each ending in '\0': uPaths
+      bytes in a buffer of uPathsSize bytes. They are built as the
+      files are found, so that reporting allocates nothing. */
+   char *pcPaths;
+   size_t uPaths;
+   size_t uPathsSize;
+   /* The path of the node being visited, which may be reached
+      through the directory a copy copies, and the total length of
+      the files found so far. */
+   struct NodePath sPath;
+   size_t uBytes;
+   size_t uRuns;
+   const char *pcPattern;
+   boolean isRegex;
+   size_t *puOffsets;
+   size_t *puLengths;
+};
+
+/*--------------------------------------------------------------------*/
+/*
+  Stores in *piChar the character matched by the atom at the start of
+  the regular pattern pcPattern, or ANY_CHAR for '.', and returns the
+  atom's length. pcPattern must not be at its end.
+*/
+static size_t Grep_atom(const char *pcPattern, int *piChar) {
+   assert(pcPattern != NULL);
+   assert(*pcPattern != '\0');
+   assert(piChar != NULL);
+
+   if (pcPattern[0] == '\\' && pcPattern[1] != '\0') {
+      *piChar = (unsigned char)pcPattern[1];
+      return 2;
+   }
+   if (pcPattern[0] == '.')
+      *piChar = ANY_CHAR;
+   else
+      *piChar = (unsigned char)pcPattern[0];
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns whether the atom character iChar, as Grep_atom stores it,
+  matches the character c.
+*/
+static boolean Grep_atomMatches(int iChar, char c) {
+   if (iChar == ANY_CHAR)
+      return (boolean)(c != '\n');
+   return (boolean)((unsigned char)c == iChar);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Matches the regular pattern pcPattern, without a leading '^',
+  against the text starting at pcText and ending before pcEnd.
+  Returns the end of the match, or NULL if there is none.
+*/
+static const char *Grep_matchHere(const char *pcPattern,
+                                  const char *pcText,
+                                  const char *pcEnd) {
+   const char *pcRun;
+   const char *pcMatch;
+   size_t uAtom;
+   int iChar;
+
+   assert(pcPattern != NULL);
+   assert(pcText != NULL);
+   assert(pcEnd != NULL);
+
+   for (;;) {
+      if (*pcPattern == '\0')
+         return pcText;
+      if (pcPattern[0] == '$' && pcPattern[1] == '\0') {
+         if (pcText == pcEnd || *pcText == '\n')
+            return pcText;
+         return NULL;
+      }
+
+      uAtom = Grep_atom(pcPattern, &iChar);
+      if (pcPattern[uAtom] == '*') {
+         /* Take the longest run, then give it back a character at a
+            time until the rest matches. */
+         for (pcRun = pcText;
+              pcRun < pcEnd && Grep_atomMatches(iChar, *pcRun);
+              pcRun++)
+            ;
+         for (;;) {
+            pcMatch = Grep_matchHere(pcPattern + uAtom + 1, pcRun,
+                                     pcEnd);
+            if (pcMatch != NULL || pcRun == pcText)
+               return pcMatch;
+            pcRun--;
+         }
+      }
+
+      if (pcText == pcEnd || !Grep_atomMatches(iChar, *pcText))
+         return NULL;
+      pcPattern += uAtom;
+      pcText++;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Searches the text from pcText to pcEnd for the leftmost match of the
+  regular pattern pcPattern. If there is one, stores its start in
+  *ppcStart and its end in *ppcEnd and returns TRUE; otherwise returns
+  FALSE.
+*/
+static boolean Grep_searchRegex(const char *pcPattern,
+                                const char *pcText, const char *pcEnd,
+                                const char **ppcStart,
+                                const char **ppcEnd) {
+   const char *pcPos = pcText;
+   const char *pcMatch;
+   size_t uAtom = 0;
+   int iChar = ANY_CHAR;
+   boolean isAnchored;
+
+   assert(pcPattern != NULL);
+   assert(pcText != NULL);
+   assert(pcEnd != NULL);
+   assert(ppcStart != NULL);
+   assert(ppcEnd != NULL);
+
+   isAnchored = (boolean)(*pcPattern == '^');
+   if (isAnchored)
+      pcPattern++;
+
+   /* A match must start with the first atom's character, unless it
+      is '.', starred or absent. */
+   if (*pcPattern != '\0' && strcmp(pcPattern, "$") != 0)
+      uAtom = Grep_atom(pcPattern, &iChar);
+   if (uAtom == 0 || pcPattern[uAtom] == '*')
+      iChar = ANY_CHAR;
+
+   for (;;) {
+      if (iChar != ANY_CHAR && !isAnchored) {
+         pcPos = memchr(pcPos, iChar, (size_t)(pcEnd - pcPos));
+         if (pcPos == NULL)
+            return FALSE;
+      }
+
+      pcMatch = Grep_matchHere(pcPattern, pcPos, pcEnd);
+      if (pcMatch != NULL) {
+         *ppcStart = pcPos;
+         *ppcEnd = pcMatch;
+         return TRUE;
+      }
+
+      /* An anchored match can only start a line. */
+      if (isAnchored) {
+         pcPos = memchr(pcPos, '\n', (size_t)(pcEnd - pcPos));
+         if (pcPos == NULL)
+            return FALSE;
+      }
+      else if (pcPos == pcEnd)
+         return FALSE;
+      pcPos++;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Searches the text from pcText to pcEnd for the leftmost occurrence
+  of the literal pattern pcPattern. Returns its start, or NULL if
+  there is none.
+*/
+static const char *Grep_searchLiteral(const char *pcPattern,
+                                      const char *pcText,
+                                      const char *pcEnd) {
+   const char *pcPos = pcText;
+   size_t uPattern;
+
+   assert(pcPattern != NULL);
+   assert(pcText != NULL);
+   assert(pcEnd != NULL);
+
+   uPattern = strlen(pcPattern);
+   if (uPattern == 0)
+      return pcText;
+
+   /* Only positions holding the first byte can start a match, and
+      none within uPattern - 1 bytes of the end. */
+   while ((size_t)(pcEnd - pcPos) >= uPattern) {
+      pcPos = memchr(pcPos, (unsigned char)*pcPattern,
+                     (size_t)(pcEnd - pcPos) - uPattern + 1);
+      if (pcPos == NULL)
+         return NULL;
+      if (memcmp(pcPos + 1, pcPattern + 1, uPattern - 1) == 0)
+         return pcPos;
+      pcPos++;
+   }
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+int Grep_search(const char *pcPattern, boolean isRegex,
+                const void *pvText, size_t uLength,
+                size_t *puOffset, size_t *puLength) {
+   const char *pcText = pvText;
+   const char *pcStart;
+   const char *pcEnd;
+
+   assert(pcPattern != NULL);
+   assert(pvText != NULL || uLength == 0);
+   assert(puOffset != NULL);
+   assert(puLength != NULL);
+
+   if (pcText == NULL)
+      pcText = "";
+
+   if (isRegex) {
+      if (!Grep_searchRegex(pcPattern, pcText, pcText + uLength,
+                            &pcStart, &pcEnd))
+         return FALSE;
+   }
+   else {
+      pcStart = Grep_searchLiteral(pcPattern, pcText,
+                                   pcText + uLength);
+      if (pcStart == NULL)
+         return FALSE;
+      pcEnd = pcStart + strlen(pcPattern);
+   }
+
+   *puOffset = (size_t)(pcStart - pcText);
+   *puLength = (size_t)(pcEnd - pcStart);
+   return TRUE;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Adds the file n, whose path is that of *psGrep, to its files, its
+  path to their paths, and its length to their total length. Returns
+  FALSE if insufficient memory is available, and TRUE otherwise.
+*/
+static boolean Grep_addFile(struct Grep *psGrep, Node n) {
+   size_t uSize;
+   char *pcPaths;
+
+   assert(psGrep != NULL);
+   assert(n != NULL);
+
+   uSize = psGrep->uPathsSize;
+   while (psGrep->uPaths + psGrep->sPath.length + 1 > uSize)
+      uSize = (uSize == 0) ? 256 : 2 * uSize;
+   if (uSize != psGrep->uPathsSize) {
+      pcPaths = realloc(psGrep->pcPaths, uSize);
+      if (pcPaths == NULL)
+         return FALSE;
+      psGrep->pcPaths = pcPaths;
+      psGrep->uPathsSize = uSize;
+   }
+
+   if (!DynArray_add(psGrep->files, n))
+      return FALSE;
+   strcpy(psGrep->pcPaths + psGrep->uPaths, psGrep->sPath.text);
+   psGrep->uPaths += psGrep->sPath.length + 1;
+   psGrep->uBytes += Node_getLength(n);
+   return TRUE;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Adds the files of the tree rooted at n, whose path is that of
+  *psGrep, to its files in pre-order, reading a copy's children
+  through the directory it copies. Returns FALSE if insufficient
+  memory is available, and TRUE otherwise.
+*/
+static boolean Grep_collect(struct Grep *psGrep, Node n) {
+   size_t uPath;
+   size_t c;
+
+   assert(psGrep != NULL);
+   assert(n != NULL);
+
+   if (Node_getType(n) == FIL)
+      return Grep_addFile(psGrep, n);
+
+   n = Node_getShared(n);
+   uPath = psGrep->sPath.length;
+   for (c = 0; c < Node_getNumChildren(n); c++) {
+      if (Node_appendName(Node_getChild(n, c), &psGrep->sPath) !=
+          SUCCESS || !Grep_collect(psGrep, Node_getChild(n, c)))
+         return FALSE;
+      Node_truncatePath(&psGrep->sPath, uPath);
+   }
+   return TRUE;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Searches the uRun'th run of files of the Grep at pvGrep, recording
+  each file's leftmost match. Runs as a ThreadPool task.
+*/
+static void Grep_runTask(size_t uRun, size_t uWorker, void *pvGrep) {
+   struct Grep *psGrep = pvGrep;
+   size_t uFiles;
+   size_t uLast;
+   size_t i;
+   Node n;
+
+   assert(psGrep != NULL);
+   (void)uWorker;
+
+   uFiles = DynArray_getLength(psGrep->files);
+   uLast = (uRun + 1) * uFiles / psGrep->uRuns;
+   for (i = uRun * uFiles / psGrep->uRuns; i < uLast; i++) {
+      n = DynArray_get(psGrep->files, i);
+      if (!Grep_search(psGrep->pcPattern, psGrep->isRegex,
+                       Node_getFileContents(n), Node_getLength(n),
+                       &psGrep->puOffsets[i], &psGrep->puLengths[i]))
+         psGrep->puOffsets[i] = NO_MATCH;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+int Grep_find(struct node *root, const char *pcPattern,
+              boolean isRegex,
+              void (*pfMatch)(const char *pcPath, size_t uOffset,
+                              size_t uLength, void *pvExtra),
+              void *pvExtra) {
+   struct Grep sGrep;
+   const char *pcPath;
+   size_t uFiles;
+   size_t i;
+
+   assert(pcPattern != NULL);
+   assert(pfMatch != NULL);
+
+   if (root == NULL)
+      return SUCCESS;
+
+   memset(&sGrep, 0, sizeof(sGrep));
+   sGrep.files = DynArray_new(0);
+   if (sGrep.files == NULL)
+      return MEMORY_ERROR;
+   if (Node_appendName(root, &sGrep.sPath) != SUCCESS ||
+       !Grep_collect(&sGrep, root)) {
+      free(sGrep.sPath.text);
+      free(sGrep.pcPaths);
+      DynArray_free(sGrep.files);
+      return MEMORY_ERROR;
+   }
+   free(sGrep.sPath.text);
+
+   uFiles = DynArray_getLength(sGrep.files);
+   sGrep.pcPattern = pcPattern;
+   sGrep.isRegex = isRegex;
+   sGrep.puOffsets = calloc(uFiles + 1, sizeof(size_t));
+   sGrep.puLengths = calloc(uFiles + 1, sizeof(size_t));
+   if (sGrep.puOffsets == NULL || sGrep.puLengths == NULL) {
+      free(sGrep.puOffsets);
+      free(sGrep.puLengths);
+      free(sGrep.pcPaths);
+      DynArray_free(sGrep.files);
+      return MEMORY_ERROR;
+   }
+
+   /* Small greps are searched by the caller alone. */
+   sGrep.uRuns = 1;
+   if (sGrep.uBytes >= MIN_PARALLEL_BYTES)
+      sGrep.uRuns = ThreadPool_getNumWorkers() * RUNS_PER_WORKER;
+   if (sGrep.uRuns > uFiles)
+      sGrep.uRuns = uFiles;
+   if (sGrep.uRuns == 1)
+      Grep_runTask(0, 0, &sGrep);
+   else if (sGrep.uRuns > 1)
+      ThreadPool_run(sGrep.uRuns, Grep_runTask, &sGrep);
+
+   pcPath = sGrep.pcPaths;
+   for (i = 0; i < uFiles; i++) {
+      if (sGrep.puOffsets[i] != NO_MATCH)
+         pfMatch(pcPath, sGrep.puOffsets[i], sGrep.puLengths[i],
+                 pvExtra);
+      pcPath += strlen(pcPath) + 1;
+   }
+
+   free(sGrep.pcPaths);
+   free(sGrep.puOffsets);
+   free(sGrep.puLengths);
+   DynArray_free(sGrep.files);
+   return SUCCESS;
+}
@@ -0,0 +1,65 @@
+/*--------------------------------------------------------------------*/
+/* grep.h                                                             */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#ifndef GREP_INCLUDED
+#define GREP_INCLUDED
+
+#include <stddef.h>
+
+#include "a4def.h"
+
+/*
+  A grep searches the contents of every file of a subtree for a
+  pattern. A literal pattern matches its exact bytes. A regular
+  pattern is a simple regular expression: 'c' matches the character
+  c, '.' matches any character but a newline, '*' after any of these
+  matches zero or more of it, '\' makes the next character literal, a
+  leading '^' matches the start of a line and a trailing '$' the end
+  of one. Lines end at newlines, and contents are searched as bytes,
+  so they need not be text.
+
+  The files are found in pre-order, then searched in contiguous runs
+  spread over the ThreadPool, each run by one worker, and the matches
+  are reported afterwards, in order, by the calling thread. Each
+  search finds its first candidate byte with memchr, which the C
+  library scans a word or a vector at a time, so only positions that
+  can start a match are compared.
+*/
+
+/* The Node type of node.h, which clients need not see. */
+struct node;
+
+/*--------------------------------------------------------------------*/
+/*
+  Searches pvText, uLength bytes, for the leftmost match of pcPattern,
+  a regular pattern if isRegex is TRUE and a literal one otherwise. If
+  there is one, stores its offset in *puOffset and its length in
+  *puLength and returns 1 (TRUE); otherwise returns 0 (FALSE). pvText
+  may be NULL if uLength is 0. Of the matches that start at the same
+  offset, the one found gives each '*' as many characters as allow
+  the rest to match.
+*/
+int Grep_search(const char *pcPattern, boolean isRegex,
+                const void *pvText, size_t uLength,
+                size_t *puOffset, size_t *puLength);
+
+/*--------------------------------------------------------------------*/
+/*
+  Calls pfMatch, for each file of the tree rooted at root that
+  contains a match of pcPattern, as Grep_search finds, with the
+  file's path, the offset and length of its leftmost match, and
+  pvExtra. root may be a file, and may be NULL. Files are reported in
+  pre-order, files before directories and each in sorted order, and
+  pfMatch must not change the tree. Returns SUCCESS, or MEMORY_ERROR
+  if the search cannot allocate its state, in which case no match is
+  reported.
+*/
+int Grep_find(struct node *root, const char *pcPattern,
+              boolean isRegex,
+              void (*pfMatch)(const char *pcPath, size_t uOffset,
+                              size_t uLength, void *pvExtra),
+              void *pvExtra);
+
+#endif
@@ -0,0 +1,204 @@
+/*--------------------------------------------------------------------*/
+/* memprof.c                                                          */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <malloc.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "memprof.h"
+
+/* The bytes of each block's header, kept at a multiple of malloc's
+   alignment so the block after it is aligned too. */
+enum { HEADER_SIZE = 16 };
+
+/* What the header of each block records. */
+struct Header {
+   size_t size;
+   size_t tag;
+};
+
+/* The allocator being wrapped, as named by the linker. */
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+/* The replacements, as named for the linker. */
+void *__wrap_malloc(size_t size);
+void *__wrap_calloc(size_t count, size_t size);
+void *__wrap_realloc(void *ptr, size_t size);
+void __wrap_free(void *ptr);
+
+/*--------------------------------------------------------------------*/
+/* The profiler is an Abstract Object with the following state: */
+
+int MemProf_nextTag;
+
+/* The live counts by tag, updated atomically as worker threads may
+   allocate too. */
+static size_t blocks[MEMPROF_NUM_TAGS];
+static size_t requested[MEMPROF_NUM_TAGS];
+static size_t usable[MEMPROF_NUM_TAGS];
+
+/* The total requested bytes live, and the most there have been. */
+static size_t totalRequested;
+static size_t peakRequested;
+
+/* Printable names of the tags. */
+static const char *tagNames[MEMPROF_NUM_TAGS] = {
+   "other", "nodes", "paths", "arrayhdrs", "arraydata", "arraykeys"
+};
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the tag for a new block, consuming the mark set by
+  MEMPROF_TAG.
+*/
+static size_t MemProf_takeTag(void) {
+   int tag = MemProf_nextTag;
+
+   MemProf_nextTag = MEMPROF_OTHER;
+   if (tag < 0 || tag >= MEMPROF_NUM_TAGS)
+      return MEMPROF_OTHER;
+   return (size_t)tag;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Counts the block whose header is at psHeader, given its requested
+  size and tag, as live.
+*/
+static void MemProf_add(struct Header *psHeader, size_t size,
+                        size_t tag) {
+   size_t uTotal;
+   size_t uPeak;
+
+   psHeader->size = size;
+   psHeader->tag = tag;
+
+   (void)__sync_fetch_and_add(&blocks[tag], 1);
+   (void)__sync_fetch_and_add(&requested[tag], size);
+   (void)__sync_fetch_and_add(&usable[tag],
+                              malloc_usable_size(psHeader));
+   uTotal = __sync_add_and_fetch(&totalRequested, size);
+
+   /* Raise the peak unless another thread raised it higher. */
+   uPeak = peakRequested;
+   while (uTotal > uPeak &&
+          !__sync_bool_compare_and_swap(&peakRequested, uPeak, uTotal))
+      uPeak = peakRequested;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Stops counting the block whose header is at psHeader.
+*/
+static void MemProf_remove(struct Header *psHeader) {
+   size_t tag = psHeader->tag;
+
+   (void)__sync_fetch_and_sub(&blocks[tag], 1);
+   (void)__sync_fetch_and_sub(&requested[tag], psHeader->size);
+   (void)__sync_fetch_and_sub(&usable[tag],
+                              malloc_usable_size(psHeader));
+   (void)__sync_fetch_and_sub(&totalRequested, psHeader->size);
+}
+
+/*--------------------------------------------------------------------*/
+void *__wrap_malloc(size_t size) {
+   struct Header *psHeader;
+   size_t tag = MemProf_takeTag();
+
+   if (size > SIZE_MAX - HEADER_SIZE)
+      return NULL;
+   psHeader = __real_malloc(HEADER_SIZE + size);
+   if (psHeader == NULL)
+      return NULL;
+
+   MemProf_add(psHeader, size, tag);
+   return (char *)psHeader + HEADER_SIZE;
+}
+
+/*--------------------------------------------------------------------*/
+void *__wrap_calloc(size_t count, size_t size) {
+   struct Header *psHeader;
+   size_t tag = MemProf_takeTag();
+
+   if (size != 0 && count > (SIZE_MAX - HEADER_SIZE) / size)
+      return NULL;
+   psHeader = __real_calloc(1, HEADER_SIZE + count * size);
+   if (psHeader == NULL)
+      return NULL;
+
+   MemProf_add(psHeader, count * size, tag);
+   return (char *)psHeader + HEADER_SIZE;
+}
+
+/*--------------------------------------------------------------------*/
+void *__wrap_realloc(void *ptr, size_t size) {
+   struct Header *psHeader;
+   struct Header *psNew;
+   size_t tag;
+
+   if (ptr == NULL)
+      return __wrap_malloc(size);
+   if (size == 0) {
+      __wrap_free(ptr);
+      return NULL;
+   }
+   if (size > SIZE_MAX - HEADER_SIZE)
+      return NULL;
+
+   /* A block keeps its tag unless the reallocation is marked. */
+   psHeader = (struct Header *)((char *)ptr - HEADER_SIZE);
+   tag = MemProf_takeTag();
+   if (tag == MEMPROF_OTHER)
+      tag = psHeader->tag;
+
+   MemProf_remove(psHeader);
+   psNew = __real_realloc(psHeader, HEADER_SIZE + size);
+   if (psNew == NULL) {
+      /* The old block is still live. */
+      MemProf_add(psHeader, psHeader->size, psHeader->tag);
+      return NULL;
+   }
+
+   MemProf_add(psNew, size, tag);
+   return (char *)psNew + HEADER_SIZE;
+}
+
+/*--------------------------------------------------------------------*/
+void __wrap_free(void *ptr) {
+   struct Header *psHeader;
+
+   if (ptr == NULL)
+      return;
+
+   psHeader = (struct Header *)((char *)ptr - HEADER_SIZE);
+   MemProf_remove(psHeader);
+   __real_free(psHeader);
+}
+
+/*--------------------------------------------------------------------*/
+void MemProf_getStats(struct MemProfStats *psStats) {
+   int tag;
+
+   assert(psStats != NULL);
+
+   for (tag = 0; tag < MEMPROF_NUM_TAGS; tag++) {
+      psStats->blocks[tag] = blocks[tag];
+      psStats->requested[tag] = requested[tag];
+      psStats->usable[tag] = usable[tag];
+   }
+   psStats->peakRequested = peakRequested;
+}
+
+/*--------------------------------------------------------------------*/
+const char *MemProf_getTagName(int tag) {
+   assert(tag >= 0 && tag < MEMPROF_NUM_TAGS);
+
+   return tagNames[tag];
+}
@@ -0,0 +1,64 @@
+/*--------------------------------------------------------------------*/
+/* memprof.h                                                          */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#ifndef MEMPROF_INCLUDED
+#define MEMPROF_INCLUDED
+
+#include <stddef.h>
+
+/*
+  The memory profiler counts the heap blocks of a program by the
+  subsystem that allocated them. It replaces malloc, calloc, realloc
+  and free when the program is linked with memprof.o and
+  -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free.
+  Every block then carries a small header recording its size and tag,
+  so memory allocated by the wrapped functions must not be freed by
+  code outside the link (such as the C library), nor the other way
+  around.
+
+  Modules mark an allocation's subsystem with MEMPROF_TAG just before
+  it. The mark is consumed by the next allocation; unmarked blocks are
+  counted as MEMPROF_OTHER. Without -DMEMPROF the marks compile to
+  nothing, so the profiler costs nothing in normal builds.
+*/
+
+/* The subsystems blocks are counted by. */
+enum { MEMPROF_OTHER, MEMPROF_NODE, MEMPROF_PATH, MEMPROF_ARRAY_HEADER,
+       MEMPROF_ARRAY_BACKING, MEMPROF_ARRAY_KEYS, MEMPROF_NUM_TAGS };
+
+#ifdef MEMPROF
+/* The tag of the next allocation. Use MEMPROF_TAG to set it. */
+extern int MemProf_nextTag;
+#define MEMPROF_TAG(tag) (MemProf_nextTag = (tag))
+#else
+#define MEMPROF_TAG(tag) ((void)0)
+#endif
+
+/* The live blocks of the program, by tag. */
+struct MemProfStats {
+   /* The number of live blocks. */
+   size_t blocks[MEMPROF_NUM_TAGS];
+   /* The bytes asked for by the live blocks. */
+   size_t requested[MEMPROF_NUM_TAGS];
+   /* The bytes malloc actually set aside for the live blocks,
+      including the profiler's headers and malloc's rounding. */
+   size_t usable[MEMPROF_NUM_TAGS];
+   /* The greatest total of requested bytes live at once. */
+   size_t peakRequested;
+};
+
+/*--------------------------------------------------------------------*/
+/*
+  Stores the current counts of the profiler in *psStats.
+*/
+void MemProf_getStats(struct MemProfStats *psStats);
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the printable name of the subsystem tag.
+*/
+const char *MemProf_getTagName(int tag);
+
+#endif
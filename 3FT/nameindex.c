@@ -0,0 +1,283 @@
+/*--------------------------------------------------------------------*/
+/* nameindex.c                                                        */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dynarray.h"
+#include "nameindex.h"
+#include "node.h"
+
+/* The nodes with one name. */
+struct NameEntry {
+   /* The name, owned by the entry. */
+   char *name;
+   /* The nodes, sorted by address, which a move does not change. */
+   DynArray_T nodes;
+};
+
+/* A NameIndex is a DynArray of NameEntry pointers sorted by name. */
+struct NameIndex {
+   DynArray_T entries;
+};
+
+/*--------------------------------------------------------------------*/
+/*
+  Compares the NameEntry objects at pvEntry1 and pvEntry2 by name.
+*/
+static int NameIndex_compareEntries(const void *pvEntry1,
+                                    const void *pvEntry2) {
+   const struct NameEntry *psEntry1 = pvEntry1;
+   const struct NameEntry *psEntry2 = pvEntry2;
+
+   assert(psEntry1 != NULL);
+   assert(psEntry2 != NULL);
+
+   return strcmp(psEntry1->name, psEntry2->name);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the 8 bytes from byte uOffset on of the name of the
+  NameEntry at pvEntry, its key string.
+*/
+static uint64_t NameIndex_key(const void *pvEntry, size_t uOffset) {
+   const struct NameEntry *psEntry = pvEntry;
+   const char *name;
+   uint64_t key = 0;
+   size_t i;
+
+   assert(psEntry != NULL);
+
+   name = psEntry->name;
+   for (; uOffset > 0 && *name != '\0'; uOffset--)
+      name++;
+   for (i = 0; i < sizeof(key); i++) {
+      key <<= 8;
+      if (*name != '\0')
+         key |= (unsigned char)*name++;
+   }
+   return key;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Compares the Nodes at pvNode1 and pvNode2 by address.
+*/
+static int NameIndex_compareNodes(const void *pvNode1,
+                                  const void *pvNode2) {
+   uintptr_t uNode1 = (uintptr_t)pvNode1;
+   uintptr_t uNode2 = (uintptr_t)pvNode2;
+
+   assert(pvNode1 != NULL);
+   assert(pvNode2 != NULL);
+
+   if (uNode1 != uNode2)
+      return (uNode1 < uNode2) ? -1 : 1;
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Finds the entry of oIndex for pcName. Returns 1 and stores its index
+  in *puIndex if there is one, and otherwise returns 0 and stores in
+  *puIndex the index where it would belong.
+*/
+static int NameIndex_search(NameIndex_T oIndex, const char *pcName,
+                            size_t *puIndex) {
+   struct NameEntry sSought;
+
+   assert(oIndex != NULL);
+   assert(pcName != NULL);
+   assert(puIndex != NULL);
+
+   /* The sought entry is only read, and only its name. */
+   sSought.name = (char *)pcName;
+   sSought.nodes = NULL;
+   return DynArray_bsearch(oIndex->entries, &sSought, puIndex,
+                           NameIndex_compareEntries);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Frees the NameEntry psEntry.
+*/
+static void NameIndex_freeEntry(struct NameEntry *psEntry) {
+   assert(psEntry != NULL);
+
+   DynArray_free(psEntry->nodes);
+   free(psEntry->name);
+   free(psEntry);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns a new NameEntry for pcName with no nodes, or NULL if
+  insufficient memory is available.
+*/
+static struct NameEntry *NameIndex_newEntry(const char *pcName) {
+   struct NameEntry *psEntry;
+
+   assert(pcName != NULL);
+
+   psEntry = malloc(sizeof(struct NameEntry));
+   if (psEntry == NULL)
+      return NULL;
+
+   psEntry->name = malloc(strlen(pcName) + 1);
+   psEntry->nodes = DynArray_new(0);
+   if (psEntry->name == NULL || psEntry->nodes == NULL) {
+      if (psEntry->nodes != NULL)
+         DynArray_free(psEntry->nodes);
+      free(psEntry->name);
+      free(psEntry);
+      return NULL;
+   }
+   strcpy(psEntry->name, pcName);
+   return psEntry;
+}
+
+/*--------------------------------------------------------------------*/
+NameIndex_T NameIndex_new(void) {
+   NameIndex_T oIndex;
+
+   oIndex = malloc(sizeof(struct NameIndex));
+   if (oIndex == NULL)
+      return NULL;
+
+   oIndex->entries = DynArray_new(0);
+   if (oIndex->entries == NULL) {
+      free(oIndex);
+      return NULL;
+   }
+   DynArray_setKeyFunction(oIndex->entries, NameIndex_key);
+   return oIndex;
+}
+
+/*--------------------------------------------------------------------*/
+void NameIndex_free(NameIndex_T oIndex) {
+   if (oIndex == NULL)
+      return;
+
+   NameIndex_clear(oIndex);
+   DynArray_free(oIndex->entries);
+   free(oIndex);
+}
+
+/*--------------------------------------------------------------------*/
+void NameIndex_clear(NameIndex_T oIndex) {
+   size_t uLength;
+   size_t i;
+
+   assert(oIndex != NULL);
+
+   uLength = DynArray_getLength(oIndex->entries);
+   for (i = 0; i < uLength; i++)
+      NameIndex_freeEntry(DynArray_get(oIndex->entries, i));
+   DynArray_removeRange(oIndex->entries, 0, uLength, NULL);
+}
+
+/*--------------------------------------------------------------------*/
+int NameIndex_add(NameIndex_T oIndex, Node n) {
+   struct NameEntry *psEntry;
+   boolean isNew = FALSE;
+   size_t uEntry;
+   size_t uNode;
+
+   assert(oIndex != NULL);
+   assert(n != NULL);
+
+   if (NameIndex_search(oIndex, Node_getName(n), &uEntry))
+      psEntry = DynArray_get(oIndex->entries, uEntry);
+   else {
+      psEntry = NameIndex_newEntry(Node_getName(n));
+      if (psEntry == NULL)
+         return FALSE;
+      if (!DynArray_addAt(oIndex->entries, uEntry, psEntry)) {
+         NameIndex_freeEntry(psEntry);
+         return FALSE;
+      }
+      isNew = TRUE;
+   }
+
+   (void)DynArray_bsearch(psEntry->nodes, n, &uNode,
+                          NameIndex_compareNodes);
+   if (!DynArray_addAt(psEntry->nodes, uNode, n)) {
+      if (isNew) {
+         (void)DynArray_removeAt(oIndex->entries, uEntry);
+         NameIndex_freeEntry(psEntry);
+      }
+      return FALSE;
+   }
+   return TRUE;
+}
+
+/*--------------------------------------------------------------------*/
+void NameIndex_remove(NameIndex_T oIndex, Node n) {
+   struct NameEntry *psEntry;
+   size_t uEntry;
+   size_t uNode;
+
+   assert(oIndex != NULL);
+   assert(n != NULL);
+
+   if (!NameIndex_search(oIndex, Node_getName(n), &uEntry))
+      return;
+
+   psEntry = DynArray_get(oIndex->entries, uEntry);
+   if (!DynArray_bsearch(psEntry->nodes, n, &uNode,
+                         NameIndex_compareNodes))
+      return;
+
+   (void)DynArray_removeAt(psEntry->nodes, uNode);
+   if (DynArray_getLength(psEntry->nodes) == 0) {
+      (void)DynArray_removeAt(oIndex->entries, uEntry);
+      NameIndex_freeEntry(psEntry);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+int NameIndex_find(NameIndex_T oIndex, const char *pcName,
+                   boolean prefix,
+                   void (*pfVisit)(const char *pcPath, boolean isFile,
+                                   void *pvExtra),
+                   void *pvExtra) {
+   struct NameEntry *psEntry;
+   const char *pcPath;
+   size_t uLength;
+   size_t uEntry;
+   size_t uEntries;
+   size_t i;
+   Node n;
+
+   assert(oIndex != NULL);
+   assert(pcName != NULL);
+   assert(pfVisit != NULL);
+
+   /* Entries with a prefix follow where that prefix would be. */
+   if (!NameIndex_search(oIndex, pcName, &uEntry) && !prefix)
+      return SUCCESS;
+
+   uLength = strlen(pcName);
+   uEntries = DynArray_getLength(oIndex->entries);
+   for (; uEntry < uEntries; uEntry++) {
+      psEntry = DynArray_get(oIndex->entries, uEntry);
+      if (strncmp(psEntry->name, pcName, uLength) != 0)
+         break;
+
+      for (i = 0; i < DynArray_getLength(psEntry->nodes); i++) {
+         n = DynArray_get(psEntry->nodes, i);
+         pcPath = Node_getPath(n);
+         if (pcPath == NULL)
+            return MEMORY_ERROR;
+         pfVisit(pcPath, (boolean)(Node_getType(n) == FIL), pvExtra);
+      }
+      if (!prefix)
+         break;
+   }
+   return SUCCESS;
+}
@@ -0,0 +1,74 @@
+/*--------------------------------------------------------------------*/
+/* nameindex.h                                                        */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#ifndef NAMEINDEX_INCLUDED
+#define NAMEINDEX_INCLUDED
+
+#include "a4def.h"
+
+/*
+  A NameIndex_T maps each name, the last component of a path, to the
+  nodes with that name. Names are kept in a sorted array, so that both
+  a name and every name with a given prefix are found by binary
+  search, and each name's nodes are kept sorted by address, so that
+  one can be removed by binary search too, even after a move has
+  changed its path. The index does not own its nodes: they must be
+  removed from it before they are destroyed.
+*/
+typedef struct NameIndex *NameIndex_T;
+
+/* The Node type of node.h, which clients need not see. */
+struct node;
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns a new empty NameIndex_T, or NULL if insufficient memory is
+  available.
+*/
+NameIndex_T NameIndex_new(void);
+
+/*--------------------------------------------------------------------*/
+/*
+  Frees oIndex, but not the nodes in it.
+*/
+void NameIndex_free(NameIndex_T oIndex);
+
+/*--------------------------------------------------------------------*/
+/*
+  Removes every node from oIndex.
+*/
+void NameIndex_clear(NameIndex_T oIndex);
+
+/*--------------------------------------------------------------------*/
+/*
+  Adds the node n, which must not be in oIndex, to oIndex under its
+  name. Returns 1 (TRUE) if successful, or 0 (FALSE) if insufficient
+  memory is available, in which case oIndex is unchanged.
+*/
+int NameIndex_add(NameIndex_T oIndex, struct node *n);
+
+/*--------------------------------------------------------------------*/
+/*
+  Removes the node n from oIndex, if it is there.
+*/
+void NameIndex_remove(NameIndex_T oIndex, struct node *n);
+
+/*--------------------------------------------------------------------*/
+/*
+  Calls pfVisit with the path of each node in oIndex named pcName, or
+  if prefix is TRUE, each node whose name starts with pcName, with
+  whether the node is a file, and with pvExtra. Nodes are visited in
+  order of name; the order of nodes of one name is unspecified.
+  pfVisit must not change oIndex. Returns SUCCESS, or MEMORY_ERROR if
+  a path cannot be rebuilt after a move, in which case the visits
+  stop there.
+*/
+int NameIndex_find(NameIndex_T oIndex, const char *pcName,
+                   boolean prefix,
+                   void (*pfVisit)(const char *pcPath, boolean isFile,
+                                   void *pvExtra),
+                   void *pvExtra);
+
+#endif
@@ -8,7 +8,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "counters.h"
 #include "dynarray.h"
+#include "memprof.h"
 #include "node.h"
 
 /*--------------------------------------------------------------------*/
@@ -18,9 +20,20 @@
   but no children or of type DIR which has associated children Nodes.
 */
 struct node {
-   /* The full path of this node (FIL or DIR). */
+   /* The last component of this node's path, or its whole path if it
+      has no parent. */
+   char *name;
+
+   /* The full path of this node (FIL or DIR), built from its parent's
+      path and its name, or NULL if it has no parent; see
+      Node_getPath. */
    char *path;
 
+   /* The value of moveEpoch when path was last built, and when it was
+      last found current. */
+   size_t builtEpoch;
+   size_t checkedEpoch;
+
    /* Parent DIR of this node (FIL or DIR). */
    Node parent;
 
@@ -35,8 +48,46 @@ struct node {
 
    /* Sub-Dirs (lexigraphically sorted) of node (invalid for FIL). */
    DynArray_T children;
+
+   /* The files and directories anywhere below this node, and the
+      total length of those files (all 0 for FIL). */
+   size_t filesBelow;
+   size_t dirsBelow;
+   size_t bytesBelow;
+
+   /* For a DIR, a Fenwick tree over the sizes of the subtrees of its
+      children, in child order: sizeTree[i] sums the sizes of the
+      children from i - (i & -i) up to, but not including, i. It
+      covers sizeTreeLength children and has room for sizeTreeRoom.
+      Nodes linked and unlinked below a child update it in place, as
+      do children added, removed and renamed. NULL and stale until
+      first needed, and stale again only if it cannot grow. */
+   size_t *sizeTree;
+   size_t sizeTreeLength;
+   size_t sizeTreeRoom;
+   boolean sizesStale;
+
+   /* For a DIR copied by Node_copy whose children have not been copied
+      yet, the DIR to copy them from, and the Nodes before and after
+      this one among that DIR's copies; otherwise NULL. */
+   Node source;
+   Node prevCopy;
+   Node nextCopy;
+
+   /* The first of the Nodes whose children are to be copied from this
+      Node, which must not change while there are any, or NULL. */
+   Node copies;
+
+   /* Whether this Node has been destroyed, but is kept until no Node
+      has its children left to copy from it. */
+   boolean isDetached;
 };
 
+/* The number of Node_move calls made. A path built no earlier than
+   its parent's path is current, and so is one found current since the
+   last move. */
+static size_t moveEpoch;
+
 /*--------------------------------------------------------------------*/
 /*
   returns a path with contents
@@ -47,21 +98,30 @@ struct node {
   which is then owened by the caller!
 */
 static char *Node_buildPath(Node n, const char *dir) {
+   const char *parentPath = "";
    char *path;
 
    assert(dir != NULL);
 
+   if (n != NULL) {
+      parentPath = Node_getPath(n);
+      if (parentPath == NULL)
+         return NULL;
+   }
+
+   MEMPROF_TAG(MEMPROF_PATH);
+   COUNTERS_ADD(COUNTER_ALLOCATIONS, 1);
    if (n == NULL)
       path = malloc(strlen(dir) + 1);
    else
-      path = malloc(strlen(n->path) + 1 + strlen(dir) + 1);
+      path = malloc(strlen(parentPath) + 1 + strlen(dir) + 1);
 
    if (path == NULL)
       return NULL;
    *path = '\0';
 
    if (n != NULL) {
-      strcpy(path, n->path);
+      strcpy(path, parentPath);
       strcat(path, "/");
    }
    strcat(path, dir);
@@ -69,6 +129,189 @@ static char *Node_buildPath(Node n, const char *dir) {
    return path;
 }
 
+/*--------------------------------------------------------------------*/
+/*
+  Returns the 8 bytes from byte uOffset on of the key string of the
+  Node at pvNode: 0 for a FIL or 1 for a DIR, followed by its name, so
+  that key strings order Nodes as Node_compare does.
+*/
+static uint64_t Node_key(const void *pvNode, size_t uOffset) {
+   Node n = (Node)pvNode;
+   const char *name;
+   uint64_t key = 0;
+   size_t i = 0;
+
+   assert(n != NULL);
+
+   name = n->name;
+   if (uOffset == 0) {
+      key = (n->type == FIL) ? 0 : 1;
+      i = 1;
+   }
+   else
+      for (uOffset--; uOffset > 0 && *name != '\0'; uOffset--)
+         name++;
+
+   for (; i < sizeof(key); i++) {
+      key <<= 8;
+      if (*name != '\0')
+         key |= (unsigned char)*name++;
+   }
+
+   return key;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Adds delta to the size of the subtree of the childID'th child in
+  the Fenwick tree of the DIR n, which must not be stale.
+*/
+static void Node_sizeTreeAdd(Node n, size_t childID, size_t delta) {
+   size_t i;
+
+   assert(n != NULL);
+   assert(!n->sizesStale);
+   assert(childID < n->sizeTreeLength);
+
+   for (i = childID + 1; i <= n->sizeTreeLength; i += i & (0 - i))
+      n->sizeTree[i] += delta;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the sum of the sizes of the subtrees of the first count
+  children of the DIR n, from its Fenwick tree, which must not be
+  stale.
+*/
+static size_t Node_sizeTreeSum(Node n, size_t count) {
+   size_t sum = 0;
+
+   assert(n != NULL);
+   assert(!n->sizesStale);
+   assert(count <= n->sizeTreeLength);
+
+   for (; count > 0; count -= count & (0 - count))
+      sum += n->sizeTree[count];
+   return sum;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Updates the Fenwick tree of the DIR n, if it has an up-to-date one,
+  after the children from childID on have changed places, as when a
+  child is added or removed there, or renamed from or to there. The
+  entries that cover only earlier children stand, so the rest are
+  rebuilt in place in time proportional to the children from childID
+  on, which is what moving them in n's children took, plus
+  O(log fan-out). If the tree has no room for all the children and
+  cannot grow, it is made stale instead.
+*/
+static void Node_sizesShifted(Node n, size_t childID) {
+   size_t *tree;
+   size_t numChildren;
+   size_t room;
+   size_t i;
+   size_t j;
+
+   assert(n != NULL);
+
+   if (n->sizesStale)
+      return;
+
+   numChildren = DynArray_getLength(n->children);
+   assert(childID <= numChildren);
+   if (numChildren > n->sizeTreeRoom) {
+      room = 2 * numChildren;
+      COUNTERS_ADD(COUNTER_ALLOCATIONS, 1);
+      tree = realloc(n->sizeTree, (room + 1) * sizeof(size_t));
+      if (tree == NULL) {
+         n->sizesStale = TRUE;
+         return;
+      }
+      n->sizeTree = tree;
+      n->sizeTreeRoom = room;
+   }
+
+   tree = n->sizeTree;
+   for (i = childID + 1; i <= numChildren; i++)
+      tree[i] = Node_getSubtreeSize(DynArray_get(n->children, i - 1));
+
+   /* Each entry passes its sum on to the next entry that covers it:
+      first the standing entries covered by a rebuilt one, which are
+      those on the path that sums the first childID children, then
+      the rebuilt entries in order. */
+   for (i = childID; i > 0; i -= i & (0 - i)) {
+      j = i + (i & (0 - i));
+      if (j <= numChildren)
+         tree[j] += tree[i];
+   }
+   for (i = childID + 1; i <= numChildren; i++) {
+      j = i + (i & (0 - i));
+      if (j <= numChildren)
+         tree[j] += tree[i];
+   }
+   n->sizeTreeLength = numChildren;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Adds files, dirs and bytes to the totals below n and below each of
+  its ancestors. Unsigned arithmetic wraps, so adding the negation of
+  a count subtracts it. A change in the number of Nodes below updates
+  the Fenwick tree of each ancestor that has an up-to-date one, in
+  O(log fan-out) time each.
+*/
+static void Node_addBelow(Node n, size_t files, size_t dirs,
+                          size_t bytes) {
+   size_t childID;
+
+   for (; n != NULL; n = n->parent) {
+      n->filesBelow += files;
+      n->dirsBelow += dirs;
+      n->bytesBelow += bytes;
+      if ((files != 0 || dirs != 0) && n->parent != NULL &&
+          !n->parent->sizesStale) {
+         if (DynArray_bsearch(
+                n->parent->children, n, &childID,
+                (int (*)(const void *, const void *))Node_compare))
+            Node_sizeTreeAdd(n->parent, childID, files + dirs);
+         else
+            n->parent->sizesStale = TRUE;
+      }
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Adds child, itself and everything below it, to the totals below
+  parent and its ancestors, or subtracts it if isRemoved is TRUE.
+*/
+static void Node_addChildBelow(Node parent, Node child,
+                               boolean isRemoved) {
+   size_t files;
+   size_t dirs;
+   size_t bytes;
+
+   assert(parent != NULL);
+   assert(child != NULL);
+
+   if (child->type == FIL) {
+      files = 1;
+      dirs = 0;
+      bytes = child->length;
+   }
+   else {
+      files = child->filesBelow;
+      dirs = child->dirsBelow + 1;
+      bytes = child->bytesBelow;
+   }
+
+   if (isRemoved)
+      Node_addBelow(parent, 0 - files, 0 - dirs, 0 - bytes);
+   else
+      Node_addBelow(parent, files, dirs, bytes);
+}
+
 /*--------------------------------------------------------------------*/
 void *Node_getFileContents(Node n) {
 
@@ -89,6 +332,7 @@ void *Node_replaceFileContents(Node n, void *newContents,
 
    oldContents = n->contents;
    n->contents = newContents;
+   Node_addBelow(n->parent, 0, 0, newLength - n->length);
    n->length = newLength;
 
    return oldContents;
@@ -102,27 +346,50 @@ Node Node_createDir(const char *dir, Node parent) {
    assert(dir != NULL);
 
    /* Create defensive copy of path for Node. */
+   MEMPROF_TAG(MEMPROF_NODE);
+   COUNTERS_ADD(COUNTER_ALLOCATIONS, 1);
    new = malloc(sizeof(struct node));
    if (new == NULL)
       return NULL;
-   new->path = Node_buildPath(parent, dir);
+   new->name = Node_buildPath(NULL, dir);
+   new->path = NULL;
+   if (new->name != NULL && parent != NULL)
+      new->path = Node_buildPath(parent, dir);
 
-   if (new->path == NULL) {
+   if (new->name == NULL || (parent != NULL && new->path == NULL)) {
+      free(new->name);
+      free(new->path);
       free(new);
       return NULL;
    }
 
    /* Set-up fields of Node struct. */
+   new->builtEpoch = moveEpoch;
+   new->checkedEpoch = moveEpoch;
    new->parent = parent;
    new->contents = NULL;
    new->type = DIR;
    new->length = 0;
+   new->filesBelow = 0;
+   new->dirsBelow = 0;
+   new->bytesBelow = 0;
+   new->sizeTree = NULL;
+   new->sizeTreeLength = 0;
+   new->sizeTreeRoom = 0;
+   new->sizesStale = TRUE;
+   new->source = NULL;
+   new->prevCopy = NULL;
+   new->nextCopy = NULL;
+   new->copies = NULL;
+   new->isDetached = FALSE;
    new->children = DynArray_new(0);
    if (new->children == NULL) {
+      free(new->name);
       free(new->path);
       free(new);
       return NULL;
    }
+   DynArray_setKeyFunction(new->children, Node_key);
 
    return new;
 }
@@ -134,68 +401,143 @@ Node Node_createFile(char *path, void *contents, size_t length) {
    assert(path != NULL);
 
    /* Create defensive copy of path for Node. */
+   MEMPROF_TAG(MEMPROF_NODE);
+   COUNTERS_ADD(COUNTER_ALLOCATIONS, 1);
    new = malloc(sizeof(struct node));
    if (new == NULL)
       return NULL;
-   new->path = Node_buildPath(NULL, path);
-   if (new->path == NULL) {
+   new->name = Node_buildPath(NULL, path);
+   if (new->name == NULL) {
       free(new);
       return NULL;
    }
 
+   new->path = NULL;
+   new->builtEpoch = moveEpoch;
+   new->checkedEpoch = moveEpoch;
    new->contents = contents;
    new->type = FIL;
    new->length = length;
    new->parent = NULL;
    new->children = NULL;
+   new->filesBelow = 0;
+   new->dirsBelow = 0;
+   new->bytesBelow = 0;
+   new->sizeTree = NULL;
+   new->sizeTreeLength = 0;
+   new->sizeTreeRoom = 0;
+   new->sizesStale = TRUE;
+   new->source = NULL;
+   new->prevCopy = NULL;
+   new->nextCopy = NULL;
+   new->copies = NULL;
+   new->isDetached = FALSE;
 
    return new;
 }
 
+/* Node_release and Node_dropCopy call each other. */
+static void Node_release(Node n);
+
 /*--------------------------------------------------------------------*/
-size_t Node_destroy(Node n) {
+/*
+  Makes copy, a DIR whose children are not copied yet, one of the
+  copies of source, the DIR they are to be copied from.
+*/
+static void Node_addCopy(Node source, Node copy) {
+   assert(source != NULL);
+   assert(copy != NULL);
+   assert(source->source == NULL);
+
+   copy->source = source;
+   copy->prevCopy = NULL;
+   copy->nextCopy = source->copies;
+   if (source->copies != NULL)
+      source->copies->prevCopy = copy;
+   source->copies = copy;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Removes copy from the copies of its source, releasing the source if
+  it has been destroyed and no other copy needs it.
+*/
+static void Node_dropCopy(Node copy) {
+   Node source;
+
+   assert(copy != NULL);
+   assert(copy->source != NULL);
+
+   source = copy->source;
+   if (copy->prevCopy != NULL)
+      copy->prevCopy->nextCopy = copy->nextCopy;
+   else
+      source->copies = copy->nextCopy;
+   if (copy->nextCopy != NULL)
+      copy->nextCopy->prevCopy = copy->prevCopy;
+   copy->source = NULL;
+   copy->prevCopy = NULL;
+   copy->nextCopy = NULL;
+
+   if (source->isDetached && source->copies == NULL)
+      Node_release(source);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Frees n and the hierarchy below it, except that a Node that copies
+  still need is detached, with everything below it, and kept until
+  the last of them no longer does.
+*/
+static void Node_release(Node n) {
    size_t i;
-   size_t count = 0;
-   Node c;
 
    assert(n != NULL);
 
-   /* Handle FIL type. */
-   if (n->type == FIL) {
-      free(n->path);
-      free(n);
-      count++;
-      return count;
+   if (n->copies != NULL) {
+      n->parent = NULL;
+      n->isDetached = TRUE;
+      return;
    }
+   if (n->source != NULL)
+      Node_dropCopy(n);
 
-   /* Destroy each sub dir. */
-   for (i = 0; i < DynArray_getLength(n->children); i++) {
-      c = DynArray_get(n->children, i);
-      count += Node_destroy(c);
+   if (n->type == DIR) {
+      for (i = 0; i < DynArray_getLength(n->children); i++)
+         Node_release(DynArray_get(n->children, i));
+      DynArray_free(n->children);
    }
 
-   DynArray_free(n->children);
-
+   free(n->sizeTree);
+   free(n->name);
    free(n->path);
    free(n);
-   count++;
+}
+
+/*--------------------------------------------------------------------*/
+size_t Node_destroy(Node n) {
+   size_t count;
 
+   assert(n != NULL);
+
+   /* The Nodes not yet copied below a copy count too. */
+   count = Node_getSubtreeSize(n);
+   Node_release(n);
    return count;
 }
 
 /*--------------------------------------------------------------------*/
-/*
-  Compares node1 and node2 based on their paths.
-  Returns <0, 0, or >0 if node1 is less than,
-  equal to, or greater than node2, respectively.
-*/
-static int Node_compare(Node node1, Node node2) {
+int Node_compare(Node node1, Node node2) {
    assert(node1 != NULL);
    assert(node2 != NULL);
 
    /* Compare when the two nodes are of the same type */
-   if (node1->type == node2->type)
-      return strcmp(node1->path, node2->path);
+   if (node1->type == node2->type) {
+      COUNTERS_ADD(COUNTER_COMPARES, 1);
+      COUNTERS_ADD(COUNTER_BYTES,
+                   Counters_commonPrefix(node1->name, node2->name) + 1);
+      return strcmp(node1->name, node2->name);
+   }
 
    /* FILEs are less than DIRs. */
    if (node1->type == FIL)
@@ -205,11 +547,67 @@ static int Node_compare(Node node1, Node node2) {
 
 /*--------------------------------------------------------------------*/
 const char *Node_getPath(Node n) {
+   const char *parentPath;
+   char *path;
 
    assert(n != NULL);
+
+   if (n->parent == NULL)
+      return n->name;
+   if (n->path != NULL && n->checkedEpoch == moveEpoch)
+      return n->path;
+
+   /* Rebuild the path only if the parent's has been since it was
+      built, or it never was. */
+   parentPath = Node_getPath(n->parent);
+   if (parentPath == NULL)
+      return NULL;
+   if (n->path == NULL || n->builtEpoch < n->parent->builtEpoch) {
+      path = Node_buildPath(n->parent, n->name);
+      if (path == NULL)
+         return NULL;
+      free(n->path);
+      n->path = path;
+      n->builtEpoch = moveEpoch;
+   }
+   n->checkedEpoch = moveEpoch;
    return n->path;
 }
 
+/*--------------------------------------------------------------------*/
+const char *Node_getName(Node n) {
+   assert(n != NULL);
+
+   return n->name;
+}
+
+/*--------------------------------------------------------------------*/
+int Node_hasPath(Node n, const char *path) {
+   size_t length;
+   size_t nameLength;
+
+   assert(n != NULL);
+   assert(path != NULL);
+
+   if (n->parent == NULL ||
+       (n->path != NULL && n->checkedEpoch == moveEpoch))
+      return strcmp(Node_getPath(n), path) == 0;
+
+   /* Match the names from the end of path up to the root. */
+   length = strlen(path);
+   for (; n->parent != NULL; n = n->parent) {
+      nameLength = strlen(n->name);
+      if (nameLength + 1 > length ||
+          path[length - nameLength - 1] != '/' ||
+          strncmp(path + length - nameLength, n->name,
+                  nameLength) != 0)
+         return FALSE;
+      length -= nameLength + 1;
+   }
+   return length == strlen(n->name) &&
+      strncmp(path, n->name, length) == 0;
+}
+
 /*--------------------------------------------------------------------*/
 size_t Node_getNumChildren(Node n) {
    assert(n != NULL);
@@ -223,39 +621,80 @@ size_t Node_getNumChildren(Node n) {
 
 /*--------------------------------------------------------------------*/
 /*
-   Returns 1 if n has a child (FIL or DIR) with path,
-   0 if it does not have such a child, and -1 if
-   there is an allocation error during search.
-
-   If n does have such a child, and childID is not NULL, store the
-   child's identifier in *childID. If n does not have such a child,
-   store the identifier that such a child would have in *childID.
+  Finds the child of n named name, as Node_hasChild does, comparing
+  against a probe on the stack so that nothing is allocated.
 */
-static int Node_hasChild(Node n, const char *path, size_t *childID) {
+static int Node_findChild(Node n, const char *name, size_t *childID) {
+   struct node probe;
    size_t index = 0;
+   size_t fileIndex = 0;
    int result;
-   Node checker;
 
    assert(n != NULL);
-   assert(path != NULL);
+   assert(name != NULL);
 
    /* checks if file */
    if (n->type == FIL)
       return 0;
 
-   checker = Node_createDir(path, NULL);
-   if (checker == NULL)
-      return -1;
+   /* Only the name and type of a Node are compared. */
+   probe.name = (char *)name;
+   probe.type = DIR;
    result = DynArray_bsearch(
-       n->children, checker, &index,
+       n->children, &probe, &index,
        (int (*)(const void *, const void *))Node_compare);
-   (void)Node_destroy(checker);
+
+   /* FILs sort separately from DIRs, so look among them too. */
+   if (result == 0) {
+      probe.type = FIL;
+      result = DynArray_bsearch(
+          n->children, &probe, &fileIndex,
+          (int (*)(const void *, const void *))Node_compare);
+      if (result == 1)
+         index = fileIndex;
+   }
 
    if (childID != NULL)
       *childID = index;
    return result;
 }
 
+/*--------------------------------------------------------------------*/
+int Node_hasChild(Node n, const char *path, size_t *childID) {
+   const char *name;
+
+   assert(n != NULL);
+   assert(path != NULL);
+
+   name = strrchr(path, '/');
+   return Node_findChild(n, (name == NULL) ? path : name + 1, childID);
+}
+
+/*--------------------------------------------------------------------*/
+size_t Node_getNumFileChildren(Node n) {
+   size_t lo = 0;
+   size_t hi;
+   size_t mid;
+   Node child;
+
+   assert(n != NULL);
+
+   if (n->type == FIL)
+      return 0;
+
+   /* FILs sort before DIRs, so search for the first DIR. */
+   hi = DynArray_getLength(n->children);
+   while (lo < hi) {
+      mid = lo + (hi - lo) / 2;
+      child = DynArray_get(n->children, mid);
+      if (child->type == FIL)
+         lo = mid + 1;
+      else
+         hi = mid;
+   }
+   return lo;
+}
+
 /*--------------------------------------------------------------------*/
 Node Node_getChild(Node n, size_t childID) {
    assert(n != NULL);
@@ -280,27 +719,37 @@ Node Node_getParent(Node n) {
 /*--------------------------------------------------------------------*/
 int Node_linkChild(Node parent, Node child) {
    size_t i;
-   char *rest;
+   const char *childPath;
+   const char *parentPath;
+   const char *rest;
+   char *name = NULL;
+   int result = SUCCESS;
 
    assert(parent != NULL);
    assert(child != NULL);
+   assert(parent->source == NULL);
 
    /* FILEs cannot have children. */
    if (parent->type == FIL)
       return PARENT_CHILD_ERROR;
 
+   childPath = Node_getPath(child);
+   parentPath = Node_getPath(parent);
+   if (childPath == NULL || parentPath == NULL)
+      return MEMORY_ERROR;
+
    /* Child already in DynArray. */
-   if (Node_hasChild(parent, child->path, NULL))
+   if (Node_hasChild(parent, childPath, NULL))
       return ALREADY_IN_TREE;
 
    /* Prefixes don't match. */
-   i = strlen(parent->path);
-   if (strncmp(child->path, parent->path, i))
+   i = strlen(parentPath);
+   if (strncmp(childPath, parentPath, i))
       return PARENT_CHILD_ERROR;
 
    /* Improper path format yet slips through prefix check. */
-   rest = child->path + i;
-   if (strlen(child->path) >= i && rest[0] != '/')
+   rest = childPath + i;
+   if (strlen(childPath) >= i && rest[0] != '/')
       return PARENT_CHILD_ERROR;
 
    /* Proper path structure. */
@@ -308,17 +757,40 @@ int Node_linkChild(Node parent, Node child) {
    if (strstr(rest, "/") != NULL)
       return PARENT_CHILD_ERROR;
 
+   /* A Node made without a parent is named by its whole path, which
+      becomes its path now that it has one. */
+   if (child->parent == NULL) {
+      name = Node_buildPath(NULL, rest);
+      if (name == NULL)
+         return MEMORY_ERROR;
+      child->path = child->name;
+      child->name = name;
+      child->builtEpoch = moveEpoch;
+      child->checkedEpoch = moveEpoch;
+   }
    child->parent = parent;
 
    if (DynArray_bsearch(
            parent->children, child, &i,
            (int (*)(const void *, const void *))Node_compare) == 1)
-      return ALREADY_IN_TREE;
+      result = ALREADY_IN_TREE;
+   else if (DynArray_addAt(parent->children, i, child) != TRUE)
+      result = PARENT_CHILD_ERROR;
+
+   if (result != SUCCESS) {
+      if (name != NULL) {
+         child->name = child->path;
+         child->path = NULL;
+         child->parent = NULL;
+         free(name);
+      }
+      return result;
+   }
 
-   if (DynArray_addAt(parent->children, i, child) == TRUE)
-      return SUCCESS;
-   else
-      return PARENT_CHILD_ERROR;
+   /* child brings itself and everything below it. */
+   Node_sizesShifted(parent, i);
+   Node_addChildBelow(parent, child, FALSE);
+   return SUCCESS;
 }
 
 /*--------------------------------------------------------------------*/
@@ -334,11 +806,323 @@ int Node_unlinkChild(Node parent, Node child) {
            (int (*)(const void *, const void *))Node_compare) == 0)
       return PARENT_CHILD_ERROR;
 
-   /* Remove it. */
+   /* Remove it, and everything below it from the totals. */
    (void)DynArray_removeAt(parent->children, i);
+   Node_sizesShifted(parent, i);
+   Node_addChildBelow(parent, child, TRUE);
    return SUCCESS;
 }
 
+/*--------------------------------------------------------------------*/
+int Node_move(Node n, Node newParent, const char *newName) {
+   struct node probe;
+   Node oldParent;
+   Node ancestor;
+   DynArray_T children;
+   char *name;
+   char *path;
+   size_t oldID;
+   size_t newID;
+   size_t i;
+
+   assert(n != NULL);
+   assert(n->parent != NULL);
+   assert(newParent != NULL);
+   assert(newName != NULL);
+   assert(*newName != '\0' && strchr(newName, '/') == NULL);
+   assert(newParent->source == NULL && newParent->copies == NULL);
+
+   oldParent = n->parent;
+   if (newParent->type == FIL)
+      return NOT_A_DIRECTORY;
+   for (ancestor = newParent; ancestor != NULL;
+        ancestor = ancestor->parent)
+      if (ancestor == n)
+         return PARENT_CHILD_ERROR;
+   if (Node_findChild(newParent, newName, NULL))
+      return ALREADY_IN_TREE;
+
+   /* Allocate everything first, so that nothing can fail midway. */
+   name = Node_buildPath(NULL, newName);
+   path = Node_buildPath(newParent, newName);
+   if (name == NULL || path == NULL ||
+       !DynArray_reserve(newParent->children,
+                         DynArray_getLength(newParent->children) + 1)) {
+      free(name);
+      free(path);
+      return MEMORY_ERROR;
+   }
+
+   (void)DynArray_bsearch(
+      oldParent->children, n, &oldID,
+      (int (*)(const void *, const void *))Node_compare);
+   probe.name = name;
+   probe.type = n->type;
+   (void)DynArray_bsearch(
+      newParent->children, &probe, &newID,
+      (int (*)(const void *, const void *))Node_compare);
+
+   if (newParent != oldParent) {
+      (void)DynArray_removeAt(oldParent->children, oldID);
+      Node_sizesShifted(oldParent, oldID);
+      Node_addChildBelow(oldParent, n, TRUE);
+   }
+
+   free(n->name);
+   free(n->path);
+   n->name = name;
+   n->path = path;
+   n->parent = newParent;
+
+   /* Every path below n is now out of date, and is rebuilt when next
+      needed. */
+   moveEpoch++;
+   n->builtEpoch = moveEpoch;
+   n->checkedEpoch = moveEpoch;
+
+   if (newParent != oldParent) {
+      (void)DynArray_addAt(newParent->children, newID, n);
+      Node_sizesShifted(newParent, newID);
+      Node_addChildBelow(newParent, n, FALSE);
+      return SUCCESS;
+   }
+
+   /* A rename slides the siblings between n's old and new places
+      over by one. */
+   children = oldParent->children;
+   if (newID > oldID)
+      for (newID--, i = oldID; i < newID; i++)
+         (void)DynArray_set(children, i, DynArray_get(children, i + 1));
+   else
+      for (i = oldID; i > newID; i--)
+         (void)DynArray_set(children, i, DynArray_get(children, i - 1));
+   (void)DynArray_set(children, newID, n);
+   Node_sizesShifted(oldParent, (newID < oldID) ? newID : oldID);
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns a new Node named name below parent, not yet linked to it,
+  that copies the Node c: a FIL's contents and length, or a DIR's
+  totals, with its children to be copied from c, or from the DIR c's
+  are to be copied from, when first needed. The path is built when
+  first needed too. Returns NULL if insufficient memory is available.
+*/
+static Node Node_newCopy(Node c, Node parent, const char *name) {
+   Node new;
+   Node origin;
+
+   assert(c != NULL);
+   assert(parent != NULL);
+   assert(name != NULL);
+
+   MEMPROF_TAG(MEMPROF_NODE);
+   COUNTERS_ADD(COUNTER_ALLOCATIONS, 1);
+   new = malloc(sizeof(struct node));
+   if (new == NULL)
+      return NULL;
+   new->name = Node_buildPath(NULL, name);
+   if (new->name == NULL) {
+      free(new);
+      return NULL;
+   }
+
+   new->path = NULL;
+   new->builtEpoch = moveEpoch;
+   new->checkedEpoch = moveEpoch;
+   new->parent = parent;
+   new->type = c->type;
+   new->contents = c->contents;
+   new->length = c->length;
+   new->children = NULL;
+   new->filesBelow = c->filesBelow;
+   new->dirsBelow = c->dirsBelow;
+   new->bytesBelow = c->bytesBelow;
+   new->sizeTree = NULL;
+   new->sizeTreeLength = 0;
+   new->sizeTreeRoom = 0;
+   new->sizesStale = TRUE;
+   new->source = NULL;
+   new->prevCopy = NULL;
+   new->nextCopy = NULL;
+   new->copies = NULL;
+   new->isDetached = FALSE;
+
+   if (c->type == FIL)
+      return new;
+
+   new->children = DynArray_new(0);
+   if (new->children == NULL) {
+      free(new->name);
+      free(new);
+      return NULL;
+   }
+   DynArray_setKeyFunction(new->children, Node_key);
+
+   /* A copy of a copy shares the original's children. */
+   origin = (c->source != NULL) ? c->source : c;
+   if (DynArray_getLength(origin->children) > 0)
+      Node_addCopy(origin, new);
+   return new;
+}
+
+/*--------------------------------------------------------------------*/
+int Node_copy(Node n, Node newParent, const char *newName,
+              Node *copy) {
+   Node ancestor;
+   Node new;
+   size_t newID;
+
+   assert(n != NULL);
+   assert(newParent != NULL);
+   assert(newName != NULL);
+   assert(*newName != '\0' && strchr(newName, '/') == NULL);
+   assert(newParent->source == NULL && newParent->copies == NULL);
+
+   if (newParent->type == FIL)
+      return NOT_A_DIRECTORY;
+   for (ancestor = newParent; ancestor != NULL;
+        ancestor = ancestor->parent)
+      if (ancestor == n)
+         return PARENT_CHILD_ERROR;
+   if (Node_findChild(newParent, newName, NULL))
+      return ALREADY_IN_TREE;
+
+   if (!DynArray_reserve(newParent->children,
+                         DynArray_getLength(newParent->children) + 1))
+      return MEMORY_ERROR;
+   new = Node_newCopy(n, newParent, newName);
+   if (new == NULL)
+      return MEMORY_ERROR;
+
+   (void)DynArray_bsearch(
+      newParent->children, new, &newID,
+      (int (*)(const void *, const void *))Node_compare);
+   (void)DynArray_addAt(newParent->children, newID, new);
+   Node_sizesShifted(newParent, newID);
+   Node_addChildBelow(newParent, new, FALSE);
+
+   if (copy != NULL)
+      *copy = new;
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+int Node_expand(Node n) {
+   DynArray_T sourceChildren;
+   Node child;
+   size_t length;
+   size_t i;
+
+   assert(n != NULL);
+
+   if (n->source == NULL)
+      return SUCCESS;
+
+   sourceChildren = n->source->children;
+   length = DynArray_getLength(sourceChildren);
+   if (!DynArray_reserve(n->children, length))
+      return MEMORY_ERROR;
+
+   /* The source's children are already in order. */
+   for (i = 0; i < length; i++) {
+      child = DynArray_get(sourceChildren, i);
+      child = Node_newCopy(child, n, child->name);
+      if (child == NULL) {
+         while (DynArray_getLength(n->children) > 0)
+            Node_release(DynArray_removeAt(
+               n->children, DynArray_getLength(n->children) - 1));
+         return MEMORY_ERROR;
+      }
+      (void)DynArray_add(n->children, child);
+   }
+
+   Node_dropCopy(n);
+   n->sizesStale = TRUE;
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+int Node_unshare(Node n) {
+   assert(n != NULL);
+
+   while (n->copies != NULL)
+      if (Node_expand(n->copies) != SUCCESS)
+         return MEMORY_ERROR;
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+int Node_isCopying(Node n) {
+   assert(n != NULL);
+
+   return n->source != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+Node Node_getShared(Node n) {
+   assert(n != NULL);
+
+   if (n->source != NULL)
+      return n->source;
+   return n;
+}
+
+/*--------------------------------------------------------------------*/
+int Node_appendName(Node n, struct NodePath *path) {
+   const char *name;
+   char *text;
+   size_t length;
+   size_t size;
+
+   assert(n != NULL);
+   assert(path != NULL);
+
+   if (path->length == 0) {
+      name = Node_getPath(n);
+      if (name == NULL)
+         return MEMORY_ERROR;
+      length = strlen(name);
+   }
+   else {
+      name = n->name;
+      length = path->length + 1 + strlen(name);
+   }
+
+   if (length + 1 > path->size) {
+      size = (path->size == 0) ? 64 : path->size;
+      while (size < length + 1)
+         size *= 2;
+      MEMPROF_TAG(MEMPROF_PATH);
+      COUNTERS_ADD(COUNTER_ALLOCATIONS, 1);
+      text = realloc(path->text, size);
+      if (text == NULL)
+         return MEMORY_ERROR;
+      path->text = text;
+      path->size = size;
+   }
+
+   if (path->length == 0)
+      strcpy(path->text, name);
+   else {
+      path->text[path->length] = '/';
+      strcpy(path->text + path->length + 1, name);
+   }
+   path->length = length;
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+void Node_truncatePath(struct NodePath *path, size_t length) {
+   assert(path != NULL);
+   assert(length <= path->length);
+
+   path->length = length;
+   if (path->text != NULL)
+      path->text[length] = '\0';
+}
+
 /*--------------------------------------------------------------------*/
 int Node_getType(Node n) {
    assert(n != NULL);
@@ -352,3 +1136,131 @@ size_t Node_getLength(Node n) {
 
    return (n->length);
 }
+
+/*--------------------------------------------------------------------*/
+size_t Node_getFilesBelow(Node n) {
+   assert(n != NULL);
+
+   return n->filesBelow;
+}
+
+/*--------------------------------------------------------------------*/
+size_t Node_getDirsBelow(Node n) {
+   assert(n != NULL);
+
+   return n->dirsBelow;
+}
+
+/*--------------------------------------------------------------------*/
+size_t Node_getBytesBelow(Node n) {
+   assert(n != NULL);
+
+   return n->bytesBelow;
+}
+
+/*--------------------------------------------------------------------*/
+size_t Node_getSubtreeSize(Node n) {
+   assert(n != NULL);
+
+   return 1 + n->filesBelow + n->dirsBelow;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Rebuilds the Fenwick tree of the DIR n in one pass over its
+  children, if it is stale, leaving room for as many children again.
+  Returns SUCCESS, or MEMORY_ERROR if insufficient memory is
+  available.
+*/
+static int Node_refreshSizes(Node n) {
+   size_t *tree;
+   size_t numChildren;
+   size_t room;
+   size_t i;
+   size_t j;
+
+   assert(n != NULL);
+   assert(n->type == DIR);
+
+   if (!n->sizesStale)
+      return SUCCESS;
+
+   numChildren = DynArray_getLength(n->children);
+   if (n->sizeTree == NULL || n->sizeTreeRoom < numChildren) {
+      room = (numChildren < 2) ? 4 : 2 * numChildren;
+      COUNTERS_ADD(COUNTER_ALLOCATIONS, 1);
+      tree = realloc(n->sizeTree, (room + 1) * sizeof(size_t));
+      if (tree == NULL)
+         return MEMORY_ERROR;
+      n->sizeTree = tree;
+      n->sizeTreeRoom = room;
+   }
+
+   /* Each entry passes its sum on to the next entry that covers it. */
+   tree = n->sizeTree;
+   for (i = 1; i <= numChildren; i++)
+      tree[i] = Node_getSubtreeSize(DynArray_get(n->children, i - 1));
+   for (i = 1; i <= numChildren; i++) {
+      j = i + (i & (0 - i));
+      if (j <= numChildren)
+         tree[j] += tree[i];
+   }
+   n->sizeTreeLength = numChildren;
+   n->sizesStale = FALSE;
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+int Node_getSizeBefore(Node n, Node child, size_t *before) {
+   size_t childID;
+   int status;
+
+   assert(n != NULL);
+   assert(child != NULL);
+   assert(child->parent == n);
+   assert(before != NULL);
+
+   status = Node_refreshSizes(n);
+   if (status != SUCCESS)
+      return status;
+
+   if (!DynArray_bsearch(
+          n->children, child, &childID,
+          (int (*)(const void *, const void *))Node_compare))
+      return PARENT_CHILD_ERROR;
+   *before = Node_sizeTreeSum(n, childID);
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+int Node_findChildAt(Node n, size_t offset, size_t *childID,
+                     size_t *before) {
+   size_t step = 1;
+   size_t position = 0;
+   size_t rest;
+   int status;
+
+   assert(n != NULL);
+   assert(offset < n->filesBelow + n->dirsBelow);
+   assert(childID != NULL);
+   assert(before != NULL);
+
+   status = Node_refreshSizes(n);
+   if (status != SUCCESS)
+      return status;
+
+   /* Descend the Fenwick tree to the most children whose subtrees
+      all come at or before offset; the child after them holds it. */
+   while (2 * step <= n->sizeTreeLength)
+      step *= 2;
+   rest = offset;
+   for (; step > 0; step /= 2)
+      if (position + step <= n->sizeTreeLength &&
+          n->sizeTree[position + step] <= rest) {
+         position += step;
+         rest -= n->sizeTree[position];
+      }
+   *childID = position;
+   *before = offset - rest;
+   return SUCCESS;
+}
@@ -10,9 +10,11 @@
 #include <stddef.h>
 
 /*
-   a Node is an object that contains a path payload and references to
+   a Node is an object that contains a name payload and references to
    the Node's parent (if it exists), children (if DIR and they exist) as
-   well as file contents and length (if FIL type and it exists).
+   well as file contents and length (if FIL type and it exists). A
+   Node's path is its parent's path, a slash and its name, and is
+   cached, so that moving a Node only relinks it.
 */
 typedef struct node *Node;
 
@@ -41,8 +43,8 @@ void *Node_replaceFileContents(Node n, void *newContents,
    Node DIR type structure or NULL if any allocation error occurs in
    creating the node or its fields.
 
-   The new structure is initialized to have its path as the parent's
-   path (if it exists) prefixed to the directory string parameter,
+   The new structure is initialized to have dir as its name, and its
+   path as the parent's path (if it exists) prefixed to dir,
    separated by a slash. It is also initialized with its parent link
    (ig parent is given) as the parent parameter value (but the parent
    itself is not changed to link to the new Node. The children links are
@@ -63,24 +65,75 @@ Node Node_createFile(char *path, void *contents, size_t length);
 /*--------------------------------------------------------------------*/
 /*
   Destroys the entire hierarchy of Nodes rooted at n,
-  including n itself.
+  including n itself. A Node whose children copies are yet to copy is
+  only detached, and freed once none are left.
 
-  Returns the number of Nodes destroyed.
+  Returns the number of Nodes destroyed, counting those not yet
+  copied below a copy.
 */
 size_t Node_destroy(Node n);
 
 /*--------------------------------------------------------------------*/
 /*
-   Returns Node n's path.
+  Compares node1 and node2 based on their types and names: FILs are
+  less than DIRs, and Nodes of the same type compare as their names.
+  Returns <0, 0, or >0 if node1 is less than,
+  equal to, or greater than node2, respectively.
+*/
+int Node_compare(Node node1, Node node2);
+
+/*--------------------------------------------------------------------*/
+/*
+   Returns Node n's path. After a Node_move above n, the path is
+   rebuilt from its parent's the first time it is asked for, which
+   returns NULL if insufficient memory is available; otherwise the
+   cached path is returned without allocating. The path is only valid
+   until the next Node_move.
 */
 const char *Node_getPath(Node n);
 
+/*--------------------------------------------------------------------*/
+/*
+   Returns Node n's name: the last component of its path, or for a
+   Node without a parent, its whole path.
+*/
+const char *Node_getName(Node n);
+
+/*--------------------------------------------------------------------*/
+/*
+   Returns 1 (TRUE) if Node n's path is path, and 0 (FALSE) otherwise,
+   comparing n's and its ancestors' names with path if n's path is out
+   of date, so that nothing is allocated.
+*/
+int Node_hasPath(Node n, const char *path);
+
 /*--------------------------------------------------------------------*/
 /*
   Returns the number of children (FIL or DIR) n has.
 */
 size_t Node_getNumChildren(Node n);
 
+/*--------------------------------------------------------------------*/
+/*
+  Returns the number of n's children that are FILs. They sort before
+  its DIR children, so children 0 up to that number are FILs and the
+  rest are DIRs, each sorted by name.
+*/
+size_t Node_getNumFileChildren(Node n);
+
+/*--------------------------------------------------------------------*/
+/*
+   Returns 1 if n has a child (FIL or DIR) with path, or with the
+   last component of path as its name, and 0 if it does not have such
+   a child. Nothing is allocated.
+
+   If n does have such a child, and childID is not NULL, store the
+   child's identifier in *childID. If n does not have such a child,
+   store the identifier that such a child would have as a DIR in
+   *childID.
+*/
+int Node_hasChild(Node n, const char *path, size_t *childID);
+
 /*--------------------------------------------------------------------*/
 /*
    Returns the child Node of n with identifier childID, if one exists,
@@ -117,6 +170,111 @@ int Node_linkChild(Node parent, Node child);
  */
 int Node_unlinkChild(Node parent, Node child);
 
+/*--------------------------------------------------------------------*/
+/*
+  Moves Node n, which must have a parent, with everything below it,
+  to be the child of newParent named newName, a single non-empty
+  component. Only n is relinked and renamed: the paths below it are
+  marked out of date, to be rebuilt by Node_getPath.
+  Returns SUCCESS if successful,
+  returns NOT_A_DIRECTORY if newParent is a FIL,
+  returns PARENT_CHILD_ERROR if newParent is n or is below it,
+  returns ALREADY_IN_TREE if newParent already has a child named
+  newName, n included, and
+  returns MEMORY_ERROR if unable to allocate sufficient memory.
+  n is unchanged when returning a non-SUCCESS status.
+*/
+int Node_move(Node n, Node newParent, const char *newName);
+
+/*--------------------------------------------------------------------*/
+/*
+  Makes a copy of Node n, with everything below it, the child of
+  newParent named newName, a single non-empty component, and stores
+  it in *copy if copy is not NULL. A FIL's copy shares its contents.
+  A DIR's copy starts with no children of its own: they are copied
+  from n, one level at a time, by Node_expand, and until then n and
+  everything below it must not change. newParent must be expanded and
+  unshared.
+  Returns SUCCESS if successful,
+  returns NOT_A_DIRECTORY if newParent is a FIL,
+  returns PARENT_CHILD_ERROR if newParent is n or is below it,
+  returns ALREADY_IN_TREE if newParent already has a child named
+  newName, and
+  returns MEMORY_ERROR if unable to allocate sufficient memory.
+*/
+int Node_copy(Node n, Node newParent, const char *newName,
+              Node *copy);
+
+/*--------------------------------------------------------------------*/
+/*
+  Gives n, if it is a copy made by Node_copy, or a child of one, whose
+  children are not copied yet, copies of its source's children, whose
+  own children are left to expand in turn. Must be called before n's
+  children are read or changed.
+  Returns SUCCESS, or MEMORY_ERROR if unable to allocate sufficient
+  memory, in which case n is unchanged.
+*/
+int Node_expand(Node n);
+
+/*--------------------------------------------------------------------*/
+/*
+  Expands every copy whose children are to be copied from n, so that
+  n can change. Its children may then have copies of their own.
+  Returns SUCCESS, or MEMORY_ERROR if unable to allocate sufficient
+  memory, in which case some copies may be left unexpanded.
+*/
+int Node_unshare(Node n);
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns 1 (TRUE) if n is a DIR whose children are yet to be copied
+  by Node_expand, in which case it has none of its own yet, and 0
+  (FALSE) otherwise.
+*/
+int Node_isCopying(Node n);
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the Node whose children n has: its source, if n is a copy
+  whose children are yet to be copied by Node_expand, and otherwise n.
+  Walks that only read go through it to a copy's children instead of
+  expanding the copy, so that reading a copy leaves it to be copied
+  lazily. A Node reached this way has its place under the source, not
+  under the copy, so such walks build the paths they report with
+  Node_appendName rather than calling Node_getPath.
+*/
+Node Node_getShared(Node n);
+
+/*--------------------------------------------------------------------*/
+/*
+  A path built by Node_appendName: text holds length characters and a
+  '\0', in a buffer of size bytes from malloc, which grows as needed.
+  A NodePath starts with every field 0, and its text is freed by its
+  owner.
+*/
+struct NodePath {
+   char *text;
+   size_t length;
+   size_t size;
+};
+
+/*--------------------------------------------------------------------*/
+/*
+  Appends a slash and n's name to *path, or if *path is empty, makes
+  it n's path, which n must then have within its hierarchy, not
+  through a source.
+  Returns SUCCESS, or MEMORY_ERROR if unable to allocate sufficient
+  memory, in which case *path is unchanged.
+*/
+int Node_appendName(Node n, struct NodePath *path);
+
+/*--------------------------------------------------------------------*/
+/*
+  Cuts *path back to its first length characters, as it was before
+  the names appended since it had that length.
+*/
+void Node_truncatePath(struct NodePath *path, size_t length);
+
 /*--------------------------------------------------------------------*/
 /*
   Returns the type of Node n. DIR or FIL
@@ -129,4 +287,58 @@ int Node_getType(Node n);
 */
 size_t Node_getLength(Node n);
 
+/*--------------------------------------------------------------------*/
+/*
+  Returns the number of files anywhere below Node n. The totals below
+  a Node are kept up to date by Node_linkChild, Node_unlinkChild,
+  Node_move and Node_replaceFileContents, which update every ancestor
+  of the Node they change, and are 0 for a FIL.
+*/
+size_t Node_getFilesBelow(Node n);
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the number of directories anywhere below Node n.
+*/
+size_t Node_getDirsBelow(Node n);
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the total length of the files anywhere below Node n.
+*/
+size_t Node_getBytesBelow(Node n);
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the number of Nodes in the subtree rooted at n, n included.
+*/
+size_t Node_getSubtreeSize(Node n);
+
+/*--------------------------------------------------------------------*/
+/*
+  Stores in *before the number of Nodes in the subtrees of the
+  children of n that come before child, a child of n, so that child
+  is that many Nodes after n's first child in pre-order, in
+  O(log fan-out) time. The sizes of the children's subtrees are kept
+  in a Fenwick tree that Nodes linked and unlinked below n update in
+  place. A child of n added, removed or renamed updates only the
+  entries for the children after it, in the time moving them takes.
+  The tree is built in one pass over the children when first needed.
+  Returns SUCCESS, or MEMORY_ERROR if the tree cannot be allocated,
+  or PARENT_CHILD_ERROR if child is not a child of n.
+*/
+int Node_getSizeBefore(Node n, Node child, size_t *before);
+
+/*--------------------------------------------------------------------*/
+/*
+  Finds, by descending the Fenwick tree Node_getSizeBefore uses, the
+  child of n whose subtree holds the Node offset Nodes after n's first
+  child in pre-order, where offset is less than the number of Nodes
+  below n. Stores the child's identifier in *childID and the number
+  of Nodes before its subtree in *before.
+  Returns SUCCESS, or MEMORY_ERROR if the tree cannot be allocated.
+*/
+int Node_findChildAt(Node n, size_t offset, size_t *childID,
+                     size_t *before);
+
 #endif
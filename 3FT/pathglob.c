@@ -0,0 +1,485 @@
+/*--------------------------------------------------------------------*/
+/* pathglob.c                                                         */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "counters.h"
+#include "node.h"
+#include "pathglob.h"
+
+/* The number of states in one word of a state set. */
+enum { WORD_BITS = 64 };
+
+/* One '/'-separated component of a pattern. */
+struct Component {
+   /* The component, '\0'-terminated. */
+   const char *pattern;
+   /* Whether it is "**", matching any number of components. */
+   boolean anyDepth;
+   /* The number of literal characters it starts with. */
+   size_t prefixLength;
+};
+
+/*
+  The state of one match. State i of a set means that the next
+  component to match is component i; state uComponents means that the
+  whole pattern has matched.
+*/
+struct Glob {
+   /* The components of the pattern. */
+   struct Component *psComponents;
+   size_t uComponents;
+   /* The words in each state set. */
+   size_t uWords;
+   /* The state set of the node being visited at each depth, uWords
+      words apiece, and the number of depths there is room for. */
+   uint64_t *puSets;
+   size_t uDepths;
+   /* The function to report matches to, and its extra argument. */
+   void (*pfMatch)(const char *pcPath, boolean isFile, void *pvExtra);
+   void *pvExtra;
+   /* The path of the node being visited, which may be reached
+      through the directory a copy copies. */
+   struct NodePath sPath;
+};
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the pattern just past the character or class at the start
+  of pcPattern if it matches the character c, or NULL if it does not.
+  pcPattern must not be at its end or at a '*'.
+*/
+static const char *PathGlob_matchChar(const char *pcPattern, char c) {
+   const char *pcClass;
+   unsigned char uLo;
+   unsigned char uHi;
+   unsigned char uC = (unsigned char)c;
+   boolean negate;
+   boolean matched = FALSE;
+
+   assert(pcPattern != NULL);
+   assert(*pcPattern != '\0' && *pcPattern != '*');
+
+   if (*pcPattern == '?')
+      return pcPattern + 1;
+   if (*pcPattern == '\\' && pcPattern[1] != '\0')
+      return (pcPattern[1] == c) ? pcPattern + 2 : NULL;
+   if (*pcPattern != '[')
+      return (*pcPattern == c) ? pcPattern + 1 : NULL;
+
+   pcClass = pcPattern + 1;
+   negate = (boolean)(*pcClass == '!' || *pcClass == '^');
+   if (negate)
+      pcClass++;
+
+   /* A ']' first in the class is a member, not its end. */
+   do {
+      /* An unterminated class is a literal '['. */
+      if (*pcClass == '\0')
+         return (c == '[') ? pcPattern + 1 : NULL;
+
+      if (*pcClass == '\\' && pcClass[1] != '\0')
+         pcClass++;
+      uLo = (unsigned char)*pcClass++;
+      uHi = uLo;
+      if (*pcClass == '-' && pcClass[1] != ']' && pcClass[1] != '\0') {
+         pcClass++;
+         if (*pcClass == '\\' && pcClass[1] != '\0')
+            pcClass++;
+         uHi = (unsigned char)*pcClass++;
+      }
+      if (uC >= uLo && uC <= uHi)
+         matched = TRUE;
+   } while (*pcClass != ']');
+
+   if (matched == negate)
+      return NULL;
+   return pcClass + 1;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns TRUE if the name pcName matches the one-component pattern
+  pcPattern, and FALSE otherwise.
+*/
+static boolean PathGlob_matchName(const char *pcPattern,
+                                  const char *pcName) {
+   /* The pattern just past the last '*' seen, and the name position
+      that '*' is next tried as ending at. */
+   const char *pcStar = NULL;
+   const char *pcRetry = NULL;
+   const char *pcNext;
+
+   assert(pcPattern != NULL);
+   assert(pcName != NULL);
+
+   while (*pcName != '\0') {
+      if (*pcPattern == '*') {
+         pcStar = ++pcPattern;
+         pcRetry = pcName;
+         continue;
+      }
+
+      pcNext = (*pcPattern == '\0') ? NULL :
+         PathGlob_matchChar(pcPattern, *pcName);
+      if (pcNext != NULL) {
+         pcPattern = pcNext;
+         pcName++;
+      }
+      else if (pcStar != NULL) {
+         /* Let the last '*' swallow one more character. */
+         pcPattern = pcStar;
+         pcName = ++pcRetry;
+      }
+      else
+         return FALSE;
+   }
+
+   while (*pcPattern == '*')
+      pcPattern++;
+   return (boolean)(*pcPattern == '\0');
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Adds state uState to the state set puSet of *psGlob, along with the
+  states it reaches without matching a component: a "**" may match no
+  components at all.
+*/
+static void PathGlob_addState(const struct Glob *psGlob,
+                              uint64_t *puSet, size_t uState) {
+   assert(psGlob != NULL);
+   assert(puSet != NULL);
+
+   for (;;) {
+      puSet[uState / WORD_BITS] |= (uint64_t)1 << (uState % WORD_BITS);
+      if (uState == psGlob->uComponents ||
+          !psGlob->psComponents[uState].anyDepth)
+         return;
+      uState++;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns TRUE if state uState is in the state set puSet.
+*/
+static boolean PathGlob_hasState(const uint64_t *puSet, size_t uState) {
+   assert(puSet != NULL);
+
+   return (boolean)((puSet[uState / WORD_BITS] >>
+                     (uState % WORD_BITS)) & 1);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Stores in puNext the states of *psGlob that a node named pcName
+  reaches from the state set puSet of its parent. Returns TRUE if
+  there are any, and FALSE otherwise.
+*/
+static boolean PathGlob_step(const struct Glob *psGlob,
+                             const uint64_t *puSet, const char *pcName,
+                             uint64_t *puNext) {
+   const struct Component *psComponent;
+   boolean any = FALSE;
+   size_t i;
+
+   assert(psGlob != NULL);
+   assert(puSet != NULL);
+   assert(pcName != NULL);
+   assert(puNext != NULL);
+
+   memset(puNext, 0, psGlob->uWords * sizeof(uint64_t));
+   for (i = 0; i < psGlob->uComponents; i++) {
+      if (!PathGlob_hasState(puSet, i))
+         continue;
+
+      psComponent = &psGlob->psComponents[i];
+      if (psComponent->anyDepth) {
+         PathGlob_addState(psGlob, puNext, i);
+         any = TRUE;
+      }
+      else if (PathGlob_matchName(psComponent->pattern, pcName)) {
+         PathGlob_addState(psGlob, puNext, i + 1);
+         any = TRUE;
+      }
+   }
+   return any;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the literal characters that every name a node in state set
+  puSet of *psGlob can match starts with, storing their number in
+  *puLength. The number is 0 if some state allows any name.
+*/
+static const char *PathGlob_commonPrefix(const struct Glob *psGlob,
+                                         const uint64_t *puSet,
+                                         size_t *puLength) {
+   const struct Component *psComponent;
+   const char *pcPrefix = NULL;
+   size_t uLength = 0;
+   size_t uShared;
+   size_t i;
+
+   assert(psGlob != NULL);
+   assert(puSet != NULL);
+   assert(puLength != NULL);
+
+   for (i = 0; i < psGlob->uComponents; i++) {
+      if (!PathGlob_hasState(puSet, i))
+         continue;
+
+      psComponent = &psGlob->psComponents[i];
+      if (psComponent->anyDepth) {
+         uLength = 0;
+         break;
+      }
+      if (pcPrefix == NULL) {
+         pcPrefix = psComponent->pattern;
+         uLength = psComponent->prefixLength;
+         continue;
+      }
+      for (uShared = 0; uShared < uLength &&
+              uShared < psComponent->prefixLength &&
+              pcPrefix[uShared] == psComponent->pattern[uShared];
+           uShared++)
+         ;
+      uLength = uShared;
+   }
+
+   *puLength = uLength;
+   return pcPrefix;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the first of the children uLo up to uHi of the directory n
+  whose name is not less than the first uLength characters of
+  pcPrefix, or uHi if none is.
+*/
+static size_t PathGlob_lowerBound(Node n, size_t uLo, size_t uHi,
+                                  const char *pcPrefix,
+                                  size_t uLength) {
+   size_t uMid;
+
+   assert(n != NULL);
+   assert(pcPrefix != NULL);
+
+   while (uLo < uHi) {
+      uMid = uLo + (uHi - uLo) / 2;
+      COUNTERS_ADD(COUNTER_PROBES, 1);
+      if (strncmp(Node_getName(Node_getChild(n, uMid)), pcPrefix,
+                  uLength) < 0)
+         uLo = uMid + 1;
+      else
+         uHi = uMid;
+   }
+   return uLo;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Makes room in *psGlob for the state sets of depths up to uDepth.
+  Returns 1 if successful, 0 if memory cannot be allocated.
+*/
+static int PathGlob_reserve(struct Glob *psGlob, size_t uDepth) {
+   uint64_t *puSets;
+   size_t uDepths;
+
+   assert(psGlob != NULL);
+
+   if (uDepth < psGlob->uDepths)
+      return 1;
+
+   uDepths = 2 * psGlob->uDepths;
+   if (uDepths <= uDepth)
+      uDepths = uDepth + 1;
+   puSets = realloc(psGlob->puSets,
+                    uDepths * psGlob->uWords * sizeof(uint64_t));
+   if (puSets == NULL)
+      return 0;
+   psGlob->puSets = puSets;
+   psGlob->uDepths = uDepths;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Reports n, whose path is that of *psGlob, if its state set, the one
+  of *psGlob at depth uDepth, holds a whole match, and then visits
+  those of its children that can still match, reading a copy's
+  children through the directory it copies. Returns SUCCESS or
+  MEMORY_ERROR.
+*/
+static int PathGlob_visit(struct Glob *psGlob, Node n, size_t uDepth) {
+   const uint64_t *puSet;
+   const char *pcPrefix;
+   size_t uLength;
+   size_t uPath;
+   size_t uChildren;
+   size_t uFiles;
+   size_t uBlock;
+   size_t uHi;
+   size_t i;
+   Node child;
+   int status;
+
+   assert(psGlob != NULL);
+   assert(n != NULL);
+
+   COUNTERS_ADD(COUNTER_NODES, 1);
+   puSet = psGlob->puSets + uDepth * psGlob->uWords;
+   if (PathGlob_hasState(puSet, psGlob->uComponents))
+      psGlob->pfMatch(psGlob->sPath.text,
+                      (boolean)(Node_getType(n) == FIL),
+                      psGlob->pvExtra);
+
+   n = Node_getShared(n);
+   uChildren = Node_getNumChildren(n);
+   if (uChildren == 0)
+      return SUCCESS;
+
+   /* Stop if the only state left is the whole match. */
+   for (i = 0; i < psGlob->uComponents; i++)
+      if (PathGlob_hasState(puSet, i))
+         break;
+   if (i == psGlob->uComponents)
+      return SUCCESS;
+
+   if (!PathGlob_reserve(psGlob, uDepth + 1))
+      return MEMORY_ERROR;
+
+   pcPrefix = PathGlob_commonPrefix(psGlob,
+                                    psGlob->puSets +
+                                    uDepth * psGlob->uWords,
+                                    &uLength);
+   uFiles = Node_getNumFileChildren(n);
+
+   /* Files and directories are each sorted by name. */
+   for (uBlock = 0; uBlock < 2; uBlock++) {
+      i = (uBlock == 0) ? 0 : uFiles;
+      uHi = (uBlock == 0) ? uFiles : uChildren;
+      if (uLength > 0)
+         i = PathGlob_lowerBound(n, i, uHi, pcPrefix, uLength);
+
+      for (; i < uHi; i++) {
+         child = Node_getChild(n, i);
+         if (uLength > 0 && strncmp(Node_getName(child), pcPrefix,
+                                    uLength) != 0)
+            break;
+
+         /* The sets may move while deeper nodes are visited. */
+         if (!PathGlob_step(psGlob,
+                            psGlob->puSets + uDepth * psGlob->uWords,
+                            Node_getName(child),
+                            psGlob->puSets +
+                            (uDepth + 1) * psGlob->uWords))
+            continue;
+
+         uPath = psGlob->sPath.length;
+         status = Node_appendName(child, &psGlob->sPath);
+         if (status == SUCCESS)
+            status = PathGlob_visit(psGlob, child, uDepth + 1);
+         Node_truncatePath(&psGlob->sPath, uPath);
+         if (status != SUCCESS)
+            return status;
+      }
+   }
+
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Splits the pattern copy pcPattern in place into the components of
+  *psGlob, which must have room for them all, merging runs of "**".
+*/
+static void PathGlob_split(struct Glob *psGlob, char *pcPattern) {
+   struct Component *psComponent;
+   char *pcEnd;
+   size_t uCount = 0;
+
+   assert(psGlob != NULL);
+   assert(pcPattern != NULL);
+
+   for (;;) {
+      pcEnd = strchr(pcPattern, '/');
+      if (pcEnd != NULL)
+         *pcEnd = '\0';
+
+      psComponent = &psGlob->psComponents[uCount];
+      psComponent->pattern = pcPattern;
+      psComponent->anyDepth = (boolean)(strcmp(pcPattern, "**") == 0);
+      psComponent->prefixLength = strcspn(pcPattern, "*?[\\");
+      if (!psComponent->anyDepth || uCount == 0 ||
+          !psGlob->psComponents[uCount - 1].anyDepth)
+         uCount++;
+
+      if (pcEnd == NULL)
+         break;
+      pcPattern = pcEnd + 1;
+   }
+
+   psGlob->uComponents = uCount;
+}
+
+/*--------------------------------------------------------------------*/
+int PathGlob_find(Node root, const char *pcPattern,
+                  void (*pfMatch)(const char *pcPath, boolean isFile,
+                                  void *pvExtra),
+                  void *pvExtra) {
+   struct Glob sGlob;
+   uint64_t *puStart;
+   char *pcCopy;
+   const char *pc;
+   size_t uComponents = 1;
+   int status = SUCCESS;
+
+   assert(pcPattern != NULL);
+   assert(pfMatch != NULL);
+
+   if (root == NULL)
+      return SUCCESS;
+
+   for (pc = pcPattern; *pc != '\0'; pc++)
+      if (*pc == '/')
+         uComponents++;
+
+   memset(&sGlob, 0, sizeof(sGlob));
+   sGlob.pfMatch = pfMatch;
+   sGlob.pvExtra = pvExtra;
+   sGlob.uWords = uComponents / WORD_BITS + 1;
+
+   pcCopy = malloc(strlen(pcPattern) + 1);
+   sGlob.psComponents = malloc(uComponents * sizeof(struct Component));
+   puStart = calloc(sGlob.uWords, sizeof(uint64_t));
+   if (pcCopy == NULL || sGlob.psComponents == NULL ||
+       puStart == NULL || !PathGlob_reserve(&sGlob, 0))
+      status = MEMORY_ERROR;
+   else {
+      strcpy(pcCopy, pcPattern);
+      PathGlob_split(&sGlob, pcCopy);
+
+      /* The root's name is its whole path. */
+      PathGlob_addState(&sGlob, puStart, 0);
+      if (PathGlob_step(&sGlob, puStart, Node_getName(root),
+                        sGlob.puSets)) {
+         status = Node_appendName(root, &sGlob.sPath);
+         if (status == SUCCESS)
+            status = PathGlob_visit(&sGlob, root, 0);
+      }
+   }
+
+   free(sGlob.sPath.text);
+   free(puStart);
+   free(sGlob.puSets);
+   free(sGlob.psComponents);
+   free(pcCopy);
+   return status;
+}
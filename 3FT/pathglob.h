@@ -0,0 +1,47 @@
+/*--------------------------------------------------------------------*/
+/* pathglob.h                                                         */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#ifndef PATHGLOB_INCLUDED
+#define PATHGLOB_INCLUDED
+
+#include "a4def.h"
+
+/*
+  A glob pattern matches whole paths, one '/'-separated component at
+  a time. Within a component, '*' matches any run of characters, '?'
+  matches any one character, "[...]" matches any one character of a
+  class, with ranges such as a-z and negation by a leading '!' or '^',
+  and '\' makes the next character literal. A component that is
+  exactly "**" matches any number of whole components, including
+  none, so a last component of "**" matches a directory and
+  everything below it.
+
+  Matching follows the pattern down the tree, keeping the set of
+  pattern components each node may still match next. Subtrees whose
+  set becomes empty are never entered, and when every component in
+  the set starts with the same literal characters, only the range of
+  children whose names start with them is visited, found by binary
+  search since children are sorted by name.
+*/
+
+/* The Node type of node.h, which clients need not see. */
+struct node;
+
+/*--------------------------------------------------------------------*/
+/*
+  Calls pfMatch with the path of each node of the tree rooted at root,
+  which may be NULL, that matches the pattern pcPattern, with whether
+  the node is a file, and with pvExtra. Nodes are reported in
+  pre-order, files before directories and each in sorted order, and
+  pfMatch must not change the tree. Returns SUCCESS, or MEMORY_ERROR
+  if matching cannot allocate its state, in which case some matches
+  may have been reported.
+*/
+int PathGlob_find(struct node *root, const char *pcPattern,
+                  void (*pfMatch)(const char *pcPath, boolean isFile,
+                                  void *pvExtra),
+                  void *pvExtra);
+
+#endif
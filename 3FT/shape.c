@@ -0,0 +1,375 @@
+/*--------------------------------------------------------------------*/
+/* shape.c                                                            */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "node.h"
+#include "shape.h"
+
+/* The state of one traversal. */
+struct Walk {
+   /* The statistics being gathered. */
+   struct ShapeStats *psStats;
+   /* The random state for choosing children to sample. */
+   uint64_t uRandom;
+   /* The path of the node being visited, which may be reached
+      through the directory a copy copies. */
+   struct NodePath sPath;
+   /* SUCCESS, or MEMORY_ERROR once a path could not be built. */
+   int status;
+};
+
+/* The paths of the largest directories of the last Shape_compute,
+   in the order of its largest, which it allocates, since a directory
+   reached through the directory a copy copies has no path of its own
+   to point to. */
+static char *apcLargest[SHAPE_NUM_LARGEST];
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns a random number uniform in [0, 1) drawn from *psWalk.
+*/
+static double Shape_uniform(struct Walk *psWalk) {
+   assert(psWalk != NULL);
+
+   /* xorshift64* */
+   psWalk->uRandom ^= psWalk->uRandom >> 12;
+   psWalk->uRandom ^= psWalk->uRandom << 25;
+   psWalk->uRandom ^= psWalk->uRandom >> 27;
+   return (double)((psWalk->uRandom * 2685821657736338717u) >> 11) /
+      9007199254740992.0;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Adds weight to the bucket of adHist that uValue falls in.
+*/
+static void Shape_record(double adHist[SHAPE_NUM_BUCKETS],
+                         size_t uValue, double weight) {
+   uint64_t uBig = (uint64_t)uValue;
+   size_t uBucket;
+   int msb = 0;
+
+   if (uBig < SHAPE_SUB_BUCKETS)
+      uBucket = (size_t)uBig;
+   else {
+      while ((uBig >> (msb + 1)) != 0)
+         msb++;
+      uBucket = (size_t)(msb - SHAPE_SUB_BITS + 1) * SHAPE_SUB_BUCKETS +
+         (size_t)((uBig >> (msb - SHAPE_SUB_BITS)) &
+                  (SHAPE_SUB_BUCKETS - 1));
+   }
+   adHist[uBucket] += weight;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Keeps the directory named path, which has uChildren children, among
+  the largest of *psStats if it has more children than any of them,
+  with a copy of path. Returns SUCCESS, or MEMORY_ERROR if the copy
+  cannot be allocated.
+*/
+static int Shape_keepLargest(struct ShapeStats *psStats,
+                             const char *path, size_t uChildren) {
+   char *pcCopy;
+   size_t i;
+
+   assert(psStats != NULL);
+   assert(path != NULL);
+
+   i = SHAPE_NUM_LARGEST;
+   if (psStats->largest[i - 1].path != NULL &&
+       psStats->largest[i - 1].children >= uChildren)
+      return SUCCESS;
+
+   pcCopy = malloc(strlen(path) + 1);
+   if (pcCopy == NULL)
+      return MEMORY_ERROR;
+   strcpy(pcCopy, path);
+
+   /* Shift the smaller ones down to make room. */
+   free(apcLargest[i - 1]);
+   while (i > 1 && (psStats->largest[i - 2].path == NULL ||
+                    psStats->largest[i - 2].children < uChildren)) {
+      psStats->largest[i - 1] = psStats->largest[i - 2];
+      apcLargest[i - 1] = apcLargest[i - 2];
+      i--;
+   }
+   psStats->largest[i - 1].path = pcCopy;
+   psStats->largest[i - 1].children = uChildren;
+   apcLargest[i - 1] = pcCopy;
+   return SUCCESS;
+}
+
+/* Shape_sample and Shape_visit call each other. */
+static void Shape_visit(Node n, size_t uDepth, double weight,
+                        struct Walk *psWalk);
+
+/*--------------------------------------------------------------------*/
+/*
+  Visits n, a child of the node being visited, as Shape_visit does,
+  first appending its name to the path of *psWalk.
+*/
+static void Shape_visitChild(Node n, size_t uDepth, double weight,
+                             struct Walk *psWalk) {
+   size_t uPath;
+
+   assert(n != NULL);
+   assert(psWalk != NULL);
+
+   if (psWalk->status != SUCCESS)
+      return;
+   uPath = psWalk->sPath.length;
+   if (Node_appendName(n, &psWalk->sPath) != SUCCESS) {
+      psWalk->status = MEMORY_ERROR;
+      return;
+   }
+   Shape_visit(n, uDepth, weight, psWalk);
+   Node_truncatePath(&psWalk->sPath, uPath);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Visits the children of the directory n from uStart up to uEnd, at
+  depth uDepth, counting each node found as weight nodes. If there are
+  more than the most children to visit, visits that many spread
+  evenly from a random start instead, each standing for the children
+  around it.
+*/
+static void Shape_sample(Node n, size_t uStart, size_t uEnd,
+                         size_t uDepth, double weight,
+                         struct Walk *psWalk) {
+   size_t uMax;
+   double step;
+   double start;
+   size_t i;
+
+   assert(n != NULL);
+   assert(psWalk != NULL);
+
+   uMax = psWalk->psStats->maxChildren;
+   if (uEnd - uStart <= uMax) {
+      for (i = uStart; i < uEnd; i++)
+         Shape_visitChild(Node_getChild(n, i), uDepth, weight, psWalk);
+      return;
+   }
+
+   step = (double)(uEnd - uStart) / (double)uMax;
+   start = (double)uStart + Shape_uniform(psWalk) * step;
+   for (i = 0; i < uMax; i++)
+      Shape_visitChild(
+         Node_getChild(n, (size_t)(start + (double)i * step)), uDepth,
+         weight * step, psWalk);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Gathers the shape of the subtree rooted at n, at depth uDepth, whose
+  path is that of *psWalk, into the statistics of *psWalk, counting
+  each node found as weight nodes. A copy is read through the
+  directory it copies.
+*/
+static void Shape_visit(Node n, size_t uDepth, double weight,
+                        struct Walk *psWalk) {
+   struct ShapeStats *psStats;
+   size_t uLevel;
+   size_t uLength;
+   size_t uChildren;
+   size_t uMax;
+   size_t uFiles;
+   size_t i;
+
+   assert(n != NULL);
+   assert(psWalk != NULL);
+
+   psStats = psWalk->psStats;
+   psStats->visited++;
+   if (uDepth > psStats->maxDepth)
+      psStats->maxDepth = uDepth;
+   uLevel = (uDepth < SHAPE_NUM_LEVELS) ? uDepth : SHAPE_NUM_LEVELS - 1;
+
+   uLength = psWalk->sPath.length;
+   Shape_record(psStats->pathLengths, uLength, weight);
+   psStats->pathBytes += (double)uLength * weight;
+
+   if (Node_getType(n) == FIL) {
+      uLength = Node_getLength(n);
+      psStats->files += weight;
+      psStats->depthFiles[uLevel] += weight;
+      Shape_record(psStats->fileLengths, uLength, weight);
+      psStats->fileBytes += (double)uLength * weight;
+      return;
+   }
+
+   n = Node_getShared(n);
+   uChildren = Node_getNumChildren(n);
+   psStats->dirs += weight;
+   psStats->depthDirs[uLevel] += weight;
+   Shape_record(psStats->fanout[uLevel], uChildren, weight);
+   if (Shape_keepLargest(psStats, psWalk->sPath.text, uChildren) !=
+       SUCCESS) {
+      psWalk->status = MEMORY_ERROR;
+      return;
+   }
+
+   uMax = psStats->maxChildren;
+   if (uMax == 0 || uChildren <= uMax) {
+      for (i = 0; i < uChildren; i++)
+         Shape_visitChild(Node_getChild(n, i), uDepth + 1, weight,
+                          psWalk);
+      return;
+   }
+
+   /* FILs sort before DIRs, and the two differ most in what lies
+      below them, so sample each separately. */
+   uFiles = Node_getNumFileChildren(n);
+   Shape_sample(n, 0, uFiles, uDepth + 1, weight, psWalk);
+   Shape_sample(n, uFiles, uChildren, uDepth + 1, weight, psWalk);
+}
+
+/*--------------------------------------------------------------------*/
+int Shape_compute(Node root, struct ShapeStats *psStats,
+                  size_t uMaxChildren, unsigned long uSeed) {
+   struct Walk sWalk;
+   size_t i;
+
+   assert(psStats != NULL);
+
+   memset(psStats, 0, sizeof(struct ShapeStats));
+   psStats->maxChildren = uMaxChildren;
+   for (i = 0; i < SHAPE_NUM_LARGEST; i++) {
+      free(apcLargest[i]);
+      apcLargest[i] = NULL;
+   }
+
+   memset(&sWalk, 0, sizeof(sWalk));
+   sWalk.psStats = psStats;
+   sWalk.uRandom = (uint64_t)uSeed * 2 + 1;
+   sWalk.status = SUCCESS;
+
+   if (root != NULL) {
+      if (Node_appendName(root, &sWalk.sPath) != SUCCESS)
+         sWalk.status = MEMORY_ERROR;
+      else
+         Shape_visit(root, 0, 1.0, &sWalk);
+   }
+   free(sWalk.sPath.text);
+   return sWalk.status;
+}
+
+/*--------------------------------------------------------------------*/
+size_t Shape_bucketLimit(size_t uBucket) {
+   int shift;
+
+   assert(uBucket < SHAPE_NUM_BUCKETS);
+
+   if (uBucket < SHAPE_SUB_BUCKETS)
+      return uBucket;
+
+   shift = (int)(uBucket / SHAPE_SUB_BUCKETS) - 1;
+   return (size_t)((((uint64_t)(SHAPE_SUB_BUCKETS +
+                                uBucket % SHAPE_SUB_BUCKETS) + 1)
+                    << shift) - 1);
+}
+
+/*--------------------------------------------------------------------*/
+size_t Shape_quantile(const double adHist[SHAPE_NUM_BUCKETS],
+                      double q) {
+   double total = 0.0;
+   double seen = 0.0;
+   size_t uBucket;
+   size_t uLast = 0;
+
+   assert(adHist != NULL);
+
+   for (uBucket = 0; uBucket < SHAPE_NUM_BUCKETS; uBucket++)
+      if (adHist[uBucket] > 0.0) {
+         total += adHist[uBucket];
+         uLast = uBucket;
+      }
+   if (total == 0.0)
+      return 0;
+
+   for (uBucket = 0; uBucket < uLast; uBucket++) {
+      seen += adHist[uBucket];
+      if (seen >= q * total)
+         break;
+   }
+   return Shape_bucketLimit(uBucket);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Writes the mean and quantiles of the histogram adHist, whose weights
+  total total and whose values sum to sum, to psFile as a row titled
+  title.
+*/
+static void Shape_writeDistribution(FILE *psFile, const char *title,
+                                    const double adHist[], double total,
+                                    double sum) {
+   assert(psFile != NULL);
+   assert(title != NULL);
+   assert(adHist != NULL);
+
+   fprintf(psFile, "%-14s %12.1f %10lu %10lu %10lu %10lu\n", title,
+           (total > 0.0) ? sum / total : 0.0,
+           (unsigned long)Shape_quantile(adHist, 0.50),
+           (unsigned long)Shape_quantile(adHist, 0.90),
+           (unsigned long)Shape_quantile(adHist, 0.99),
+           (unsigned long)Shape_quantile(adHist, 1.0));
+}
+
+/*--------------------------------------------------------------------*/
+void Shape_write(FILE *psFile, const struct ShapeStats *psStats) {
+   size_t uLevel;
+   size_t uLevels;
+   size_t i;
+
+   assert(psFile != NULL);
+   assert(psStats != NULL);
+
+   fprintf(psFile, "%lu nodes visited",
+           (unsigned long)psStats->visited);
+   if (psStats->maxChildren != 0)
+      fprintf(psFile, ", at most %lu children per directory",
+              (unsigned long)psStats->maxChildren);
+   fprintf(psFile, "\n%.0f directories, %.0f files, deepest at %lu\n",
+           psStats->dirs, psStats->files,
+           (unsigned long)psStats->maxDepth);
+
+   fprintf(psFile, "\n%-6s %12s %12s %10s %10s %10s\n", "depth",
+           "dirs", "files", "fanout p50", "p90", "max");
+   uLevels = (psStats->maxDepth < SHAPE_NUM_LEVELS) ?
+      psStats->maxDepth + 1 : SHAPE_NUM_LEVELS;
+   for (uLevel = 0; uLevel < uLevels; uLevel++)
+      fprintf(psFile, "%-6lu %12.0f %12.0f %10lu %10lu %10lu\n",
+              (unsigned long)uLevel, psStats->depthDirs[uLevel],
+              psStats->depthFiles[uLevel],
+              (unsigned long)Shape_quantile(psStats->fanout[uLevel],
+                                            0.50),
+              (unsigned long)Shape_quantile(psStats->fanout[uLevel],
+                                            0.90),
+              (unsigned long)Shape_quantile(psStats->fanout[uLevel],
+                                            1.0));
+
+   fprintf(psFile, "\n%-14s %12s %10s %10s %10s %10s\n", "length",
+           "mean", "p50", "p90", "p99", "max");
+   Shape_writeDistribution(psFile, "path", psStats->pathLengths,
+                           psStats->dirs + psStats->files,
+                           psStats->pathBytes);
+   Shape_writeDistribution(psFile, "file contents",
+                           psStats->fileLengths, psStats->files,
+                           psStats->fileBytes);
+
+   fprintf(psFile, "\nlargest directories:\n");
+   for (i = 0; i < SHAPE_NUM_LARGEST; i++)
+      if (psStats->largest[i].path != NULL)
+         fprintf(psFile, "%10lu %s\n",
+                 (unsigned long)psStats->largest[i].children,
+                 psStats->largest[i].path);
+}
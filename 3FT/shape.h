@@ -0,0 +1,113 @@
+/*--------------------------------------------------------------------*/
+/* shape.h                                                            */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#ifndef SHAPE_INCLUDED
+#define SHAPE_INCLUDED
+
+#include <stddef.h>
+#include <stdio.h>
+
+/*
+  Shape statistics describe a File Tree as a whole: how many nodes
+  sit at each depth, how many children directories at each depth
+  have, which directories are largest, and how long paths and file
+  contents are. They are gathered in one pre-order traversal.
+
+  In sampling mode, the traversal descends into at most a fixed number
+  of the children of each directory, spread evenly from a random
+  start, and weights everything found below them by the ratio of
+  children to children visited. The counts are then unbiased
+  estimates, and the traversal's cost is bounded by the sample size
+  and the depth rather than by the size of the tree. Histograms hold
+  weighted counts, so they are doubles in both modes.
+
+  Histograms are log-linear: exact below 2^SHAPE_SUB_BITS, then
+  SHAPE_SUB_BUCKETS buckets per power of two.
+*/
+enum { SHAPE_SUB_BITS = 2, SHAPE_SUB_BUCKETS = 1 << SHAPE_SUB_BITS,
+       SHAPE_NUM_BUCKETS = (64 - SHAPE_SUB_BITS + 1) *
+                           SHAPE_SUB_BUCKETS };
+
+/* The depths kept apart; deeper nodes are counted at the last. */
+enum { SHAPE_NUM_LEVELS = 32 };
+
+/* The number of largest directories kept. */
+enum { SHAPE_NUM_LARGEST = 10 };
+
+/* The Node type of node.h, which clients need not see. */
+struct node;
+
+/* A directory and its number of children. */
+struct ShapeDir {
+   const char *path;
+   size_t children;
+};
+
+/* The shape of a File Tree. It is large: keep it static or on the
+   heap. */
+struct ShapeStats {
+   /* The largest number of children visited per directory, or 0 if
+      every node was visited. */
+   size_t maxChildren;
+   /* The number of nodes actually visited. */
+   size_t visited;
+   /* The estimated numbers of directories and files. */
+   double dirs;
+   double files;
+   /* The deepest node visited; the root is at depth 0. */
+   size_t maxDepth;
+   /* The estimated directories and files at each depth. */
+   double depthDirs[SHAPE_NUM_LEVELS];
+   double depthFiles[SHAPE_NUM_LEVELS];
+   /* The histogram of the number of children of the directories at
+      each depth. */
+   double fanout[SHAPE_NUM_LEVELS][SHAPE_NUM_BUCKETS];
+   /* The directories with the most children, most first. Their paths
+      are only valid until Shape_compute is next called. Unused
+      entries have NULL paths. */
+   struct ShapeDir largest[SHAPE_NUM_LARGEST];
+   /* The histograms of the lengths of paths, and of file contents as
+      given by Node_getLength. */
+   double pathLengths[SHAPE_NUM_BUCKETS];
+   double fileLengths[SHAPE_NUM_BUCKETS];
+   /* The estimated total bytes of paths and of file contents. */
+   double pathBytes;
+   double fileBytes;
+};
+
+/*--------------------------------------------------------------------*/
+/*
+  Stores the shape of the tree rooted at root, which may be NULL, in
+  *psStats. Visits every node if uMaxChildren is 0, and otherwise at
+  most uMaxChildren children of each directory, drawn with the seed
+  uSeed. A copy is read through the directory it copies, so it is
+  left to be copied lazily. Returns SUCCESS, or MEMORY_ERROR if unable
+  to allocate sufficient memory for the paths the walk builds, in
+  which case *psStats is incomplete.
+*/
+int Shape_compute(struct node *root, struct ShapeStats *psStats,
+                  size_t uMaxChildren, unsigned long uSeed);
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the greatest value that falls in histogram bucket uBucket.
+*/
+size_t Shape_bucketLimit(size_t uBucket);
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns an upper bound, within the bucket precision, of the value
+  below which the fraction q of the weight of the histogram adHist
+  falls, or 0 if it is empty.
+*/
+size_t Shape_quantile(const double adHist[SHAPE_NUM_BUCKETS], double q);
+
+/*--------------------------------------------------------------------*/
+/*
+  Writes a readable summary of *psStats to psFile.
+*/
+void Shape_write(FILE *psFile, const struct ShapeStats *psStats);
+
+#endif
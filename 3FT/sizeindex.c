@@ -0,0 +1,334 @@
+/*--------------------------------------------------------------------*/
+/* sizeindex.c                                                        */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "node.h"
+#include "sizeindex.h"
+
+/* The most levels of the list, enough for 4^16 entries. */
+enum { MAX_LEVELS = 16 };
+
+/* The seed of the levels drawn for new entries. */
+#define SIZEINDEX_SEED 0x9e3779b97f4a7c15ULL
+
+/* One file node of the list. */
+struct SizeEntry {
+   /* The node, and the length it is ordered by. */
+   Node node;
+   size_t length;
+   /* The entry before this one, or NULL if it is the first. */
+   struct SizeEntry *prev;
+   /* The number of levels the entry is linked into. */
+   size_t levels;
+   /* The next entry at each level, or NULL at the end, in an array
+      of levels elements allocated with the entry, just after it. */
+   struct SizeEntry **next;
+};
+
+/* A SizeIndex is a skip list of SizeEntry objects. */
+struct SizeIndex {
+   /* A sentinel before the first entry, linked into every level. */
+   struct SizeEntry *head;
+   /* The last entry, or NULL if there are none. */
+   struct SizeEntry *tail;
+   /* The number of levels in use, at least 1. */
+   size_t levels;
+   /* The state of the generator of levels. */
+   uint64_t state;
+};
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns a new SizeEntry for Node n of length uLength, linked into
+  uLevels levels, with no links yet, or NULL if insufficient memory is
+  available.
+*/
+static struct SizeEntry *SizeIndex_newEntry(Node n, size_t uLength,
+                                            size_t uLevels) {
+   struct SizeEntry *psEntry;
+   size_t i;
+
+   psEntry = malloc(sizeof(struct SizeEntry) +
+                    uLevels * sizeof(struct SizeEntry *));
+   if (psEntry == NULL)
+      return NULL;
+
+   psEntry->next = (struct SizeEntry **)(psEntry + 1);
+   psEntry->node = n;
+   psEntry->length = uLength;
+   psEntry->prev = NULL;
+   psEntry->levels = uLevels;
+   for (i = 0; i < uLevels; i++)
+      psEntry->next[i] = NULL;
+   return psEntry;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the number of levels for a new entry of oIndex: 1, plus 1
+  more with probability 1/4 each time, up to MAX_LEVELS.
+*/
+static size_t SizeIndex_drawLevels(SizeIndex_T oIndex) {
+   uint64_t uBits;
+   size_t uLevels = 1;
+
+   assert(oIndex != NULL);
+
+   /* xorshift64 */
+   oIndex->state ^= oIndex->state << 13;
+   oIndex->state ^= oIndex->state >> 7;
+   oIndex->state ^= oIndex->state << 17;
+
+   for (uBits = oIndex->state; (uBits & 3) == 0 &&
+           uLevels < MAX_LEVELS; uBits >>= 2)
+      uLevels++;
+   return uLevels;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Compares the entry psEntry with the key of length uLength and Node
+  n, where a NULL n comes before every node of its length. Nodes of
+  one length are ordered by address, which a move does not change.
+*/
+static int SizeIndex_compare(const struct SizeEntry *psEntry,
+                             size_t uLength, Node n) {
+   assert(psEntry != NULL);
+
+   if (psEntry->length != uLength)
+      return (psEntry->length < uLength) ? -1 : 1;
+   if (n == NULL)
+      return 1;
+   if (psEntry->node != n)
+      return ((uintptr_t)psEntry->node < (uintptr_t)n) ? -1 : 1;
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the first entry of oIndex not less than the key of length
+  uLength and Node n, or NULL if there is none. If ppsBefore is
+  not NULL, stores in ppsBefore[i] the last entry, or the head,
+  before it at each level i in use.
+*/
+static struct SizeEntry *SizeIndex_seek(SizeIndex_T oIndex,
+                                        size_t uLength, Node n,
+                                        struct SizeEntry **ppsBefore) {
+   struct SizeEntry *psEntry;
+   size_t uLevel;
+
+   assert(oIndex != NULL);
+
+   psEntry = oIndex->head;
+   for (uLevel = oIndex->levels; uLevel-- > 0;) {
+      while (psEntry->next[uLevel] != NULL &&
+             SizeIndex_compare(psEntry->next[uLevel], uLength, n) < 0)
+         psEntry = psEntry->next[uLevel];
+      if (ppsBefore != NULL)
+         ppsBefore[uLevel] = psEntry;
+   }
+   return psEntry->next[0];
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Links psEntry, which must not be in oIndex, into oIndex in order of
+  its length and its node.
+*/
+static void SizeIndex_link(SizeIndex_T oIndex,
+                           struct SizeEntry *psEntry) {
+   struct SizeEntry *apsBefore[MAX_LEVELS];
+   size_t i;
+
+   assert(oIndex != NULL);
+   assert(psEntry != NULL);
+
+   (void)SizeIndex_seek(oIndex, psEntry->length, psEntry->node,
+                        apsBefore);
+   for (; oIndex->levels < psEntry->levels; oIndex->levels++)
+      apsBefore[oIndex->levels] = oIndex->head;
+
+   for (i = 0; i < psEntry->levels; i++) {
+      psEntry->next[i] = apsBefore[i]->next[i];
+      apsBefore[i]->next[i] = psEntry;
+   }
+
+   psEntry->prev = (apsBefore[0] == oIndex->head) ? NULL : apsBefore[0];
+   if (psEntry->next[0] != NULL)
+      psEntry->next[0]->prev = psEntry;
+   else
+      oIndex->tail = psEntry;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Unlinks the entry of Node n, ordered by length uLength, from oIndex.
+  Returns the entry, or NULL if n is not in oIndex under uLength.
+*/
+static struct SizeEntry *SizeIndex_unlink(SizeIndex_T oIndex, Node n,
+                                          size_t uLength) {
+   struct SizeEntry *apsBefore[MAX_LEVELS];
+   struct SizeEntry *psEntry;
+   size_t i;
+
+   assert(oIndex != NULL);
+   assert(n != NULL);
+
+   psEntry = SizeIndex_seek(oIndex, uLength, n, apsBefore);
+   if (psEntry == NULL || psEntry->node != n)
+      return NULL;
+
+   for (i = 0; i < psEntry->levels; i++)
+      apsBefore[i]->next[i] = psEntry->next[i];
+   if (psEntry->next[0] != NULL)
+      psEntry->next[0]->prev = psEntry->prev;
+   else
+      oIndex->tail = psEntry->prev;
+
+   while (oIndex->levels > 1 &&
+          oIndex->head->next[oIndex->levels - 1] == NULL)
+      oIndex->levels--;
+   return psEntry;
+}
+
+/*--------------------------------------------------------------------*/
+SizeIndex_T SizeIndex_new(void) {
+   SizeIndex_T oIndex;
+
+   oIndex = malloc(sizeof(struct SizeIndex));
+   if (oIndex == NULL)
+      return NULL;
+
+   oIndex->head = SizeIndex_newEntry(NULL, 0, MAX_LEVELS);
+   if (oIndex->head == NULL) {
+      free(oIndex);
+      return NULL;
+   }
+   oIndex->tail = NULL;
+   oIndex->levels = 1;
+   oIndex->state = SIZEINDEX_SEED;
+   return oIndex;
+}
+
+/*--------------------------------------------------------------------*/
+void SizeIndex_free(SizeIndex_T oIndex) {
+   if (oIndex == NULL)
+      return;
+
+   SizeIndex_clear(oIndex);
+   free(oIndex->head);
+   free(oIndex);
+}
+
+/*--------------------------------------------------------------------*/
+void SizeIndex_clear(SizeIndex_T oIndex) {
+   struct SizeEntry *psEntry;
+   struct SizeEntry *psNext;
+   size_t i;
+
+   assert(oIndex != NULL);
+
+   for (psEntry = oIndex->head->next[0]; psEntry != NULL;
+        psEntry = psNext) {
+      psNext = psEntry->next[0];
+      free(psEntry);
+   }
+   for (i = 0; i < MAX_LEVELS; i++)
+      oIndex->head->next[i] = NULL;
+   oIndex->tail = NULL;
+   oIndex->levels = 1;
+}
+
+/*--------------------------------------------------------------------*/
+int SizeIndex_add(SizeIndex_T oIndex, Node n) {
+   struct SizeEntry *psEntry;
+
+   assert(oIndex != NULL);
+   assert(n != NULL);
+   assert(Node_getType(n) == FIL);
+
+   psEntry = SizeIndex_newEntry(n, Node_getLength(n),
+                                SizeIndex_drawLevels(oIndex));
+   if (psEntry == NULL)
+      return FALSE;
+
+   SizeIndex_link(oIndex, psEntry);
+   return TRUE;
+}
+
+/*--------------------------------------------------------------------*/
+void SizeIndex_remove(SizeIndex_T oIndex, Node n) {
+   assert(oIndex != NULL);
+   assert(n != NULL);
+
+   free(SizeIndex_unlink(oIndex, n, Node_getLength(n)));
+}
+
+/*--------------------------------------------------------------------*/
+void SizeIndex_update(SizeIndex_T oIndex, Node n, size_t uOldLength) {
+   struct SizeEntry *psEntry;
+
+   assert(oIndex != NULL);
+   assert(n != NULL);
+
+   if (Node_getLength(n) == uOldLength)
+      return;
+
+   /* Relink the same entry, so that moving it cannot fail. */
+   psEntry = SizeIndex_unlink(oIndex, n, uOldLength);
+   if (psEntry == NULL)
+      return;
+   psEntry->length = Node_getLength(n);
+   SizeIndex_link(oIndex, psEntry);
+}
+
+/*--------------------------------------------------------------------*/
+int SizeIndex_findRange(SizeIndex_T oIndex, size_t uMin, size_t uMax,
+                        void (*pfVisit)(const char *pcPath,
+                                        size_t uLength,
+                                        void *pvExtra),
+                        void *pvExtra) {
+   struct SizeEntry *psEntry;
+   const char *pcPath;
+
+   assert(oIndex != NULL);
+   assert(pfVisit != NULL);
+
+   for (psEntry = SizeIndex_seek(oIndex, uMin, NULL, NULL);
+        psEntry != NULL && psEntry->length <= uMax;
+        psEntry = psEntry->next[0]) {
+      pcPath = Node_getPath(psEntry->node);
+      if (pcPath == NULL)
+         return MEMORY_ERROR;
+      pfVisit(pcPath, psEntry->length, pvExtra);
+   }
+   return SUCCESS;
+}
+
+/*--------------------------------------------------------------------*/
+int SizeIndex_findLargest(SizeIndex_T oIndex, size_t uCount,
+                          void (*pfVisit)(const char *pcPath,
+                                          size_t uLength,
+                                          void *pvExtra),
+                          void *pvExtra) {
+   struct SizeEntry *psEntry;
+   const char *pcPath;
+
+   assert(oIndex != NULL);
+   assert(pfVisit != NULL);
+
+   for (psEntry = oIndex->tail; psEntry != NULL && uCount > 0;
+        psEntry = psEntry->prev, uCount--) {
+      pcPath = Node_getPath(psEntry->node);
+      if (pcPath == NULL)
+         return MEMORY_ERROR;
+      pfVisit(pcPath, psEntry->length, pvExtra);
+   }
+   return SUCCESS;
+}
@@ -0,0 +1,101 @@
+/*--------------------------------------------------------------------*/
+/* sizeindex.h                                                        */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#ifndef SIZEINDEX_INCLUDED
+#define SIZEINDEX_INCLUDED
+
+#include <stddef.h>
+
+#include "a4def.h"
+
+/*
+  A SizeIndex_T keeps file nodes in order of length, and nodes of
+  equal length in order of address, in a skip list: a sorted linked list
+  in which each entry also links, with probability 1/4 per level, to
+  the next entry of its level, so that an entry is found from the
+  top level down in O(log n) expected steps, and a new one is linked
+  in without moving any other. The lowest level also links each entry
+  to the one before it, so the list can be walked from the largest
+  file down. The index does not own its nodes: they must be removed
+  from it before they are destroyed.
+*/
+typedef struct SizeIndex *SizeIndex_T;
+
+/* The Node type of node.h, which clients need not see. */
+struct node;
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns a new empty SizeIndex_T, or NULL if insufficient memory is
+  available.
+*/
+SizeIndex_T SizeIndex_new(void);
+
+/*--------------------------------------------------------------------*/
+/*
+  Frees oIndex, but not the nodes in it.
+*/
+void SizeIndex_free(SizeIndex_T oIndex);
+
+/*--------------------------------------------------------------------*/
+/*
+  Removes every node from oIndex.
+*/
+void SizeIndex_clear(SizeIndex_T oIndex);
+
+/*--------------------------------------------------------------------*/
+/*
+  Adds the file node n, which must not be in oIndex, to oIndex under
+  its length. Returns 1 (TRUE) if successful, or 0 (FALSE) if
+  insufficient memory is available, in which case oIndex is
+  unchanged.
+*/
+int SizeIndex_add(SizeIndex_T oIndex, struct node *n);
+
+/*--------------------------------------------------------------------*/
+/*
+  Removes the file node n from oIndex, if it is there.
+*/
+void SizeIndex_remove(SizeIndex_T oIndex, struct node *n);
+
+/*--------------------------------------------------------------------*/
+/*
+  Moves the file node n, whose length has just changed from
+  uOldLength, to its place for its new length in oIndex, if it is
+  there.
+*/
+void SizeIndex_update(SizeIndex_T oIndex, struct node *n,
+                      size_t uOldLength);
+
+/*--------------------------------------------------------------------*/
+/*
+  Calls pfVisit with the path and length of each file node in oIndex
+  whose length is from uMin to uMax, inclusive, and with pvExtra, in
+  increasing order of length; the order of nodes of equal length is
+  unspecified. pfVisit must not change oIndex. Returns SUCCESS, or
+  MEMORY_ERROR if a path cannot be rebuilt after a move, in which case
+  the visits stop there.
+*/
+int SizeIndex_findRange(SizeIndex_T oIndex, size_t uMin, size_t uMax,
+                        void (*pfVisit)(const char *pcPath,
+                                        size_t uLength,
+                                        void *pvExtra),
+                        void *pvExtra);
+
+/*--------------------------------------------------------------------*/
+/*
+  Calls pfVisit with the path and length of the uCount longest file
+  nodes in oIndex, or all of them if there are fewer, and with
+  pvExtra, in decreasing order of length; the order of nodes of equal
+  length is unspecified. pfVisit must not change oIndex. Returns
+  SUCCESS or MEMORY_ERROR as SizeIndex_findRange does.
+*/
+int SizeIndex_findLargest(SizeIndex_T oIndex, size_t uCount,
+                          void (*pfVisit)(const char *pcPath,
+                                          size_t uLength,
+                                          void *pvExtra),
+                          void *pvExtra);
+
+#endif
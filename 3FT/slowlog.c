@@ -0,0 +1,227 @@
+/*--------------------------------------------------------------------*/
+/* slowlog.c                                                          */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "ft.h"
+#include "slowlog.h"
+
+/* The room for one dumped line. */
+enum { LINE_SIZE = SLOWLOG_PATH_SIZE + 128 };
+
+/* One slot of the ring buffer. */
+struct Slot {
+   /* 2t + 1 while call t is being written to the slot, 2t + 2 once it
+      is, and 0 before any call is. */
+   volatile uint64_t stamp;
+   struct SlowOp op;
+};
+
+/* Printable names of the FT functions, by FT_OP_ value. */
+static const char *opNames[FT_NUM_OPS] = {
+   "FT_init", "FT_destroy", "FT_insertDir", "FT_insertFile",
+   "FT_containsDir", "FT_containsFile", "FT_rmDir", "FT_rmFile",
+   "FT_getFileContents", "FT_replaceFileContents", "FT_stat",
+   "FT_toString", "FT_move", "FT_copy", "FT_glob", "FT_listDir",
+   "FT_statEx", "FT_findByName", "FT_findByNamePrefix", "FT_scanRange",
+   "FT_grep", "FT_filesBySize", "FT_largestFiles", "FT_nth", "FT_rank"
+};
+
+/*--------------------------------------------------------------------*/
+/* The log is an Abstract Object with 4 state variables: */
+
+/* The ring buffer; call t goes to slot t % SLOWLOG_SIZE. */
+static struct Slot slots[SLOWLOG_SIZE];
+
+/* The number of calls ever logged, and the first not cleared. */
+static volatile uint64_t head;
+static volatile uint64_t tail;
+
+/* The file descriptor the signal handler dumps to. */
+static volatile sig_atomic_t dumpFd = 2;
+
+/*--------------------------------------------------------------------*/
+void SlowLog_record(int op, const char *path, int status,
+                    uint64_t uNanoseconds, uint64_t uNodes) {
+   struct Slot *psSlot;
+   uint64_t uTicket;
+   size_t i = 0;
+
+   assert(op >= 0 && op < FT_NUM_OPS);
+
+   uTicket = __sync_fetch_and_add(&head, 1);
+   psSlot = &slots[uTicket % SLOWLOG_SIZE];
+
+   psSlot->stamp = 2 * uTicket + 1;
+   __sync_synchronize();
+
+   psSlot->op.sequence = uTicket;
+   psSlot->op.op = op;
+   psSlot->op.status = status;
+   psSlot->op.nanoseconds = uNanoseconds;
+   psSlot->op.nodes = uNodes;
+   if (path != NULL)
+      for (; path[i] != '\0'; i++)
+         if (i < SLOWLOG_PATH_SIZE - 1)
+            psSlot->op.path[i] = path[i];
+   psSlot->op.pathLength = i;
+   psSlot->op.path[(i < SLOWLOG_PATH_SIZE) ? i :
+                   SLOWLOG_PATH_SIZE - 1] = '\0';
+
+   __sync_synchronize();
+   psSlot->stamp = 2 * uTicket + 2;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Copies call uTicket to *psOp. Returns 1 if successful, 0 if it has
+  been overwritten or is being written.
+*/
+static int SlowLog_copy(uint64_t uTicket, struct SlowOp *psOp) {
+   struct Slot *psSlot;
+   uint64_t uStamp;
+
+   assert(psOp != NULL);
+
+   psSlot = &slots[uTicket % SLOWLOG_SIZE];
+   uStamp = psSlot->stamp;
+   if (uStamp != 2 * uTicket + 2)
+      return 0;
+
+   __sync_synchronize();
+   *psOp = psSlot->op;
+   __sync_synchronize();
+   return psSlot->stamp == uStamp;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the first call still in the log.
+*/
+static uint64_t SlowLog_first(void) {
+   uint64_t uHead = head;
+   uint64_t uTail = tail;
+
+   if (uHead - uTail > SLOWLOG_SIZE)
+      return uHead - SLOWLOG_SIZE;
+   return uTail;
+}
+
+/*--------------------------------------------------------------------*/
+size_t SlowLog_read(struct SlowOp *psOps, size_t uMaxOps) {
+   uint64_t uTicket;
+   uint64_t uHead = head;
+   size_t uCount = 0;
+
+   assert(psOps != NULL || uMaxOps == 0);
+
+   for (uTicket = SlowLog_first(); uTicket < uHead &&
+           uCount < uMaxOps; uTicket++)
+      if (SlowLog_copy(uTicket, &psOps[uCount]))
+         uCount++;
+   return uCount;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Appends the string pcString to the line pcLine of length *puLength,
+  as far as it fits.
+*/
+static void SlowLog_append(char *pcLine, size_t *puLength,
+                           const char *pcString) {
+   assert(pcLine != NULL);
+   assert(puLength != NULL);
+   assert(pcString != NULL);
+
+   while (*pcString != '\0' && *puLength < LINE_SIZE)
+      pcLine[(*puLength)++] = *pcString++;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Appends the decimal digits of uValue to the line pcLine of length
+  *puLength, as far as they fit.
+*/
+static void SlowLog_appendNumber(char *pcLine, size_t *puLength,
+                                 uint64_t uValue) {
+   char acDigits[21];
+   size_t i = sizeof(acDigits) - 1;
+
+   acDigits[i] = '\0';
+   do {
+      acDigits[--i] = (char)('0' + uValue % 10);
+      uValue /= 10;
+   } while (uValue != 0);
+   SlowLog_append(pcLine, puLength, &acDigits[i]);
+}
+
+/*--------------------------------------------------------------------*/
+void SlowLog_dump(int fd) {
+   struct SlowOp sOp;
+   char acLine[LINE_SIZE];
+   size_t uLength;
+   uint64_t uTicket;
+   uint64_t uHead = head;
+
+   for (uTicket = SlowLog_first(); uTicket < uHead; uTicket++) {
+      if (!SlowLog_copy(uTicket, &sOp))
+         continue;
+
+      uLength = 0;
+      SlowLog_append(acLine, &uLength, "slow #");
+      SlowLog_appendNumber(acLine, &uLength, sOp.sequence);
+      SlowLog_append(acLine, &uLength, " ");
+      SlowLog_append(acLine, &uLength, opNames[sOp.op]);
+      SlowLog_append(acLine, &uLength, " status=");
+      SlowLog_appendNumber(acLine, &uLength, (uint64_t)sOp.status);
+      SlowLog_append(acLine, &uLength, " ns=");
+      SlowLog_appendNumber(acLine, &uLength, sOp.nanoseconds);
+      SlowLog_append(acLine, &uLength, " nodes=");
+      SlowLog_appendNumber(acLine, &uLength, sOp.nodes);
+      if (sOp.pathLength > 0) {
+         SlowLog_append(acLine, &uLength, " path=");
+         SlowLog_append(acLine, &uLength, sOp.path);
+         if (sOp.pathLength >= SLOWLOG_PATH_SIZE)
+            SlowLog_append(acLine, &uLength, "...");
+      }
+      SlowLog_append(acLine, &uLength, "\n");
+
+      if (write(fd, acLine, uLength) < 0)
+         return;
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Dumps the log when signal signum arrives.
+*/
+static void SlowLog_handle(int signum) {
+   (void)signum;
+
+   SlowLog_dump(dumpFd);
+}
+
+/*--------------------------------------------------------------------*/
+int SlowLog_dumpOnSignal(int signum, int fd) {
+   struct sigaction sAction;
+
+   dumpFd = fd;
+
+   memset(&sAction, 0, sizeof(sAction));
+   sAction.sa_handler = SlowLog_handle;
+   sAction.sa_flags = SA_RESTART;
+   (void)sigemptyset(&sAction.sa_mask);
+   return sigaction(signum, &sAction, NULL) == 0;
+}
+
+/*--------------------------------------------------------------------*/
+void SlowLog_clear(void) {
+   tail = head;
+}
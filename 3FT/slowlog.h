@@ -0,0 +1,83 @@
+/*--------------------------------------------------------------------*/
+/* slowlog.h                                                          */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#ifndef SLOWLOG_INCLUDED
+#define SLOWLOG_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+  The slow-op log keeps the last SLOWLOG_SIZE FT calls that took at
+  least a threshold, in a ring buffer that any number of threads can
+  record into and read from without locks. Each slot carries a stamp
+  that is odd while the slot is being written, so readers can skip
+  slots that change while they copy them.
+
+  Dumping writes with write(2) alone, without stdio or allocation, so
+  that it is safe from a signal handler.
+*/
+
+/* The number of calls kept; older ones are overwritten. */
+enum { SLOWLOG_SIZE = 256 };
+
+/* The most bytes of each call's path kept, counting the '\0'. */
+enum { SLOWLOG_PATH_SIZE = 192 };
+
+/* One slow call. */
+struct SlowOp {
+   /* The number of slow calls logged before this one. */
+   uint64_t sequence;
+   /* The FT function called, as an FT_OP_ value. */
+   int op;
+   /* The status the call ended in; see struct OpStats in stats.h. */
+   int status;
+   /* The nanoseconds the call took. */
+   uint64_t nanoseconds;
+   /* The nodes its path lookups descended through. */
+   uint64_t nodes;
+   /* The length of its path, or 0 if it had none, and as much of the
+      path as fits, always '\0'-terminated. */
+   size_t pathLength;
+   char path[SLOWLOG_PATH_SIZE];
+};
+
+/*--------------------------------------------------------------------*/
+/*
+  Logs a call of the FT function op on path (NULL if none) that ended
+  in status after uNanoseconds, having visited uNodes nodes.
+*/
+void SlowLog_record(int op, const char *path, int status,
+                    uint64_t uNanoseconds, uint64_t uNodes);
+
+/*--------------------------------------------------------------------*/
+/*
+  Copies the logged calls, oldest first, to the array psOps of room
+  uMaxOps, skipping any that are being overwritten. Returns the number
+  copied.
+*/
+size_t SlowLog_read(struct SlowOp *psOps, size_t uMaxOps);
+
+/*--------------------------------------------------------------------*/
+/*
+  Writes the logged calls, oldest first, one per line, to the file
+  descriptor fd. Is async-signal-safe.
+*/
+void SlowLog_dump(int fd);
+
+/*--------------------------------------------------------------------*/
+/*
+  Makes the signal signum dump the log to the file descriptor fd.
+  Returns 1 if successful, 0 if the handler cannot be installed.
+*/
+int SlowLog_dumpOnSignal(int signum, int fd);
+
+/*--------------------------------------------------------------------*/
+/*
+  Empties the log. Calls being logged at the same time may survive.
+*/
+void SlowLog_clear(void);
+
+#endif
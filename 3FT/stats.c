@@ -0,0 +1,173 @@
+/*--------------------------------------------------------------------*/
+/* stats.c                                                            */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "stats.h"
+
+/* The counts of one thread, kept on a list of every thread's. */
+struct Shard {
+   struct Stats stats;
+   struct Shard *next;
+};
+
+/*--------------------------------------------------------------------*/
+/* The counts are an Abstract Object with 2 state variables: */
+
+/* The list of every thread's shard. Shards are only ever pushed on
+   its head, so that readers can walk it without locking, and are kept
+   after their threads exit so that no counts are lost. */
+static struct Shard *shards;
+
+/* The calling thread's shard, or NULL until it records a call. */
+static __thread struct Shard *myShard;
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the bucket that the latency uNanoseconds falls in.
+*/
+static size_t Stats_bucket(uint64_t uNanoseconds) {
+   int msb = 0;
+
+   if (uNanoseconds < STATS_SUB_BUCKETS)
+      return (size_t)uNanoseconds;
+
+   while ((uNanoseconds >> (msb + 1)) != 0)
+      msb++;
+   return (size_t)(msb - STATS_SUB_BITS + 1) * STATS_SUB_BUCKETS +
+      (size_t)((uNanoseconds >> (msb - STATS_SUB_BITS)) &
+               (STATS_SUB_BUCKETS - 1));
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the calling thread's shard, allocating and listing it if it
+  has none. Returns NULL if there is an allocation error.
+*/
+static struct Shard *Stats_getShard(void) {
+   struct Shard *psShard;
+
+   if (myShard != NULL)
+      return myShard;
+
+   psShard = calloc(1, sizeof(struct Shard));
+   if (psShard == NULL)
+      return NULL;
+
+   do
+      psShard->next = shards;
+   while (!__sync_bool_compare_and_swap(&shards, psShard->next,
+                                        psShard));
+
+   myShard = psShard;
+   return psShard;
+}
+
+/*--------------------------------------------------------------------*/
+void Stats_add(struct OpStats *psOpStats, int status,
+               uint64_t uNanoseconds) {
+   assert(psOpStats != NULL);
+   assert(status >= 0 && status < STATS_NUM_STATUSES);
+
+   psOpStats->calls++;
+   psOpStats->statuses[status]++;
+   psOpStats->totalNanoseconds += uNanoseconds;
+   if (uNanoseconds > psOpStats->maxNanoseconds)
+      psOpStats->maxNanoseconds = uNanoseconds;
+   psOpStats->buckets[Stats_bucket(uNanoseconds)]++;
+}
+
+/*--------------------------------------------------------------------*/
+void Stats_record(int op, int status, uint64_t uNanoseconds) {
+   struct Shard *psShard;
+
+   assert(op >= 0 && op < FT_NUM_OPS);
+
+   psShard = Stats_getShard();
+   if (psShard == NULL)
+      return;
+
+   Stats_add(&psShard->stats.ops[op], status, uNanoseconds);
+}
+
+/*--------------------------------------------------------------------*/
+void Stats_get(struct Stats *psStats) {
+   struct Shard *psShard;
+   const struct OpStats *psFrom;
+   struct OpStats *psTo;
+   size_t i;
+   int op;
+
+   assert(psStats != NULL);
+
+   memset(psStats, 0, sizeof(struct Stats));
+   for (psShard = shards; psShard != NULL; psShard = psShard->next)
+      for (op = 0; op < FT_NUM_OPS; op++) {
+         psFrom = &psShard->stats.ops[op];
+         psTo = &psStats->ops[op];
+         if (psFrom->calls == 0)
+            continue;
+
+         psTo->calls += psFrom->calls;
+         for (i = 0; i < STATS_NUM_STATUSES; i++)
+            psTo->statuses[i] += psFrom->statuses[i];
+         psTo->totalNanoseconds += psFrom->totalNanoseconds;
+         if (psFrom->maxNanoseconds > psTo->maxNanoseconds)
+            psTo->maxNanoseconds = psFrom->maxNanoseconds;
+         for (i = 0; i < STATS_NUM_BUCKETS; i++)
+            psTo->buckets[i] += psFrom->buckets[i];
+      }
+}
+
+/*--------------------------------------------------------------------*/
+void Stats_reset(void) {
+   struct Shard *psShard;
+
+   for (psShard = shards; psShard != NULL; psShard = psShard->next)
+      memset(&psShard->stats, 0, sizeof(struct Stats));
+}
+
+/*--------------------------------------------------------------------*/
+uint64_t Stats_bucketLimit(size_t uBucket) {
+   int shift;
+
+   assert(uBucket < STATS_NUM_BUCKETS);
+
+   if (uBucket < STATS_SUB_BUCKETS)
+      return (uint64_t)uBucket;
+
+   shift = (int)(uBucket / STATS_SUB_BUCKETS) - 1;
+   return (((uint64_t)(STATS_SUB_BUCKETS + uBucket % STATS_SUB_BUCKETS)
+            + 1) << shift) - 1;
+}
+
+/*--------------------------------------------------------------------*/
+uint64_t Stats_quantile(const struct OpStats *psOpStats, double q) {
+   uint64_t uRank;
+   uint64_t uSeen = 0;
+   size_t uBucket;
+
+   assert(psOpStats != NULL);
+
+   if (psOpStats->calls == 0)
+      return 0;
+
+   /* The rank of the call at the quantile, rounded up. */
+   uRank = (uint64_t)(q * (double)psOpStats->calls);
+   if ((double)uRank < q * (double)psOpStats->calls || uRank == 0)
+      uRank++;
+
+   for (uBucket = 0; uBucket < STATS_NUM_BUCKETS - 1; uBucket++) {
+      uSeen += psOpStats->buckets[uBucket];
+      if (uSeen >= uRank)
+         break;
+   }
+
+   if (Stats_bucketLimit(uBucket) > psOpStats->maxNanoseconds)
+      return psOpStats->maxNanoseconds;
+   return Stats_bucketLimit(uBucket);
+}
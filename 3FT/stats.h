@@ -0,0 +1,100 @@
+/*--------------------------------------------------------------------*/
+/* stats.h                                                            */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#ifndef STATS_INCLUDED
+#define STATS_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "a4def.h"
+#include "ft.h"
+
+/*
+  The FT keeps counts of every call of its public functions: how many
+  calls each function had, how many ended in each status, and how long
+  they took, in log-linear latency buckets. Each thread records into a
+  shard of its own, with no locking or atomic operations, and the
+  shards are summed when the counts are read.
+
+  Latencies are bucketed like HDR histograms: exactly below
+  2^STATS_SUB_BITS nanoseconds, then STATS_SUB_BUCKETS buckets per
+  power of two, for a relative error of about 1/STATS_SUB_BUCKETS.
+*/
+enum { STATS_SUB_BITS = 4, STATS_SUB_BUCKETS = 1 << STATS_SUB_BITS,
+       STATS_NUM_BUCKETS = (64 - STATS_SUB_BITS + 1) *
+                           STATS_SUB_BUCKETS };
+
+/* The number of distinct statuses of a4def.h. */
+enum { STATS_NUM_STATUSES = MEMORY_ERROR + 1 };
+
+/* The counts of one FT function. */
+struct OpStats {
+   /* The number of calls. */
+   uint64_t calls;
+   /* The number of calls ending in each status. Functions that do not
+      return a status count a TRUE or non-NULL result as SUCCESS and
+      any other as INITIALIZATION_ERROR if the FT was not initialized,
+      MEMORY_ERROR for FT_toString, and NO_SUCH_PATH otherwise. */
+   uint64_t statuses[STATS_NUM_STATUSES];
+   /* The total and greatest nanoseconds taken by a call. */
+   uint64_t totalNanoseconds;
+   uint64_t maxNanoseconds;
+   /* The number of calls by latency bucket. */
+   uint64_t buckets[STATS_NUM_BUCKETS];
+};
+
+/* The counts of every FT function, by FT_OP_ value. */
+struct Stats {
+   struct OpStats ops[FT_NUM_OPS];
+};
+
+/*--------------------------------------------------------------------*/
+/*
+  Counts in *psOpStats a call that ended in status after uNanoseconds.
+  Stats_record counts each FT call with it; callers that time calls
+  themselves can keep their own counts with it too.
+*/
+void Stats_add(struct OpStats *psOpStats, int status,
+               uint64_t uNanoseconds);
+
+/*--------------------------------------------------------------------*/
+/*
+  Counts a call of the FT function op that ended in status after
+  uNanoseconds, in the calling thread's shard. Drops the call if the
+  shard cannot be allocated.
+*/
+void Stats_record(int op, int status, uint64_t uNanoseconds);
+
+/*--------------------------------------------------------------------*/
+/*
+  Stores the sum of every thread's counts in *psStats. Counts being
+  recorded by other threads at the same time may be missed.
+*/
+void Stats_get(struct Stats *psStats);
+
+/*--------------------------------------------------------------------*/
+/*
+  Sets every thread's counts to zero. Calls being recorded by other
+  threads at the same time may be missed or half counted.
+*/
+void Stats_reset(void);
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the greatest latency in nanoseconds that falls in bucket
+  uBucket.
+*/
+uint64_t Stats_bucketLimit(size_t uBucket);
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns an upper bound, within the bucket precision, of the latency
+  in nanoseconds below which the fraction q of the calls counted in
+  *psOpStats fell, or 0 if there were none.
+*/
+uint64_t Stats_quantile(const struct OpStats *psOpStats, double q);
+
+#endif
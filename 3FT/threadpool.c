@@ -0,0 +1,220 @@
+/*--------------------------------------------------------------------*/
+/* threadpool.c                                                       */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "threadpool.h"
+
+/* The most workers the pool will start. */
+enum { MAX_WORKERS = 64 };
+
+/*--------------------------------------------------------------------*/
+/* The ThreadPool is an Abstract Object with the following state: */
+
+/* A flag for if the worker threads are running (1) or not (0). */
+static int isRunning;
+
+/* The number of workers, counting the submitting thread. */
+static size_t numWorkers;
+
+/* The worker threads, numbered from 1. */
+static pthread_t threads[MAX_WORKERS];
+
+/* Held for the whole of a batch, so batches never interleave. */
+static pthread_mutex_t batchLock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Protects the fields of the current batch below. */
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Signalled when a new batch is posted or the pool shuts down. */
+static pthread_cond_t batchPosted = PTHREAD_COND_INITIALIZER;
+
+/* Signalled when the last busy worker finishes a batch. */
+static pthread_cond_t batchFinished = PTHREAD_COND_INITIALIZER;
+
+/* Incremented for each posted batch, so workers can tell it is new. */
+static unsigned long generation;
+
+/* The generation when the threads were started. */
+static unsigned long startGeneration;
+
+/* A flag for if the workers should exit. */
+static int isStopping;
+
+/* The task function, extra argument, and size of the batch. */
+static void (*batchTask)(size_t uTask, size_t uWorker, void *pvExtra);
+static void *batchExtra;
+static size_t batchTasks;
+
+/* The next task of the batch to hand out. */
+static size_t nextTask;
+
+/* The number of pool threads still working on the batch. */
+static size_t busyThreads;
+
+/*--------------------------------------------------------------------*/
+/*
+  Runs tasks of the current batch as worker uWorker until none are
+  left to hand out.
+*/
+static void ThreadPool_work(size_t uWorker) {
+   size_t uTask;
+
+   for (;;) {
+      pthread_mutex_lock(&lock);
+      uTask = nextTask;
+      if (uTask < batchTasks)
+         nextTask++;
+      pthread_mutex_unlock(&lock);
+
+      if (uTask >= batchTasks)
+         return;
+      (*batchTask)(uTask, uWorker, batchExtra);
+   }
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  The body of each pool thread: waits for batches and works on them
+  until the pool stops. pvWorker holds the worker's number.
+*/
+static void *ThreadPool_main(void *pvWorker) {
+   size_t uWorker = (size_t)pvWorker;
+   unsigned long seen = startGeneration;
+
+   pthread_mutex_lock(&lock);
+   for (;;) {
+      while (generation == seen && !isStopping)
+         pthread_cond_wait(&batchPosted, &lock);
+      if (isStopping)
+         break;
+      seen = generation;
+      pthread_mutex_unlock(&lock);
+
+      ThreadPool_work(uWorker);
+
+      pthread_mutex_lock(&lock);
+      if (--busyThreads == 0)
+         pthread_cond_signal(&batchFinished);
+   }
+   pthread_mutex_unlock(&lock);
+
+   return NULL;
+}
+
+/*--------------------------------------------------------------------*/
+size_t ThreadPool_init(size_t uWorkers) {
+   long online;
+   size_t u;
+
+   pthread_mutex_lock(&batchLock);
+   if (isRunning) {
+      pthread_mutex_unlock(&batchLock);
+      return numWorkers;
+   }
+
+   if (uWorkers == 0) {
+      online = sysconf(_SC_NPROCESSORS_ONLN);
+      uWorkers = (online > 0) ? (size_t)online : 1;
+   }
+   if (uWorkers > MAX_WORKERS)
+      uWorkers = MAX_WORKERS;
+
+   /* Worker 0 is whichever thread submits a batch. No batch can be
+      posted until batchLock is released, so generation is stable. */
+   isStopping = 0;
+   startGeneration = generation;
+   numWorkers = 1;
+   for (u = 1; u < uWorkers; u++) {
+      if (pthread_create(&threads[u], NULL, ThreadPool_main,
+                         (void *)u) != 0)
+         break;
+      numWorkers++;
+   }
+   isRunning = 1;
+
+   pthread_mutex_unlock(&batchLock);
+   return numWorkers;
+}
+
+/*--------------------------------------------------------------------*/
+size_t ThreadPool_getNumWorkers(void) {
+   return ThreadPool_init(0);
+}
+
+/*--------------------------------------------------------------------*/
+void ThreadPool_run(size_t uTasks,
+                    void (*pfTask)(size_t uTask, size_t uWorker,
+                                   void *pvExtra),
+                    void *pvExtra) {
+   size_t u;
+
+   assert(pfTask != NULL);
+
+   /* A single task needs no other thread. */
+   if (uTasks == 1) {
+      (*pfTask)(0, 0, pvExtra);
+      return;
+   }
+   if (uTasks == 0)
+      return;
+
+   (void)ThreadPool_init(0);
+
+   pthread_mutex_lock(&batchLock);
+
+   /* Without pool threads, run the whole batch here. */
+   if (numWorkers == 1) {
+      for (u = 0; u < uTasks; u++)
+         (*pfTask)(u, 0, pvExtra);
+      pthread_mutex_unlock(&batchLock);
+      return;
+   }
+
+   pthread_mutex_lock(&lock);
+   batchTask = pfTask;
+   batchExtra = pvExtra;
+   batchTasks = uTasks;
+   nextTask = 0;
+   busyThreads = numWorkers - 1;
+   generation++;
+   pthread_cond_broadcast(&batchPosted);
+   pthread_mutex_unlock(&lock);
+
+   ThreadPool_work(0);
+
+   pthread_mutex_lock(&lock);
+   while (busyThreads > 0)
+      pthread_cond_wait(&batchFinished, &lock);
+   pthread_mutex_unlock(&lock);
+
+   pthread_mutex_unlock(&batchLock);
+}
+
+/*--------------------------------------------------------------------*/
+void ThreadPool_shutdown(void) {
+   size_t u;
+
+   pthread_mutex_lock(&batchLock);
+   if (!isRunning) {
+      pthread_mutex_unlock(&batchLock);
+      return;
+   }
+
+   pthread_mutex_lock(&lock);
+   isStopping = 1;
+   pthread_cond_broadcast(&batchPosted);
+   pthread_mutex_unlock(&lock);
+
+   for (u = 1; u < numWorkers; u++)
+      (void)pthread_join(threads[u], NULL);
+
+   numWorkers = 0;
+   isRunning = 0;
+   pthread_mutex_unlock(&batchLock);
+}
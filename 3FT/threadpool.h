@@ -0,0 +1,54 @@
+/*--------------------------------------------------------------------*/
+/* threadpool.h                                                       */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#ifndef THREADPOOL_INCLUDED
+#define THREADPOOL_INCLUDED
+
+#include <stddef.h>
+
+/*
+  The ThreadPool is an abstract object holding a fixed set of worker
+  threads that run batches of numbered tasks. The thread that submits
+  a batch works on it too, as worker 0, so a pool of one worker runs
+  everything on the caller.
+*/
+
+/*--------------------------------------------------------------------*/
+/*
+  Starts the pool with uWorkers workers, counting the caller, or with
+  one per online processor if uWorkers is 0. Has no effect if the
+  pool is already running. Returns the number of workers actually
+  available, which is fewer than asked if threads cannot be created.
+*/
+size_t ThreadPool_init(size_t uWorkers);
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the number of workers in the pool, starting it with the
+  default size if it is not running.
+*/
+size_t ThreadPool_getNumWorkers(void);
+
+/*--------------------------------------------------------------------*/
+/*
+  Calls (*pfTask)(uTask, uWorker, pvExtra) once for each uTask in
+  0...uTasks-1, spreading the calls over the workers, and returns
+  when all have finished. uWorker identifies the calling worker and is
+  less than ThreadPool_getNumWorkers(); no two calls with the same
+  uWorker overlap. Batches from different threads run one at a time.
+  Must not be called from within a task.
+*/
+void ThreadPool_run(size_t uTasks,
+                    void (*pfTask)(size_t uTask, size_t uWorker,
+                                   void *pvExtra),
+                    void *pvExtra);
+
+/*--------------------------------------------------------------------*/
+/*
+  Stops and joins the pool's threads. The next use starts it again.
+*/
+void ThreadPool_shutdown(void);
+
+#endif
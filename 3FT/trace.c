@@ -0,0 +1,218 @@
+/*--------------------------------------------------------------------*/
+/* trace.c                                                            */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace.h"
+
+/* The most bytes a 64-bit varint takes. */
+enum { MAX_VARINT_SIZE = 10 };
+
+/* The bits of a varint byte that hold the number, and its flag for
+   more bytes to follow. */
+enum { VARINT_BITS = 0x7f, VARINT_MORE = 0x80 };
+
+/*--------------------------------------------------------------------*/
+boolean Trace_hasPath(int op) {
+   return (boolean)(op != FT_OP_INIT && op != FT_OP_DESTROY &&
+                    op != FT_OP_TO_STRING);
+}
+
+/*--------------------------------------------------------------------*/
+boolean Trace_hasSecondPath(int op) {
+   return (boolean)(op == FT_OP_MOVE || op == FT_OP_COPY);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Writes uValue as a varint to the buffer pucBuffer, which has room for
+  MAX_VARINT_SIZE bytes. Returns the number of bytes written.
+*/
+static size_t Trace_encode(unsigned char *pucBuffer, uint64_t uValue) {
+   size_t uSize = 0;
+
+   assert(pucBuffer != NULL);
+
+   while (uValue > VARINT_BITS) {
+      pucBuffer[uSize++] =
+         (unsigned char)((uValue & VARINT_BITS) | VARINT_MORE);
+      uValue >>= 7;
+   }
+   pucBuffer[uSize++] = (unsigned char)uValue;
+   return uSize;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Reads a varint from psFile into *puValue.
+  Returns 1 if successful, 0 if the file ends or the varint is too
+  long.
+*/
+static int Trace_decode(FILE *psFile, uint64_t *puValue) {
+   uint64_t uValue = 0;
+   int iShift = 0;
+   int iByte;
+
+   assert(psFile != NULL);
+   assert(puValue != NULL);
+
+   do {
+      iByte = getc(psFile);
+      if (iByte == EOF || iShift >= 64)
+         return 0;
+      uValue |= (uint64_t)(iByte & VARINT_BITS) << iShift;
+      iShift += 7;
+   } while ((iByte & VARINT_MORE) != 0);
+
+   *puValue = uValue;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+int Trace_writeHeader(FILE *psFile) {
+   assert(psFile != NULL);
+
+   return fwrite(TRACE_MAGIC, 1, TRACE_MAGIC_SIZE, psFile) ==
+      TRACE_MAGIC_SIZE;
+}
+
+/*--------------------------------------------------------------------*/
+int Trace_write(FILE *psFile, const struct TraceRecord *psRecord) {
+   unsigned char aucBuffer[1 + 5 * MAX_VARINT_SIZE];
+   size_t uSize = 0;
+   size_t uPathLength = 0;
+   size_t uPath2Length = 0;
+
+   assert(psFile != NULL);
+   assert(psRecord != NULL);
+   assert(!Trace_hasPath(psRecord->op) || psRecord->path != NULL);
+   assert(!Trace_hasSecondPath(psRecord->op) ||
+          psRecord->path2 != NULL);
+
+   /* Put the fixed part together so each record is one write. */
+   aucBuffer[uSize++] = (unsigned char)(psRecord->op |
+      (psRecord->hasContents ? TRACE_HAS_CONTENTS : 0));
+   uSize += Trace_encode(aucBuffer + uSize, psRecord->result);
+   uSize += Trace_encode(aucBuffer + uSize, psRecord->length);
+   uSize += Trace_encode(aucBuffer + uSize, psRecord->nanoseconds);
+   if (Trace_hasPath(psRecord->op)) {
+      uPathLength = strlen(psRecord->path);
+      uSize += Trace_encode(aucBuffer + uSize, uPathLength);
+   }
+
+   if (fwrite(aucBuffer, 1, uSize, psFile) != uSize)
+      return 0;
+   if (uPathLength > 0 &&
+       fwrite(psRecord->path, 1, uPathLength, psFile) != uPathLength)
+      return 0;
+   if (!Trace_hasSecondPath(psRecord->op))
+      return 1;
+
+   uPath2Length = strlen(psRecord->path2);
+   uSize = Trace_encode(aucBuffer, uPath2Length);
+   if (fwrite(aucBuffer, 1, uSize, psFile) != uSize)
+      return 0;
+   if (uPath2Length > 0 &&
+       fwrite(psRecord->path2, 1, uPath2Length, psFile) !=
+          uPath2Length)
+      return 0;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+int Trace_readHeader(FILE *psFile) {
+   char acMagic[TRACE_MAGIC_SIZE];
+
+   assert(psFile != NULL);
+
+   if (fread(acMagic, 1, TRACE_MAGIC_SIZE, psFile) != TRACE_MAGIC_SIZE)
+      return 0;
+   return memcmp(acMagic, TRACE_MAGIC, TRACE_MAGIC_SIZE) == 0;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Reads a path from psFile into *ppcPath, a buffer of *puPathSize
+  bytes allocated by malloc, from byte uStart on, growing the buffer
+  as needed, and stores in *puEnd the offset just past its '\0'.
+  Returns 1 if successful, 0 if the trace is malformed or there is an
+  allocation error.
+*/
+static int Trace_readPath(FILE *psFile, char **ppcPath,
+                          size_t *puPathSize, size_t uStart,
+                          size_t *puEnd) {
+   uint64_t uPathLength;
+   size_t uEnd;
+   char *pcNew;
+
+   assert(psFile != NULL);
+   assert(ppcPath != NULL);
+   assert(puPathSize != NULL);
+   assert(puEnd != NULL);
+
+   if (!Trace_decode(psFile, &uPathLength) ||
+       uPathLength >= SIZE_MAX - uStart)
+      return 0;
+   uEnd = uStart + (size_t)uPathLength + 1;
+   if (uEnd > *puPathSize) {
+      pcNew = realloc(*ppcPath, uEnd);
+      if (pcNew == NULL)
+         return 0;
+      *ppcPath = pcNew;
+      *puPathSize = uEnd;
+   }
+   if (fread(*ppcPath + uStart, 1, (size_t)uPathLength, psFile) !=
+       (size_t)uPathLength)
+      return 0;
+   (*ppcPath)[uEnd - 1] = '\0';
+
+   *puEnd = uEnd;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+int Trace_read(FILE *psFile, struct TraceRecord *psRecord,
+               char **ppcPath, size_t *puPathSize) {
+   size_t uPathEnd;
+   size_t uPath2End;
+   int iOp;
+
+   assert(psFile != NULL);
+   assert(psRecord != NULL);
+   assert(ppcPath != NULL);
+   assert(puPathSize != NULL);
+
+   iOp = getc(psFile);
+   if (iOp == EOF)
+      return 0;
+
+   psRecord->hasContents = (boolean)((iOp & TRACE_HAS_CONTENTS) != 0);
+   psRecord->op = iOp & ~TRACE_HAS_CONTENTS;
+   if (psRecord->op >= FT_NUM_TRACED_OPS)
+      return -1;
+   if (!Trace_decode(psFile, &psRecord->result) ||
+       !Trace_decode(psFile, &psRecord->length) ||
+       !Trace_decode(psFile, &psRecord->nanoseconds))
+      return -1;
+
+   psRecord->path = NULL;
+   psRecord->path2 = NULL;
+   if (!Trace_hasPath(psRecord->op))
+      return 1;
+
+   if (!Trace_readPath(psFile, ppcPath, puPathSize, 0, &uPathEnd))
+      return -1;
+   if (Trace_hasSecondPath(psRecord->op)) {
+      if (!Trace_readPath(psFile, ppcPath, puPathSize, uPathEnd,
+                          &uPath2End))
+         return -1;
+      psRecord->path2 = *ppcPath + uPathEnd;
+   }
+
+   psRecord->path = *ppcPath;
+   return 1;
+}
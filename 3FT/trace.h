@@ -0,0 +1,105 @@
+/*--------------------------------------------------------------------*/
+/* trace.h                                                            */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#ifndef TRACE_INCLUDED
+#define TRACE_INCLUDED
+
+#include <stdint.h>
+#include <stdio.h>
+#include "ft.h"
+
+/*
+  A trace is a binary file of FT function calls. It starts with the
+  TRACE_MAGIC_SIZE bytes of TRACE_MAGIC and then holds one record per
+  call, in call order:
+
+    op       1 byte:  the FT_OP_ value, plus TRACE_HAS_CONTENTS if
+                      the call was given non-NULL contents
+    result   varint:  the returned status or boolean; for calls
+                      returning a pointer, 1 if it was non-NULL
+    length   varint:  the content length given to FT_insertFile or
+                      FT_replaceFileContents, the length returned by
+                      FT_stat, or the length of FT_toString's string
+    time     varint:  how long the call took, in nanoseconds
+    path     varint byte count then the bytes, without '\0',
+                      for the calls that take a path
+    path2    varint byte count then the bytes, without '\0',
+                      for the calls that take a second path, such
+                      as FT_move's and FT_copy's destination
+
+  A varint is an unsigned number written 7 bits at a time, least
+  significant first, with the high bit set on all but the last byte.
+*/
+
+/* The bytes every trace starts with, the last being the version. */
+#define TRACE_MAGIC "FTTRACE\001"
+enum { TRACE_MAGIC_SIZE = 8 };
+
+/* The flag in a record's op byte for non-NULL contents. */
+enum { TRACE_HAS_CONTENTS = 0x80 };
+
+/* One call, as written to or read from a trace. */
+struct TraceRecord {
+   /* The FT_OP_ value of the function called. */
+   int op;
+   /* Whether the call was given non-NULL contents. */
+   boolean hasContents;
+   /* The result, content length and duration, as above. */
+   uint64_t result;
+   uint64_t length;
+   uint64_t nanoseconds;
+   /* The path, or NULL if the function takes none. */
+   const char *path;
+   /* The second path, or NULL if the function takes only one. */
+   const char *path2;
+};
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns TRUE if the function identified by op takes a path.
+*/
+boolean Trace_hasPath(int op);
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns TRUE if the function identified by op takes a second path.
+*/
+boolean Trace_hasSecondPath(int op);
+
+/*--------------------------------------------------------------------*/
+/*
+  Writes the trace header to psFile.
+  Returns 1 if successful, 0 if there is a write error.
+*/
+int Trace_writeHeader(FILE *psFile);
+
+/*--------------------------------------------------------------------*/
+/*
+  Writes the record *psRecord to psFile.
+  Returns 1 if successful, 0 if there is a write error.
+*/
+int Trace_write(FILE *psFile, const struct TraceRecord *psRecord);
+
+/*--------------------------------------------------------------------*/
+/*
+  Reads and checks the trace header from psFile.
+  Returns 1 if it is a trace of this version, 0 otherwise.
+*/
+int Trace_readHeader(FILE *psFile);
+
+/*--------------------------------------------------------------------*/
+/*
+  Reads the next record from psFile into *psRecord. The paths are
+  stored in *ppcPath, a buffer of *puPathSize bytes allocated by
+  malloc, which is grown as needed (start with NULL and 0), and
+  psRecord->path and psRecord->path2 point into it until the next
+  call.
+  Returns 1 if a record is read, 0 at the end of the trace, and -1 if
+  the trace is malformed or there is an allocation error.
+*/
+int Trace_read(FILE *psFile, struct TraceRecord *psRecord,
+               char **ppcPath, size_t *puPathSize);
+
+#endif
@@ -146,9 +146,7 @@ int DirNode_hasDirChild(DirNode n, const char *path, size_t *childID) {
    assert(n != NULL);
    assert(path != NULL);
 
-   fprintf(stderr,"%s\n",path);
    checker = DirNode_create(path, NULL);
-   fprintf(stderr,"%s\n",DirNode_getPath(checker));
    if (checker == NULL)
       return -1;
    result = DynArray_bsearch(
@@ -268,6 +268,12 @@ int FT_insertDir(char *path) {
       return MEMORY_ERROR;
    }
    count++;
+
+   /* A one-component path into an empty tree becomes the root. */
+   if (lastInsert == NULL) {
+      root = curr;
+      return SUCCESS;
+   }
    result = FT_linkParentToChild(lastInsert, curr);
    if (result != SUCCESS) {
       if (firstInsert != NULL)
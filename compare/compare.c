@@ -0,0 +1,411 @@
+/*--------------------------------------------------------------------*/
+/* compare.c                                                          */
+/* Author: Christian Ronda & Benjamin Herber                          */
+/*--------------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <malloc.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+  The same program is built once per tree design, by defining one of
+  USE_BDT, USE_DT, USE_FT or USE_FT_OLD, and run through that design's
+  public API. Only directories are inserted, as BDT and DT hold
+  nothing else.
+*/
+#if defined(USE_BDT)
+#include "bdt.h"
+#define IMPL_NAME "1BDT"
+#define Tree_init BDT_init
+#define Tree_destroy BDT_destroy
+#define Tree_insert BDT_insertPath
+#define Tree_contains BDT_containsPath
+#define Tree_remove BDT_rmPath
+#define Tree_toString BDT_toString
+#elif defined(USE_DT)
+#include "dt.h"
+#define IMPL_NAME "2DT"
+#define Tree_init DT_init
+#define Tree_destroy DT_destroy
+#define Tree_insert DT_insertPath
+#define Tree_contains DT_containsPath
+#define Tree_remove DT_rmPath
+#define Tree_toString DT_toString
+#elif defined(USE_FT) || defined(USE_FT_OLD)
+#include "ft.h"
+#ifdef USE_FT
+#define IMPL_NAME "3FT"
+#else
+#define IMPL_NAME "3FT_old"
+#endif
+#define Tree_init FT_init
+#define Tree_destroy FT_destroy
+#define Tree_insert FT_insertDir
+#define Tree_contains FT_containsDir
+#define Tree_remove FT_rmDir
+#define Tree_toString FT_toString
+#else
+#error "Define one of USE_BDT, USE_DT, USE_FT or USE_FT_OLD"
+#endif
+
+/*--------------------------------------------------------------------*/
+/* The parameters of a run, set from name=value arguments. */
+struct Config {
+   /* The number of directories inserted. */
+   size_t nodes;
+   /* The number of children of each inner directory. */
+   size_t fanout;
+   /* The number of contains queries, half of them misses. */
+   size_t queries;
+   /* The mean length of the random part of each name. */
+   size_t name;
+   /* The seed of the random number generator. */
+   unsigned long seed;
+   /* Whether toString is timed; it is slow on large trees. */
+   int tostring;
+};
+
+/* A block of '\0'-terminated strings, each found by its offset. */
+struct Strings {
+   char *text;
+   size_t textLength;
+   size_t textSize;
+   size_t *offsets;
+   size_t length;
+};
+
+/*--------------------------------------------------------------------*/
+/* The state of the random number generator. */
+static uint64_t randomState = 217;
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the current time in seconds from a monotonic clock.
+*/
+static double Compare_seconds(void) {
+   struct timespec now;
+
+   (void)clock_gettime(CLOCK_MONOTONIC, &now);
+   return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns a random number uniform in [0, uBound), by xorshift64*, or
+  0 if uBound is 0.
+*/
+static size_t Compare_below(size_t uBound) {
+   randomState ^= randomState >> 12;
+   randomState ^= randomState << 25;
+   randomState ^= randomState >> 27;
+   if (uBound == 0)
+      return 0;
+   return (size_t)((randomState * UINT64_C(2685821657736338717)) %
+                   uBound);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the bytes of heap in use, as malloc counts them.
+*/
+static size_t Compare_heapInUse(void) {
+   return (size_t)mallinfo2().uordblks;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns the string at index uIndex of *psStrings.
+*/
+static char *Strings_get(struct Strings *psStrings, size_t uIndex) {
+   assert(psStrings != NULL);
+   assert(uIndex < psStrings->length);
+
+   return psStrings->text + psStrings->offsets[uIndex];
+}
+
+
+/*--------------------------------------------------------------------*/
+/*
+  Appends to *psStrings the string at index uSource of *psSource,
+  then separator, then suffix; or only suffix if psSource is NULL.
+  psSource may be psStrings. The offsets of *psStrings must have room
+  for one more string.
+  Returns 1 if successful, 0 if there is an allocation error.
+*/
+static int Strings_add(struct Strings *psStrings,
+                       struct Strings *psSource, size_t uSource,
+                       const char *separator, const char *suffix) {
+   size_t uSourceLength = 0;
+   size_t uNeeded;
+   size_t uNewSize;
+   char *pcNew;
+   char *end;
+
+   assert(psStrings != NULL);
+   assert(separator != NULL);
+   assert(suffix != NULL);
+
+   if (psSource != NULL)
+      uSourceLength = strlen(Strings_get(psSource, uSource)) +
+         strlen(separator);
+   uNeeded = uSourceLength + strlen(suffix) + 1;
+
+   if (psStrings->textLength + uNeeded > psStrings->textSize) {
+      uNewSize = 2 * psStrings->textSize + uNeeded;
+      pcNew = realloc(psStrings->text, uNewSize);
+      if (pcNew == NULL)
+         return 0;
+      psStrings->text = pcNew;
+      psStrings->textSize = uNewSize;
+   }
+
+   /* Find the source only now, as the text may have moved. */
+   end = psStrings->text + psStrings->textLength;
+   *end = '\0';
+   if (psSource != NULL) {
+      strcpy(end, Strings_get(psSource, uSource));
+      strcat(end, separator);
+   }
+   strcat(end, suffix);
+
+   psStrings->offsets[psStrings->length++] = psStrings->textLength;
+   psStrings->textLength += uNeeded;
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Sets *psStrings to an empty block with room for uCapacity strings.
+  Returns 1 if successful, 0 if there is an allocation error.
+*/
+static int Strings_init(struct Strings *psStrings, size_t uCapacity) {
+   assert(psStrings != NULL);
+
+   memset(psStrings, 0, sizeof(*psStrings));
+   psStrings->offsets = malloc(uCapacity * sizeof(size_t));
+   return psStrings->offsets != NULL;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Frees the memory held by *psStrings.
+*/
+static void Strings_free(struct Strings *psStrings) {
+   assert(psStrings != NULL);
+
+   free(psStrings->text);
+   free(psStrings->offsets);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Fills *psPaths, which must have room, with the paths of a complete
+  tree of psConfig->nodes directories in breadth-first order: each
+  directory i > 0 is a child of directory (i - 1) / fanout. Names are
+  random letters of mean length psConfig->name then a unique number.
+  Returns 1 if successful, 0 if there is an allocation error.
+*/
+static int Compare_makePaths(const struct Config *psConfig,
+                             struct Strings *psPaths) {
+   enum { NAME_SIZE = 2 * 255 + 18 };
+   char name[NAME_SIZE];
+   size_t uChars;
+   size_t i;
+   size_t j;
+
+   assert(psConfig != NULL);
+   assert(psPaths != NULL);
+
+   for (i = 0; i < psConfig->nodes; i++) {
+      uChars = (psConfig->name == 0) ? 0
+         : psConfig->name / 2 + Compare_below(psConfig->name + 1);
+      for (j = 0; j < uChars; j++)
+         name[j] = (char)('a' + Compare_below(26));
+      sprintf(name + uChars, "%lx", (unsigned long)i);
+
+      if (i == 0) {
+         if (!Strings_add(psPaths, NULL, 0, "", name))
+            return 0;
+      }
+      else if (!Strings_add(psPaths, psPaths,
+                            (i - 1) / psConfig->fanout, "/", name))
+         return 0;
+   }
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Fills *psQueries, which must have room, with psConfig->queries
+  random paths: alternately a path of *psPaths and a path one level
+  below it that is not in the tree.
+  Returns 1 if successful, 0 if there is an allocation error.
+*/
+static int Compare_makeQueries(const struct Config *psConfig,
+                               struct Strings *psPaths,
+                               struct Strings *psQueries) {
+   size_t i;
+
+   assert(psConfig != NULL);
+   assert(psPaths != NULL);
+   assert(psQueries != NULL);
+
+   for (i = 0; i < psConfig->queries; i++)
+      if (!Strings_add(psQueries, psPaths,
+                       Compare_below(psPaths->length), "/",
+                       (i % 2 == 0) ? "" : "~"))
+         return 0;
+
+   /* Hits were given a trailing '/', which is taken off again. */
+   for (i = 0; i < psConfig->queries; i += 2)
+      Strings_get(psQueries, i)[strlen(Strings_get(psQueries, i)) - 1]
+         = '\0';
+   return 1;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Returns uHash with uValue mixed in, so results in any order of
+  calls give a checksum of the whole run.
+*/
+static uint64_t Compare_mix(uint64_t uHash, uint64_t uValue) {
+   return (uHash ^ uValue) * UINT64_C(0x100000001b3);
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Sets the field of *psConfig named by the argument arg, of the form
+  name=value. Returns 0 if successful, 1 if arg is not understood.
+*/
+static int Compare_parseArg(struct Config *psConfig, const char *arg) {
+   const char *value;
+
+   assert(psConfig != NULL);
+   assert(arg != NULL);
+
+   value = strchr(arg, '=');
+   if (value == NULL)
+      return 1;
+   value++;
+
+   if (strncmp(arg, "nodes=", 6) == 0)
+      psConfig->nodes = (size_t)strtod(value, NULL);
+   else if (strncmp(arg, "fanout=", 7) == 0)
+      psConfig->fanout = (size_t)strtoul(value, NULL, 10);
+   else if (strncmp(arg, "queries=", 8) == 0)
+      psConfig->queries = (size_t)strtod(value, NULL);
+   else if (strncmp(arg, "name=", 5) == 0)
+      psConfig->name = (size_t)strtoul(value, NULL, 10);
+   else if (strncmp(arg, "seed=", 5) == 0)
+      psConfig->seed = strtoul(value, NULL, 10);
+   else if (strncmp(arg, "tostring=", 9) == 0)
+      psConfig->tostring = (int)strtol(value, NULL, 10);
+   else
+      return 1;
+   return 0;
+}
+
+/*--------------------------------------------------------------------*/
+/*
+  Runs a seeded workload through the tree design this program was
+  built for: inserts a complete tree of directories breadth first,
+  looks up random paths that are and are not in it, optionally builds
+  its string, then removes every directory, deepest first. Takes
+  name=value arguments: nodes (100000), fanout (2, the most BDT
+  allows), queries (1000000), name (8), seed (217), and tostring (0).
+  Prints the heap bytes per directory, each phase's throughput, and a
+  checksum of all results, which is equal across designs that behave
+  alike. Returns 0 if successful, 1 otherwise.
+*/
+int main(int argc, char *argv[]) {
+   struct Config sConfig;
+   struct Strings sPaths;
+   struct Strings sQueries;
+   uint64_t uChecksum = UINT64_C(0xcbf29ce484222325);
+   size_t uHeapBefore;
+   size_t uBytesPerNode;
+   double start;
+   double insertRate;
+   double containsRate;
+   double removeRate;
+   double toStringTime = 0.0;
+   char *string;
+   int i;
+   size_t u;
+
+   sConfig.nodes = 100000;
+   sConfig.fanout = 2;
+   sConfig.queries = 1000000;
+   sConfig.name = 8;
+   sConfig.seed = 217;
+   sConfig.tostring = 0;
+   for (i = 1; i < argc; i++)
+      if (Compare_parseArg(&sConfig, argv[i]) != 0 ||
+          sConfig.fanout == 0 || sConfig.nodes == 0 ||
+          sConfig.name > 255) {
+         fprintf(stderr, "usage: %s [nodes=N] [fanout=F] [queries=Q] "
+                 "[name=L] [seed=S] [tostring=0|1]\n", argv[0]);
+         return 1;
+      }
+   randomState = (uint64_t)sConfig.seed * 2 + 1;
+
+   /* Generate the whole workload before measuring the heap. */
+   if (!Strings_init(&sPaths, sConfig.nodes) ||
+       !Strings_init(&sQueries, sConfig.queries) ||
+       !Compare_makePaths(&sConfig, &sPaths) ||
+       !Compare_makeQueries(&sConfig, &sPaths, &sQueries)) {
+      fprintf(stderr, "Insufficient memory\n");
+      return 1;
+   }
+
+   uChecksum = Compare_mix(uChecksum, (uint64_t)Tree_init());
+   uHeapBefore = Compare_heapInUse();
+
+   start = Compare_seconds();
+   for (u = 0; u < sConfig.nodes; u++)
+      uChecksum = Compare_mix(uChecksum,
+         (uint64_t)Tree_insert(Strings_get(&sPaths, u)));
+   insertRate = (double)sConfig.nodes / (Compare_seconds() - start);
+   uBytesPerNode = (Compare_heapInUse() - uHeapBefore) / sConfig.nodes;
+
+   start = Compare_seconds();
+   for (u = 0; u < sConfig.queries; u++)
+      uChecksum = Compare_mix(uChecksum,
+         (uint64_t)Tree_contains(Strings_get(&sQueries, u)));
+   containsRate = (double)sConfig.queries / (Compare_seconds() - start);
+
+   if (sConfig.tostring) {
+      start = Compare_seconds();
+      string = Tree_toString();
+      toStringTime = Compare_seconds() - start;
+      uChecksum = Compare_mix(uChecksum,
+         (string == NULL) ? 0 : (uint64_t)strlen(string));
+      free(string);
+   }
+
+   start = Compare_seconds();
+   for (u = sConfig.nodes; u > 0; u--)
+      uChecksum = Compare_mix(uChecksum,
+         (uint64_t)Tree_remove(Strings_get(&sPaths, u - 1)));
+   removeRate = (double)sConfig.nodes / (Compare_seconds() - start);
+
+   uChecksum = Compare_mix(uChecksum, (uint64_t)Tree_destroy());
+
+   printf("%-8s %10s %10s %12s %12s %12s %12s %16s\n", "impl",
+          "nodes", "bytes/node", "insert/s", "contains/s", "remove/s",
+          "toString(s)", "checksum");
+   printf("%-8s %10lu %10lu %12.0f %12.0f %12.0f %12.6f %016lx\n",
+          IMPL_NAME, (unsigned long)sConfig.nodes,
+          (unsigned long)uBytesPerNode, insertRate, containsRate,
+          removeRate, toStringTime, (unsigned long)uChecksum);
+
+   Strings_free(&sPaths);
+   Strings_free(&sQueries);
+   return 0;
+}